@@ -0,0 +1,164 @@
+/**
+ * Benchmarks of the binding, and of the native hot paths through the
+ * bench executable, written as one JSON file to compare releases:
+ *
+ *   npm run bench -- [--out path] [--quick]
+ *
+ * Each binding case runs in a process of its own, a Screen can't be
+ * stopped once it listens. Gaze comes from the synthetic adapter.
+ */
+
+const { execFileSync } = require('child_process');
+const { performance } = require('perf_hooks');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+const RECTANGLE_COUNTS = [100, 10000, 100000];
+const DELIVERY_RATE = 10000;
+
+function argument(name) {
+    const i = process.argv.indexOf(name);
+    return i >= 0 ? process.argv[i + 1] : undefined;
+}
+
+const quick = process.argv.includes('--quick');
+const seconds = quick ? 0.1 : 0.5;
+
+function result(name, size, ops, elapsed, extra) {
+    return Object.assign({ name, size, ops, seconds: elapsed, opsPerSecond: ops / elapsed, nsPerOp: elapsed * 1e9 / ops }, extra);
+}
+
+/**
+ * Cost of handing a layout to the binding, up to the queue of the
+ * tracker thread. The tracker isn't started, so pending rectangles pile
+ * up, the total is capped to keep memory in check.
+ */
+function addRectangles(size) {
+    const Screen = require('../index');
+    const screen = new Screen(1920.0, 1080.0, { synthetic: {} });
+
+    const columns = Math.ceil(Math.sqrt(size * 16 / 9));
+    const rows = Math.ceil(size / columns);
+    const rectangles = [];
+    for (let i = 0; i < size; i++)
+        rectangles.push({ id: i + 1, x: (i % columns) * 1920 / columns, y: Math.floor(i / columns) * 1080 / rows, width: 1920 / columns, height: 1080 / rows });
+
+    let calls = 0;
+    const start = performance.now();
+    let elapsed;
+    do {
+        screen.AddRectangles(rectangles);
+        calls++;
+        elapsed = (performance.now() - start) / 1000;
+    } while (elapsed < seconds && calls * size < 2000000);
+
+    return result('addRectangles', size, calls, elapsed);
+}
+
+/**
+ * Gaze points at 10 kHz, one callback per sample or polled from the
+ * history a frame at a time. nsPerOp is the time the event loop was
+ * busy per sample delivered.
+ */
+function delivery(batched) {
+    const Screen = require('../index');
+    const duration = quick ? 1 : 3;
+
+    let samples = 0;
+    let screen;
+    if (batched) {
+        screen = new Screen(1920.0, 1080.0, { synthetic: { rate: DELIVERY_RATE }, history: { seconds: 1, rate: DELIVERY_RATE } });
+
+        let since = 0;
+        setInterval(() => {
+            const points = screen.GetHistory(since);
+            if (points.length) {
+                samples += points.length / 3;
+                since = points[points.length - 3] + 1;
+            }
+        }, 16);
+    } else {
+        screen = new Screen(1920.0, 1080.0, { synthetic: { rate: DELIVERY_RATE } });
+        screen.ListenGazePoint(() => samples++);
+    }
+
+    return new Promise((resolve) => {
+        // Let the tracker thread get going first.
+        setTimeout(() => {
+            const first = samples;
+            const utilization = performance.eventLoopUtilization();
+            const start = performance.now();
+
+            setTimeout(() => {
+                const elapsed = (performance.now() - start) / 1000;
+                const busy = performance.eventLoopUtilization(utilization).active / 1000;
+                const delivered = samples - first;
+
+                resolve(result(batched ? 'deliveryBatched' : 'deliveryPerSample', DELIVERY_RATE, delivered, elapsed,
+                    { nsPerOp: busy * 1e9 / delivered, eventLoopBusy: busy / elapsed }));
+            }, duration * 1000);
+        }, 500);
+    });
+}
+
+async function runCase(name, size) {
+    const bench = name === 'addRectangles' ? addRectangles(size) : await delivery(name === 'deliveryBatched');
+    process.stdout.write(JSON.stringify(bench) + '\n');
+    process.exit(0);
+}
+
+function child(name, size) {
+    const args = [__filename, '--case', name, String(size)];
+    if (quick)
+        args.push('--quick');
+
+    return JSON.parse(execFileSync(process.execPath, args, { encoding: 'utf8' }).trim().split('\n').pop());
+}
+
+function native() {
+    const executable = path.join(__dirname, '..', 'cpp', 'build', 'Release', process.platform === 'win32' ? 'bench.exe' : 'bench');
+    const args = ['--dir', os.tmpdir()];
+    if (quick)
+        args.push('--samples', '100000', '--seconds', String(seconds));
+
+    return execFileSync(executable, args, { encoding: 'utf8' })
+        .split('\n')
+        .filter((line) => line)
+        .map((line) => JSON.parse(line));
+}
+
+function main() {
+    const benchmarks = [];
+    const report = (bench) => {
+        console.log(`${bench.name.padEnd(26)} ${String(bench.size).padStart(8)} ${bench.nsPerOp.toFixed(1).padStart(16)} ns/op`);
+        benchmarks.push(bench);
+    };
+
+    for (const size of RECTANGLE_COUNTS)
+        report(child('addRectangles', size));
+
+    report(child('deliveryPerSample', DELIVERY_RATE));
+    report(child('deliveryBatched', DELIVERY_RATE));
+
+    native().forEach(report);
+
+    const out = argument('--out') || 'bench-results.json';
+    const results = {
+        date: new Date().toISOString(),
+        version: require('../package.json').version,
+        node: process.version,
+        platform: process.platform,
+        arch: process.arch,
+        cpu: os.cpus()[0].model,
+        benchmarks
+    };
+
+    fs.writeFileSync(out, JSON.stringify(results, null, 2) + '\n');
+    console.log(`Wrote ${out}`);
+}
+
+if (argument('--case'))
+    runCase(argument('--case'), Number(process.argv[process.argv.indexOf('--case') + 2]));
+else
+    main();
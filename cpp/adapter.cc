@@ -0,0 +1,219 @@
+#include "adapter.h"
+
+Adapter::Adapter(float width, float height)
+{
+    Adapter::width = width;
+    Adapter::height = height;
+
+    Adapter::beginTransaction = {nullptr, nullptr};
+    Adapter::commitTransaction = {nullptr, nullptr};
+    Adapter::gazePoint = {nullptr, nullptr};
+    Adapter::gazeOrigin = {nullptr, nullptr};
+    Adapter::presence = {nullptr, nullptr};
+    Adapter::headPose = {nullptr, nullptr};
+    Adapter::trackingStatus = {nullptr, nullptr};
+
+    IL_AdapterFunctions &f = Adapter::functions;
+    f = {};
+
+    // The adapter context handed back to us by the IL is this object.
+    f.createDestroyContext = this;
+    f.createAdapter = Adapter::CreateAdapter;
+    f.destroyAdapter = Adapter::DestroyAdapter;
+    f.startAdapter = Adapter::StartAdapter;
+    f.stopAdapter = Adapter::StopAdapter;
+    f.updateAdapter = Adapter::UpdateAdapter;
+    f.waitForDeviceConnection = Adapter::WaitForDeviceConnection;
+    f.waitForStreamingDataAvailable = Adapter::WaitForStreamingDataAvailable;
+    f.getStreamTypesProvided = Adapter::GetStreamTypesProvided;
+    f.getStreamCoordinateTransformInfo = Adapter::GetStreamCoordinateTransformInfo;
+    f.registerBeginTransactionCallback = Adapter::RegisterBeginTransaction;
+    f.registerCommitTransactionCallback = Adapter::RegisterCommitTransaction;
+    f.registerPostGazePointDataCallback = Adapter::RegisterGazePoint;
+    f.registerPostGazeOriginDataCallback = Adapter::RegisterGazeOrigin;
+    f.registerPostPresenceDataCallback = Adapter::RegisterPresence;
+    f.registerPostHeadPoseDataCallback = Adapter::RegisterHeadPose;
+    f.registerPostResponsiveGazePointDataCallback = Adapter::RegisterResponsiveGazePoint;
+    f.registerTrackingStatusCallback = Adapter::RegisterTrackingStatus;
+    f.registerDeviceNotificationCallback = Adapter::RegisterDeviceNotification;
+    f.registerLoggingCallback = Adapter::RegisterLogging;
+    f.registerForwardLoggingStatementCallback = Adapter::RegisterForwardLogging;
+}
+
+Adapter::~Adapter() {}
+
+IL_AdapterFunctions *Adapter::Functions()
+{
+    return &functions;
+}
+
+void Adapter::PostGazePoint(const IL_GazePointData &data)
+{
+    if (Adapter::gazePoint.callback)
+        Adapter::gazePoint.callback(&data, Adapter::gazePoint.context);
+}
+
+void Adapter::PostGazeOrigin(const IL_GazeOriginData &data)
+{
+    if (Adapter::gazeOrigin.callback)
+        Adapter::gazeOrigin.callback(&data, Adapter::gazeOrigin.context);
+}
+
+void Adapter::PostPresence(const IL_PresenceData &data)
+{
+    if (Adapter::presence.callback)
+        Adapter::presence.callback(&data, Adapter::presence.context);
+}
+
+void Adapter::PostHeadPose(const IL_HeadPoseData &data)
+{
+    if (Adapter::headPose.callback)
+        Adapter::headPose.callback(&data, Adapter::headPose.context);
+}
+
+bool Adapter::CreateAdapter(void *createDestroyContext, ILAdapter_AdapterContext *context)
+{
+    *context = createDestroyContext;
+    return true;
+}
+
+void Adapter::DestroyAdapter(void *createDestroyContext, ILAdapter_AdapterContext *context)
+{
+    *context = nullptr;
+}
+
+void Adapter::StartAdapter(ILAdapter_AdapterContext context, IL_FieldOfUse fieldOfUse)
+{
+    Adapter *a = static_cast<Adapter *>(context);
+
+    a->Start();
+
+    if (a->trackingStatus.callback)
+        a->trackingStatus.callback(IL_TrackingStatus_Ok, a->trackingStatus.context);
+}
+
+void Adapter::StopAdapter(ILAdapter_AdapterContext context)
+{
+    Adapter *a = static_cast<Adapter *>(context);
+
+    a->Stop();
+
+    if (a->trackingStatus.callback)
+        a->trackingStatus.callback(IL_TrackingStatus_NotAvailable, a->trackingStatus.context);
+}
+
+/**
+ * All stream callbacks are expected inside a transaction.
+ * */
+void Adapter::UpdateAdapter(ILAdapter_AdapterContext context)
+{
+    Adapter *a = static_cast<Adapter *>(context);
+
+    if (a->beginTransaction.callback)
+        a->beginTransaction.callback(a->beginTransaction.context);
+
+    a->Update();
+
+    if (a->commitTransaction.callback)
+        a->commitTransaction.callback(a->commitTransaction.context);
+}
+
+bool Adapter::WaitForDeviceConnection(ILAdapter_AdapterContext context)
+{
+    return static_cast<Adapter *>(context)->WaitForConnection();
+}
+
+bool Adapter::WaitForStreamingDataAvailable(ILAdapter_AdapterContext context)
+{
+    return static_cast<Adapter *>(context)->WaitForData();
+}
+
+void Adapter::GetStreamTypesProvided(ILAdapter_AdapterContext context, ILAdapter_GetStreamTypesProvidedCallback callback, void *callbackContext)
+{
+    Adapter *a = static_cast<Adapter *>(context);
+
+    callback(a->provided.data(), static_cast<unsigned>(a->provided.size()), callbackContext);
+}
+
+/**
+ * Gaze points are posted in display units with the origin in the
+ * top left corner, so the range is the display area itself.
+ * */
+void Adapter::GetStreamCoordinateTransformInfo(ILAdapter_AdapterContext context, ILAdapter_GetStreamCoordinateTransformInfoCallback callback, void *callbackContext)
+{
+    Adapter *a = static_cast<Adapter *>(context);
+
+    IL_StreamCoordinateTransformInfo info = {};
+    info.streamType = IL_StreamInputType_GazePointData;
+    info.unitsPerMm_xy[0] = 1.0f;
+    info.unitsPerMm_xy[1] = 1.0f;
+    info.rangeUnits_xy[0] = a->width;
+    info.rangeUnits_xy[1] = a->height;
+    info.coordinateSystemType = IL_StreamCoordinateSystemType_TopLeftLeftHanded;
+    info.displayAreaId = nullptr;
+    info.usesAbsoluteCoordinates = true;
+
+    callback(&info, 1, callbackContext);
+}
+
+void Adapter::RegisterBeginTransaction(ILAdapter_AdapterContext context, ILAdapter_BeginTransactionCallback callback, void *callbackContext)
+{
+    static_cast<Adapter *>(context)->beginTransaction = {callback, callbackContext};
+}
+
+void Adapter::RegisterCommitTransaction(ILAdapter_AdapterContext context, ILAdapter_CommitTransactionCallback callback, void *callbackContext)
+{
+    static_cast<Adapter *>(context)->commitTransaction = {callback, callbackContext};
+}
+
+bool Adapter::RegisterGazePoint(ILAdapter_AdapterContext context, ILAdapter_PostGazePointDataCallback callback, void *callbackContext)
+{
+    static_cast<Adapter *>(context)->gazePoint = {callback, callbackContext};
+    return true;
+}
+
+bool Adapter::RegisterGazeOrigin(ILAdapter_AdapterContext context, ILAdapter_PostGazeOriginDataCallback callback, void *callbackContext)
+{
+    static_cast<Adapter *>(context)->gazeOrigin = {callback, callbackContext};
+    return true;
+}
+
+bool Adapter::RegisterPresence(ILAdapter_AdapterContext context, ILAdapter_PostPresenceDataCallback callback, void *callbackContext)
+{
+    static_cast<Adapter *>(context)->presence = {callback, callbackContext};
+    return true;
+}
+
+bool Adapter::RegisterHeadPose(ILAdapter_AdapterContext context, ILAdapter_PostHeadPoseDataCallback callback, void *callbackContext)
+{
+    static_cast<Adapter *>(context)->headPose = {callback, callbackContext};
+    return true;
+}
+
+bool Adapter::RegisterResponsiveGazePoint(ILAdapter_AdapterContext context, ILAdapter_PostResponsiveGazePointDataCallback callback, void *callbackContext)
+{
+    // None of the addon sources provide it.
+    return false;
+}
+
+bool Adapter::RegisterTrackingStatus(ILAdapter_AdapterContext context, ILAdapter_TrackingStatusCallback callback, void *callbackContext)
+{
+    static_cast<Adapter *>(context)->trackingStatus = {callback, callbackContext};
+    return true;
+}
+
+bool Adapter::RegisterDeviceNotification(ILAdapter_AdapterContext context, ILAdapter_DeviceNotificationCallback callback, void *callbackContext)
+{
+    // The set of streams never changes.
+    return true;
+}
+
+bool Adapter::RegisterLogging(ILAdapter_AdapterContext context, ILAdapter_LoggingCallback callback, void *callbackContext)
+{
+    return true;
+}
+
+bool Adapter::RegisterForwardLogging(ILAdapter_AdapterContext context, ILAdapter_ForwardLoggingStatementCallback callback, void *callbackContext)
+{
+    return true;
+}
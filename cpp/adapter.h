@@ -0,0 +1,91 @@
+/**
+ * Base for data sources that feed the interaction library through
+ * IL_AdapterFunctions instead of a Tobii device.
+ *
+ * The C glue, callback registration and transactions live here.
+ * Subclasses only decide when data is available and post it from Update().
+ *
+ * Posted gaze points are expected in display units, the same coordinate
+ * space the IL delivers them in, so a recording replays unchanged.
+ */
+
+#ifndef ADAPTER_H
+#define ADAPTER_H
+
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+
+class Adapter
+{
+public:
+    Adapter(float width, float height);
+    virtual ~Adapter();
+
+    IL_AdapterFunctions *Functions();
+
+protected:
+    // Streams this source posts, reported to the IL on request.
+    std::vector<IL_StreamInputType> provided;
+
+    // Block until a device, real or not, is connected.
+    virtual bool WaitForConnection() = 0;
+
+    // Block until the next sample is due.
+    virtual bool WaitForData() = 0;
+
+    // Post whatever is due, called inside a transaction.
+    virtual void Update() = 0;
+
+    virtual void Start() {}
+    virtual void Stop() {}
+
+    void PostGazePoint(const IL_GazePointData &data);
+    void PostGazeOrigin(const IL_GazeOriginData &data);
+    void PostPresence(const IL_PresenceData &data);
+    void PostHeadPose(const IL_HeadPoseData &data);
+
+private:
+    float width;
+    float height;
+
+    IL_AdapterFunctions functions;
+
+    template <typename T>
+    struct Callback
+    {
+        T callback;
+        void *context;
+    };
+
+    Callback<ILAdapter_BeginTransactionCallback> beginTransaction;
+    Callback<ILAdapter_CommitTransactionCallback> commitTransaction;
+    Callback<ILAdapter_PostGazePointDataCallback> gazePoint;
+    Callback<ILAdapter_PostGazeOriginDataCallback> gazeOrigin;
+    Callback<ILAdapter_PostPresenceDataCallback> presence;
+    Callback<ILAdapter_PostHeadPoseDataCallback> headPose;
+    Callback<ILAdapter_TrackingStatusCallback> trackingStatus;
+
+    static bool CreateAdapter(void *createDestroyContext, ILAdapter_AdapterContext *context);
+    static void DestroyAdapter(void *createDestroyContext, ILAdapter_AdapterContext *context);
+    static void StartAdapter(ILAdapter_AdapterContext context, IL_FieldOfUse fieldOfUse);
+    static void StopAdapter(ILAdapter_AdapterContext context);
+    static void UpdateAdapter(ILAdapter_AdapterContext context);
+    static bool WaitForDeviceConnection(ILAdapter_AdapterContext context);
+    static bool WaitForStreamingDataAvailable(ILAdapter_AdapterContext context);
+    static void GetStreamTypesProvided(ILAdapter_AdapterContext context, ILAdapter_GetStreamTypesProvidedCallback callback, void *callbackContext);
+    static void GetStreamCoordinateTransformInfo(ILAdapter_AdapterContext context, ILAdapter_GetStreamCoordinateTransformInfoCallback callback, void *callbackContext);
+
+    static void RegisterBeginTransaction(ILAdapter_AdapterContext context, ILAdapter_BeginTransactionCallback callback, void *callbackContext);
+    static void RegisterCommitTransaction(ILAdapter_AdapterContext context, ILAdapter_CommitTransactionCallback callback, void *callbackContext);
+    static bool RegisterGazePoint(ILAdapter_AdapterContext context, ILAdapter_PostGazePointDataCallback callback, void *callbackContext);
+    static bool RegisterGazeOrigin(ILAdapter_AdapterContext context, ILAdapter_PostGazeOriginDataCallback callback, void *callbackContext);
+    static bool RegisterPresence(ILAdapter_AdapterContext context, ILAdapter_PostPresenceDataCallback callback, void *callbackContext);
+    static bool RegisterHeadPose(ILAdapter_AdapterContext context, ILAdapter_PostHeadPoseDataCallback callback, void *callbackContext);
+    static bool RegisterResponsiveGazePoint(ILAdapter_AdapterContext context, ILAdapter_PostResponsiveGazePointDataCallback callback, void *callbackContext);
+    static bool RegisterTrackingStatus(ILAdapter_AdapterContext context, ILAdapter_TrackingStatusCallback callback, void *callbackContext);
+    static bool RegisterDeviceNotification(ILAdapter_AdapterContext context, ILAdapter_DeviceNotificationCallback callback, void *callbackContext);
+    static bool RegisterLogging(ILAdapter_AdapterContext context, ILAdapter_LoggingCallback callback, void *callbackContext);
+    static bool RegisterForwardLogging(ILAdapter_AdapterContext context, ILAdapter_ForwardLoggingStatementCallback callback, void *callbackContext);
+};
+
+#endif // ADAPTER_H
@@ -0,0 +1,499 @@
+/**
+ * Offline analytics over recordings, built as the analyze executable.
+ *
+ *   analyze [options] recording...
+ *
+ *   --layout path      interactor layout to hit test fixations against, see layout.h
+ *   --out dir          where to write the results, next to each recording by default
+ *   --threads n        worker threads, one per hardware thread by default
+ *   --velocity v       fixation velocity threshold in display units per second
+ *   --min-fixation ms  shortest fixation
+ *   --window ms        length of the windows fixation velocity is measured between
+ *
+ * For every recording it detects fixations, hit tests them against the
+ * layout, and writes dwell statistics and data quality metrics over the
+ * whole session to <recording>.json.
+ *
+ * Recordings are split into chunks of blocks which are analysed in
+ * parallel on a work-stealing pool, so a single long session uses every
+ * core as well as many short ones. The last chunk of a session to finish
+ * merges the results and writes the output.
+ *
+ * Exits with 1 if any recording could not be read in full or its
+ * results could not be written.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fixation.h"
+#include "hittest.h"
+#include "layout.h"
+#include "pool.h"
+#include "quality.h"
+#include "reader.h"
+
+struct Options
+{
+    std::string out;
+    unsigned threads;
+    FixationOptions fixation;
+    std::vector<Interactor> layout;
+};
+
+// Samples a chunk aims for, large enough to amortize the task.
+static const size_t CHUNK_SAMPLES = 64 * 1024;
+
+// Recordings that failed, for the exit status.
+static std::atomic<unsigned> failures(0);
+
+/**
+ * Data quality over a whole session, see QualityMonitor for the
+ * definitions. Chunks are merged into one.
+ */
+struct SessionQuality
+{
+    uint64_t samples;
+    uint64_t invalid;
+    RunningStats steps;
+    RunningStats intervals;
+    uint64_t buckets[QualityStats::INTERVAL_BUCKETS];
+
+    SessionQuality() : samples(0), invalid(0), buckets() {}
+
+    void Add(const IL_GazePointData &sample, const IL_GazePointData *previous)
+    {
+        samples++;
+        if (sample.validity != IL_Validity_Valid)
+            invalid++;
+
+        if (!previous)
+            return;
+
+        double interval = static_cast<double>(sample.timestamp_us - previous->timestamp_us);
+        intervals.Add(interval);
+        buckets[QualityMonitor::Bucket(interval)]++;
+
+        if (sample.validity == IL_Validity_Valid && previous->validity == IL_Validity_Valid)
+        {
+            double dx = sample.x - previous->x;
+            double dy = sample.y - previous->y;
+            steps.Add(dx * dx + dy * dy);
+        }
+    }
+
+    void Merge(const SessionQuality &other)
+    {
+        samples += other.samples;
+        invalid += other.invalid;
+        steps.Merge(other.steps);
+        intervals.Merge(other.intervals);
+
+        for (int i = 0; i < QualityStats::INTERVAL_BUCKETS; i++)
+            buckets[i] += other.buckets[i];
+    }
+};
+
+struct Chunk
+{
+    size_t firstBlock;
+    size_t lastBlock;
+    uint64_t firstIndex;
+
+    std::vector<Fixation> runs;
+    SessionQuality quality;
+
+    // Blocks that did not decode.
+    size_t damaged;
+};
+
+struct Session
+{
+    std::string path;
+    std::string output;
+    RecordingReader reader;
+
+    std::vector<Chunk> chunks;
+    std::atomic<size_t> remaining;
+};
+
+/**
+ * Samples from the blocks before a chunk, enough to cover the two
+ * fixation windows before its first sample. Stops after a block that did not
+ * decode, as reading through would have.
+ * */
+static std::vector<RecordSpan> Lead(const Options &options, const RecordingReader &reader, size_t firstBlock)
+{
+    std::vector<RecordSpan> lead;
+    if (firstBlock == 0)
+        return lead;
+
+    IL::Timestamp from_us = reader.Entry(RECORD_GAZE_POINT, firstBlock - 1).last_us - 2 * options.fixation.window_us;
+
+    for (size_t block = firstBlock; block-- > 0;)
+    {
+        const IndexEntry &entry = reader.Entry(RECORD_GAZE_POINT, block);
+
+        RecordSpan span = reader.ReadBlock(RECORD_GAZE_POINT, block);
+        if (span.count < entry.count)
+            break;
+
+        lead.insert(lead.begin(), span);
+        if (entry.first_us <= from_us)
+            break;
+    }
+
+    return lead;
+}
+
+/**
+ * Fixation runs and quality of one chunk. The detector is primed with
+ * the windows before the chunk so runs can cross the boundary.
+ * */
+static void AnalyzeChunk(const Options &options, Session &session, Chunk &chunk)
+{
+    const RecordingReader &reader = session.reader;
+
+    FixationDetector detector(options.fixation, reader.Start(), chunk.runs);
+
+    IL_GazePointData previous;
+    bool hasPrevious = false;
+
+    std::vector<RecordSpan> lead = Lead(options, reader, chunk.firstBlock);
+
+    for (const RecordSpan &span : lead)
+    {
+        for (uint32_t i = 0; i < span.count; i++)
+        {
+            std::memcpy(&previous, span.records + static_cast<size_t>(i) * span.size, sizeof(previous));
+            detector.Prime(previous);
+            hasPrevious = true;
+        }
+    }
+
+    uint64_t index = chunk.firstIndex;
+
+    for (size_t block = chunk.firstBlock; block < chunk.lastBlock; block++)
+    {
+        RecordSpan span = reader.ReadBlock(RECORD_GAZE_POINT, block);
+        uint32_t count = reader.Entry(RECORD_GAZE_POINT, block).count;
+
+        for (uint32_t i = 0; i < span.count; i++)
+        {
+            IL_GazePointData sample;
+            std::memcpy(&sample, span.records + static_cast<size_t>(i) * span.size, sizeof(sample));
+
+            detector.Add(sample, index + i);
+            chunk.quality.Add(sample, hasPrevious ? &previous : nullptr);
+
+            previous = sample;
+            hasPrevious = true;
+        }
+
+        // A block that does not decode ends any fixation.
+        if (span.count < count)
+        {
+            detector.Reset();
+            hasPrevious = false;
+            chunk.damaged++;
+        }
+
+        index += count;
+    }
+
+    detector.Flush();
+}
+
+struct AoiStats
+{
+    IL::InteractorId id;
+    uint64_t fixations;
+    IL::Timestamp dwell_us;
+    IL::Timestamp first_us;
+};
+
+/**
+ * A string as a JSON string literal, quotes included.
+ * */
+static std::string JsonString(const std::string &value)
+{
+    std::string out = "\"";
+
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+
+    return out + "\"";
+}
+
+/**
+ * Returns false if the results could not be written.
+ * */
+static bool WriteSession(const Options &options, Session &session)
+{
+    std::vector<std::vector<Fixation>> runs;
+    SessionQuality quality;
+    size_t damaged = 0;
+
+    for (Chunk &chunk : session.chunks)
+    {
+        runs.push_back(std::move(chunk.runs));
+        quality.Merge(chunk.quality);
+        damaged += chunk.damaged;
+    }
+
+    if (damaged)
+    {
+        std::fprintf(stderr, "%s: %zu damaged blocks skipped\n", session.path.c_str(), damaged);
+        failures++;
+    }
+
+    std::vector<Fixation> fixations;
+    MergeFixations(runs, options.fixation, fixations);
+
+    IL::Timestamp start_us = session.reader.Start();
+    IL::Timestamp end_us = session.reader.End();
+
+    // Dwell per interactor, from the fixations that land on it.
+    std::vector<AoiStats> aois;
+    for (const Interactor &interactor : options.layout)
+        aois.push_back({interactor.id, 0, 0, -1});
+
+    RunningStats durations;
+    IL::Timestamp outside_us = 0;
+
+    for (const Fixation &fixation : fixations)
+    {
+        durations.Add(static_cast<double>(fixation.Duration()));
+
+        const Interactor *hit = HitTest(options.layout, fixation.X(), fixation.Y());
+        if (!hit)
+        {
+            outside_us += fixation.Duration();
+            continue;
+        }
+
+        AoiStats &aoi = aois[hit - options.layout.data()];
+        aoi.fixations++;
+        aoi.dwell_us += fixation.Duration();
+        if (aoi.first_us < 0)
+            aoi.first_us = fixation.start_us - start_us;
+    }
+
+    std::FILE *file = std::fopen(session.output.c_str(), "w");
+    if (!file)
+    {
+        std::fprintf(stderr, "%s: could not write %s\n", session.path.c_str(), session.output.c_str());
+        return false;
+    }
+
+    double fixated_us = durations.Mean() * durations.Count();
+
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"recording\": %s,\n", JsonString(session.path).c_str());
+    std::fprintf(file, "  \"start_us\": %lld,\n", static_cast<long long>(start_us));
+    std::fprintf(file, "  \"end_us\": %lld,\n", static_cast<long long>(end_us));
+    std::fprintf(file, "  \"duration_us\": %lld,\n", static_cast<long long>(end_us - start_us));
+
+    std::fprintf(file, "  \"quality\": {\n");
+    std::fprintf(file, "    \"samples\": %llu,\n", static_cast<unsigned long long>(quality.samples));
+    std::fprintf(file, "    \"dataLoss\": %.6f,\n", quality.samples ? static_cast<double>(quality.invalid) / quality.samples : 0.0);
+    std::fprintf(file, "    \"precisionRms\": %.4f,\n", std::sqrt(quality.steps.Mean()));
+    std::fprintf(file, "    \"intervalMean\": %.2f,\n", quality.intervals.Mean());
+    std::fprintf(file, "    \"intervalSd\": %.2f,\n", std::sqrt(quality.intervals.Variance()));
+    std::fprintf(file, "    \"intervals\": [");
+    for (int i = 0; i < QualityStats::INTERVAL_BUCKETS; i++)
+        std::fprintf(file, "%s%llu", i ? ", " : "", static_cast<unsigned long long>(quality.buckets[i]));
+    std::fprintf(file, "]\n  },\n");
+
+    std::fprintf(file, "  \"fixations\": {\n");
+    std::fprintf(file, "    \"count\": %llu,\n", static_cast<unsigned long long>(fixations.size()));
+    std::fprintf(file, "    \"meanDuration_us\": %.1f,\n", durations.Mean());
+    std::fprintf(file, "    \"sdDuration_us\": %.1f,\n", std::sqrt(durations.Variance()));
+    std::fprintf(file, "    \"outsideDwell_us\": %lld\n", static_cast<long long>(outside_us));
+    std::fprintf(file, "  },\n");
+
+    std::fprintf(file, "  \"aois\": [");
+    for (size_t i = 0; i < aois.size(); i++)
+    {
+        const AoiStats &aoi = aois[i];
+        std::fprintf(file, "%s\n    {\"id\": %llu, \"fixations\": %llu, \"dwell_us\": %lld, \"dwellShare\": %.6f, \"firstFixation_us\": %lld, \"meanFixation_us\": %.1f}",
+                     i ? "," : "",
+                     static_cast<unsigned long long>(aoi.id),
+                     static_cast<unsigned long long>(aoi.fixations),
+                     static_cast<long long>(aoi.dwell_us),
+                     fixated_us > 0.0 ? aoi.dwell_us / fixated_us : 0.0,
+                     static_cast<long long>(aoi.first_us),
+                     aoi.fixations ? static_cast<double>(aoi.dwell_us) / aoi.fixations : 0.0);
+    }
+    std::fprintf(file, "%s]\n}\n", aois.empty() ? "" : "\n  ");
+
+    bool written = !std::ferror(file);
+    if (std::fclose(file) != 0 || !written)
+    {
+        std::fprintf(stderr, "%s: could not write %s\n", session.path.c_str(), session.output.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Open a recording and queue one task per chunk. Runs on a worker,
+ * so its chunks land on that worker's deque and the others steal them.
+ * */
+static void AnalyzeFile(WorkPool &pool, const Options &options, const std::string &path)
+{
+    std::shared_ptr<Session> session(new Session());
+    session->path = path;
+
+    if (!session->reader.Open(path))
+    {
+        std::fprintf(stderr, "%s: not a recording\n", path.c_str());
+        failures++;
+        return;
+    }
+
+    std::string name = path;
+    if (!options.out.empty())
+    {
+        size_t slash = path.find_last_of("/\\");
+        name = options.out + "/" + (slash == std::string::npos ? path : path.substr(slash + 1));
+    }
+    session->output = name + ".json";
+
+    const RecordingReader &reader = session->reader;
+    size_t blocks = reader.Blocks(RECORD_GAZE_POINT);
+
+    uint64_t index = 0;
+    size_t block = 0;
+    do
+    {
+        Chunk chunk = {};
+        chunk.firstBlock = block;
+        chunk.firstIndex = index;
+
+        size_t samples = 0;
+        while (block < blocks && samples < CHUNK_SAMPLES)
+        {
+            samples += reader.Entry(RECORD_GAZE_POINT, block).count;
+            block++;
+        }
+
+        chunk.lastBlock = block;
+        index += samples;
+        session->chunks.push_back(std::move(chunk));
+    } while (block < blocks);
+
+    session->remaining = session->chunks.size();
+
+    for (size_t i = 0; i < session->chunks.size(); i++)
+    {
+        pool.Submit([&options, session, i]()
+                    {
+                        AnalyzeChunk(options, *session, session->chunks[i]);
+
+                        if (session->remaining.fetch_sub(1) == 1)
+                        {
+                            if (WriteSession(options, *session))
+                                std::printf("%s -> %s\n", session->path.c_str(), session->output.c_str());
+                            else
+                                failures++;
+                        } });
+    }
+}
+
+static void Usage()
+{
+    std::fprintf(stderr, "usage: analyze [--layout path] [--out dir] [--threads n] [--velocity v] [--min-fixation ms] [--window ms] recording...\n");
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    options.threads = 0;
+    options.fixation = DEFAULT_FIXATION_OPTIONS;
+
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--layout" && hasValue)
+        {
+            if (!LoadLayout(argv[++i], options.layout))
+            {
+                std::fprintf(stderr, "could not read layout %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--out" && hasValue)
+            options.out = argv[++i];
+        else if (arg == "--threads" && hasValue)
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--velocity" && hasValue)
+            options.fixation.velocity = std::atof(argv[++i]);
+        else if (arg == "--min-fixation" && hasValue)
+            options.fixation.minDuration_us = static_cast<IL::Timestamp>(std::atof(argv[++i]) * 1000.0);
+        else if (arg == "--window" && hasValue)
+            options.fixation.window_us = static_cast<IL::Timestamp>(std::atof(argv[++i]) * 1000.0);
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            Usage();
+            return 1;
+        }
+        else
+            paths.push_back(arg);
+    }
+
+    if (paths.empty())
+    {
+        Usage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    WorkPool pool(options.threads);
+
+    for (const std::string &path : paths)
+        pool.Submit([&pool, &options, path]()
+                    { AnalyzeFile(pool, options, path); });
+
+    pool.Wait();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu recordings in %.2f s on %u threads\n", paths.size(), seconds, pool.Threads());
+
+    if (failures)
+    {
+        std::fprintf(stderr, "%u of %zu recordings failed\n", failures.load(), paths.size());
+        return 1;
+    }
+
+    return 0;
+}
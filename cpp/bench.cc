@@ -0,0 +1,275 @@
+/**
+ * Microbenchmarks of the native hot paths, built as the bench executable.
+ *
+ *   bench [--samples n] [--seconds s] [--dir path]
+ *
+ *   --samples n   synthetic gaze points the sample benchmarks run over, 1000000 by default
+ *   --seconds s   least time each benchmark runs for, 0.5 by default
+ *   --dir path    where the recording benchmarks write, the working directory by default
+ *
+ * Every benchmark repeats its operation until the time is up and prints
+ * one JSON object per line to stdout: its name, the size it ran at, how
+ * many operations it did in how long, and the rate. Gaze points come from
+ * the synthetic adapter's script, generated ahead of time so the clock
+ * never waits for them. bench/bench.js runs this next to the binding
+ * benchmarks and collects the results.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+#include <interaction_lib/misc/InteractionLibPtr.h>
+
+#include "blink.h"
+#include "hittest.h"
+#include "quality.h"
+#include "reader.h"
+#include "recording.h"
+#include "synthetic.h"
+
+static const float WIDTH = 1920.0f;
+static const float HEIGHT = 1080.0f;
+
+static const size_t INTERACTOR_COUNTS[] = {100, 10000, 100000};
+
+struct Options
+{
+    size_t samples;
+    double seconds;
+    std::string dir;
+};
+
+/**
+ * Run operation, which does ops operations of bytes bytes in total, until
+ * the time is up and print the rate. Whatever operation returns is summed
+ * and printed so the compiler can't drop the work.
+ * */
+static void Measure(const Options &options, const char *name, size_t size, uint64_t ops, uint64_t bytes, const std::function<double()> &operation)
+{
+    uint64_t runs = 0;
+    double check = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+    double seconds;
+    do
+    {
+        check += operation();
+        runs++;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < options.seconds);
+
+    double total = static_cast<double>(runs * ops);
+
+    std::printf("{\"name\": \"%s\", \"size\": %zu, \"ops\": %.0f, \"seconds\": %.6f, \"opsPerSecond\": %.1f, \"nsPerOp\": %.3f",
+                name, size, total, seconds, total / seconds, seconds * 1e9 / total);
+    if (bytes)
+        std::printf(", \"bytesPerSecond\": %.1f", static_cast<double>(runs * bytes) / seconds);
+    std::printf(", \"check\": %g}\n", check);
+    std::fflush(stdout);
+}
+
+/**
+ * count interactors tiling the display, the last ones on top.
+ * */
+static std::vector<Interactor> Layout(size_t count)
+{
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(count * WIDTH / HEIGHT)));
+    size_t rows = (count + columns - 1) / columns;
+    float w = WIDTH / columns;
+    float h = HEIGHT / rows;
+
+    std::vector<Interactor> layout;
+    layout.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        IL::Rectangle bounds = {(i % columns) * w, (i / columns) * h, w, h};
+        layout.push_back({static_cast<IL::InteractorId>(i + 1), bounds, static_cast<float>(i % 4)});
+    }
+
+    return layout;
+}
+
+/**
+ * What AddRectangles costs the tracker thread: one transaction with
+ * every interactor of the layout.
+ * */
+static void BenchCommit(const Options &options)
+{
+    IL::UniqueInteractionLibPtr tobii(IL::CreateInteractionLib(IL::FieldOfUse::Interactive));
+    tobii->CoordinateTransformAddOrUpdateDisplayArea(WIDTH, HEIGHT);
+
+    for (size_t count : INTERACTOR_COUNTS)
+    {
+        std::vector<Interactor> layout = Layout(count);
+
+        Measure(options, "commitInteractors", count, 1, 0, [&]()
+                {
+                    tobii->BeginInteractorUpdates();
+                    for (const Interactor &interactor : layout)
+                        tobii->AddOrUpdateInteractor(interactor.id, interactor.bounds, interactor.z);
+                    tobii->CommitInteractorUpdates();
+                    return 0.0; });
+
+        tobii->BeginInteractorUpdates();
+        tobii->ClearInteractors();
+        tobii->CommitInteractorUpdates();
+    }
+}
+
+static void BenchHitTest(const Options &options, const std::vector<IL_GazePointData> &samples)
+{
+    for (size_t count : INTERACTOR_COUNTS)
+    {
+        std::vector<Interactor> layout = Layout(count);
+
+        // Fewer samples over the larger layouts, each one scans them all.
+        size_t n = std::min(samples.size(), std::max<size_t>(1000, 100000000 / count));
+
+        Measure(options, "hitTest", count, n, 0, [&]()
+                {
+                    double hits = 0.0;
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        const Interactor *hit = HitTest(layout, samples[i].x, samples[i].y);
+                        hits += hit ? hit->id : 0;
+                    }
+                    return hits; });
+    }
+}
+
+static void OnBlink(const BlinkEvent &evt, void *context)
+{
+    (*static_cast<double *>(context))++;
+}
+
+static void BenchFilters(const Options &options, const std::vector<IL_GazePointData> &samples)
+{
+    double blinks = 0.0;
+    BlinkDetector detector(OnBlink, &blinks);
+
+    Measure(options, "blinkDetector", samples.size(), samples.size(), 0, [&]()
+            {
+                detector.Reset();
+                for (const IL_GazePointData &sample : samples)
+                    detector.OnGazePoint(sample);
+                return blinks; });
+
+    QualityMonitor quality;
+
+    Measure(options, "qualityMonitor", samples.size(), samples.size(), 0, [&]()
+            {
+                quality.Reset();
+                for (const IL_GazePointData &sample : samples)
+                    quality.OnGazePoint(sample);
+                return quality.Stats().samples; });
+}
+
+/**
+ * Write the samples in blocks as the recorder's I/O thread does, then
+ * read them back from the file.
+ * */
+static void BenchRecording(const Options &options, const std::vector<IL_GazePointData> &samples)
+{
+    uint32_t chunk = static_cast<uint32_t>(Recorder::BLOCK_SIZE / sizeof(IL_GazePointData)) - 1;
+    uint64_t bytes = samples.size() * sizeof(IL_GazePointData);
+
+    for (bool compressed : {false, true})
+    {
+        std::string path = options.dir + (compressed ? "/bench_compressed.etrk" : "/bench.etrk");
+
+        Measure(options, compressed ? "recordingWriteCompressed" : "recordingWrite", samples.size(), samples.size(), bytes, [&]()
+                {
+                    RecordingWriter writer;
+                    if (!writer.Open(path, compressed))
+                    {
+                        std::fprintf(stderr, "could not write %s\n", path.c_str());
+                        std::exit(1);
+                    }
+
+                    for (size_t i = 0; i < samples.size(); i += chunk)
+                    {
+                        uint32_t count = static_cast<uint32_t>(std::min<size_t>(chunk, samples.size() - i));
+                        writer.WriteChunk(RECORD_GAZE_POINT, reinterpret_cast<const char *>(&samples[i]), count);
+                    }
+
+                    return writer.Finish() ? 0.0 : 1.0; });
+
+        Measure(options, compressed ? "recordingReadCompressed" : "recordingRead", samples.size(), samples.size(), bytes, [&]()
+                {
+                    RecordingReader reader;
+                    if (!reader.Open(path))
+                    {
+                        std::fprintf(stderr, "could not read %s\n", path.c_str());
+                        std::exit(1);
+                    }
+
+                    double sum = 0.0;
+                    for (const RecordSpan &span : reader.Read(RECORD_GAZE_POINT, samples.size()))
+                    {
+                        const IL_GazePointData *records = reinterpret_cast<const IL_GazePointData *>(span.records);
+                        for (uint32_t i = 0; i < span.count; i++)
+                            sum += records[i].x;
+                    }
+                    return sum; });
+
+        std::remove(path.c_str());
+    }
+}
+
+static void Usage()
+{
+    std::fprintf(stderr, "usage: bench [--samples n] [--seconds s] [--dir path]\n");
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    options.samples = 1000000;
+    options.seconds = 0.5;
+    options.dir = ".";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--samples" && hasValue)
+            options.samples = static_cast<size_t>(std::atof(argv[++i]));
+        else if (arg == "--seconds" && hasValue)
+            options.seconds = std::atof(argv[++i]);
+        else if (arg == "--dir" && hasValue)
+            options.dir = argv[++i];
+        else
+        {
+            Usage();
+            return 1;
+        }
+    }
+
+    if (options.samples == 0)
+    {
+        Usage();
+        return 1;
+    }
+
+    // 1200 Hz with some dropout, so the blink detector has work to do.
+    SyntheticOptions synthetic = SyntheticAdapter::DEFAULTS;
+    synthetic.rate = 1200.0;
+    synthetic.dropout = 0.05;
+
+    std::vector<IL_GazePointData> samples;
+    SyntheticAdapter(WIDTH, HEIGHT, synthetic).Generate(options.samples, samples);
+
+    BenchCommit(options);
+    BenchHitTest(options, samples);
+    BenchFilters(options, samples);
+    BenchRecording(options, samples);
+
+    return 0;
+}
@@ -4,7 +4,35 @@
       "target_name": "focus",
       "sources": [
         "main.cc",
-        "screen.cc"
+        "screen.cc",
+        "tracker.cc",
+        "hub.cc",
+        "blink.cc",
+        "quality.cc",
+        "history.cc",
+        "latency.cc",
+        "counters.cc",
+        "trace.cc",
+        "tracer.cc",
+        "logging.cc",
+        "logger.cc",
+        "recording.cc",
+        "flight.cc",
+        "broadcast.cc",
+        "broadcastfile.cc",
+        "server.cc",
+        "interactortablefile.cc",
+        "codec.cc",
+        "reader.cc",
+        "recordingfile.cc",
+        "adapter.cc",
+        "replay.cc",
+        "synthetic.cc",
+        "pool.cc",
+        "whatif.cc",
+        "robustness.cc",
+        "estimator.cc",
+        "jsutil.cc"
       ],
       "conditions": [
         [
@@ -28,8 +56,108 @@
               }
             ]
           }
+        ],
+        [
+          "OS==\"linux\"",
+          {
+            "sources": [
+              "engine.cc"
+            ],
+            "include_dirs": [
+              "<(module_root_dir)/tobii/include"
+            ],
+            "cflags": [
+              "-fno-math-errno"
+            ]
+          }
+        ]
+      ]
+    },
+    {
+      "target_name": "bench",
+      "type": "executable",
+      "sources": [
+        "bench.cc",
+        "adapter.cc",
+        "synthetic.cc",
+        "blink.cc",
+        "quality.cc",
+        "recording.cc",
+        "trace.cc",
+        "codec.cc",
+        "reader.cc"
+      ],
+      "conditions": [
+        [
+          "OS==\"win\"",
+          {
+            "libraries": [
+              "<(module_root_dir)/tobii/lib/x64/tobii_interaction_lib.lib",
+              "<(module_root_dir)/tobii/lib/x64/tobii_stream_engine.lib"
+            ],
+            "include_dirs": [
+              "<(module_root_dir)/tobii/include"
+            ]
+          }
+        ],
+        [
+          "OS==\"linux\"",
+          {
+            "sources": [
+              "engine.cc"
+            ],
+            "include_dirs": [
+              "<(module_root_dir)/tobii/include"
+            ],
+            "libraries": [
+              "-pthread"
+            ]
+          }
+        ]
+      ]
+    },
+    {
+      "target_name": "analyze",
+      "type": "executable",
+      "sources": [
+        "analyze.cc",
+        "fixation.cc",
+        "layout.cc",
+        "pool.cc",
+        "quality.cc",
+        "recording.cc",
+        "trace.cc",
+        "codec.cc",
+        "reader.cc"
+      ],
+      "conditions": [
+        [
+          "OS==\"win\"",
+          {
+            "libraries": [
+              "<(module_root_dir)/tobii/lib/x64/tobii_interaction_lib.lib",
+              "<(module_root_dir)/tobii/lib/x64/tobii_stream_engine.lib"
+            ],
+            "include_dirs": [
+              "<(module_root_dir)/tobii/include"
+            ]
+          }
+        ],
+        [
+          "OS==\"linux\"",
+          {
+            "sources": [
+              "engine.cc"
+            ],
+            "include_dirs": [
+              "<(module_root_dir)/tobii/include"
+            ],
+            "libraries": [
+              "-pthread"
+            ]
+          }
         ]
       ]
     }
   ]
-}
\ No newline at end of file
+}
@@ -0,0 +1,75 @@
+#include "blink.h"
+
+BlinkDetector::BlinkDetector(BlinkEventCallback callback, void *context)
+{
+    BlinkDetector::callback = callback;
+    BlinkDetector::context = context;
+    Reset();
+}
+
+void BlinkDetector::Reset()
+{
+    both = {false, 0};
+    left = {false, 0};
+    right = {false, 0};
+}
+
+void BlinkDetector::Open(Run &run, IL::Timestamp timestamp_us)
+{
+    if (run.open)
+        return;
+
+    run.open = true;
+    run.start_us = timestamp_us;
+}
+
+/**
+ * Close a run at the first sample that no longer belongs to it and
+ * emit an event if the run was long enough to mean anything.
+ * Binocular runs are split into blinks and tracking loss by duration.
+ * */
+void BlinkDetector::Close(Run &run, IL::Timestamp timestamp_us, bool binocular, BlinkEventType type)
+{
+    if (!run.open)
+        return;
+
+    run.open = false;
+
+    IL::Timestamp duration = timestamp_us - run.start_us;
+    if (duration < MIN_BLINK_US)
+        return;
+
+    if (binocular)
+        type = duration > MAX_BLINK_US ? BlinkEventType::TrackingLoss : BlinkEventType::Blink;
+
+    BlinkEvent evt = {type, run.start_us, timestamp_us, duration};
+    callback(evt, context);
+}
+
+void BlinkDetector::OnGazePoint(const IL::GazePointData &evt)
+{
+    if (evt.validity == IL::Validity::Invalid)
+        Open(both, evt.timestamp_us);
+    else
+        Close(both, evt.timestamp_us, true, BlinkEventType::Blink);
+}
+
+/**
+ * A one-eye run lasts while that eye is invalid and the other one is valid.
+ * Losing both eyes ends it, that case is covered by the gaze point stream.
+ * */
+void BlinkDetector::OnGazeOrigin(const IL::GazeOriginData &evt)
+{
+    bool leftValid = evt.leftValidity == IL::Validity::Valid;
+    bool rightValid = evt.rightValidity == IL::Validity::Valid;
+
+    if (!leftValid && rightValid)
+        Open(left, evt.timestamp_us);
+    else
+        Close(left, evt.timestamp_us, false, BlinkEventType::LeftEyeLoss);
+
+    if (leftValid && !rightValid)
+        Open(right, evt.timestamp_us);
+    else
+        Close(right, evt.timestamp_us, false, BlinkEventType::RightEyeLoss);
+}
@@ -0,0 +1,69 @@
+/**
+ * Turns runs of invalid gaze samples into blink and tracking loss events.
+ *
+ * Binocular loss comes from the gaze point stream: a short run of
+ * invalid samples is a blink, a long one is a tracking loss.
+ * One-eye loss comes from the gaze origin stream, when one eye is
+ * invalid while the other one is still tracked.
+ */
+
+#ifndef BLINK_H
+#define BLINK_H
+
+#include <interaction_lib/InteractionLib.h>
+
+enum class BlinkEventType
+{
+    Blink,
+    TrackingLoss,
+    LeftEyeLoss,
+    RightEyeLoss
+};
+
+struct BlinkEvent
+{
+    BlinkEventType type;
+    IL::Timestamp start_us;
+    IL::Timestamp end_us;
+    IL::Timestamp duration_us;
+};
+
+typedef void (*BlinkEventCallback)(const BlinkEvent &evt, void *context);
+
+class BlinkDetector
+{
+private:
+    // An open run of invalid samples.
+    struct Run
+    {
+        bool open;
+        IL::Timestamp start_us;
+    };
+
+    Run both;
+    Run left;
+    Run right;
+
+    BlinkEventCallback callback;
+    void *context;
+
+    void Open(Run &run, IL::Timestamp timestamp_us);
+    void Close(Run &run, IL::Timestamp timestamp_us, bool binocular, BlinkEventType type);
+
+public:
+    // Runs shorter than this are dropped samples, not blinks.
+    static const IL::Timestamp MIN_BLINK_US = 50000;
+
+    // Runs longer than this are reported as tracking loss.
+    static const IL::Timestamp MAX_BLINK_US = 500000;
+
+    BlinkDetector(BlinkEventCallback callback, void *context);
+
+    void OnGazePoint(const IL::GazePointData &evt);
+    void OnGazeOrigin(const IL::GazeOriginData &evt);
+
+    // Forget any open run, e.g. when processing pauses.
+    void Reset();
+};
+
+#endif // BLINK_H
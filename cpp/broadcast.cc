@@ -0,0 +1,114 @@
+#include "broadcast.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * Writers open in the process. Screens are never destroyed, so their
+ * writers are closed here at exit, for readers to know and for the
+ * names to go away.
+ */
+static struct Writers
+{
+    std::mutex lock;
+    std::vector<BroadcastWriter *> open;
+
+    ~Writers()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (BroadcastWriter *writer : open)
+            writer->Close();
+    }
+} writers;
+
+BroadcastWriter::BroadcastWriter(PipelineCounters &counters) : counters(counters)
+{
+    BroadcastWriter::header = nullptr;
+
+    for (uint64_t &written : BroadcastWriter::written)
+        written = 0;
+}
+
+BroadcastWriter::~BroadcastWriter()
+{
+    Close();
+
+    std::lock_guard<std::mutex> guard(writers.lock);
+    writers.open.erase(std::remove(writers.open.begin(), writers.open.end(), this), writers.open.end());
+}
+
+void BroadcastWriter::Close()
+{
+    if (BroadcastWriter::header)
+        BroadcastWriter::header->closed.store(1, std::memory_order_release);
+
+    BroadcastWriter::segment.Unlink();
+}
+
+bool BroadcastWriter::Open(const std::string &name, uint32_t records)
+{
+    uint32_t capacity = 1;
+    while (capacity < records)
+        capacity <<= 1;
+
+    // Slots start 8 byte aligned so the sequences are.
+    uint32_t strides[RECORD_TYPES];
+    uint64_t offsets[RECORD_TYPES];
+    uint64_t size = (sizeof(BroadcastHeader) + 63) & ~uint64_t(63);
+
+    for (uint32_t i = 0; i < RECORD_TYPES; i++)
+    {
+        strides[i] = static_cast<uint32_t>((sizeof(BroadcastSlot) + RecordSize(i + 1) + 7) & ~size_t(7));
+        offsets[i] = size;
+        size += static_cast<uint64_t>(capacity) * strides[i];
+    }
+
+    if (!BroadcastWriter::segment.Create(name, static_cast<size_t>(size)))
+        return false;
+
+    // A new segment is zeroed, every sequence says nothing was written.
+    BroadcastHeader *header = new (BroadcastWriter::segment.Data()) BroadcastHeader();
+    header->version = BROADCAST_VERSION;
+    header->capacity = capacity;
+    header->closed.store(0, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < RECORD_TYPES; i++)
+    {
+        header->sizes[i] = RecordSize(i + 1);
+        header->strides[i] = strides[i];
+        header->offsets[i] = offsets[i];
+        header->written[i].store(0, std::memory_order_relaxed);
+    }
+
+    header->magic.store(BROADCAST_MAGIC, std::memory_order_release);
+
+    BroadcastWriter::header = header;
+
+    std::lock_guard<std::mutex> guard(writers.lock);
+    writers.open.push_back(this);
+    return true;
+}
+
+void BroadcastWriter::Append(RecordType type, const void *record)
+{
+    BroadcastHeader *h = BroadcastWriter::header;
+    uint64_t n = BroadcastWriter::written[type - 1]++;
+
+    char *slot = BroadcastWriter::segment.Data() + h->offsets[type - 1] + (n & (h->capacity - 1)) * h->strides[type - 1];
+    std::atomic<uint64_t> &sequence = reinterpret_cast<BroadcastSlot *>(slot)->sequence;
+
+    // Odd while the record is being written.
+    sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(slot + sizeof(BroadcastSlot), record, h->sizes[type - 1]);
+
+    sequence.store(2 * (n + 1), std::memory_order_release);
+    h->written[type - 1].store(n + 1, std::memory_order_release);
+
+    BroadcastWriter::counters.Add(COUNTER_BROADCAST_WRITTEN);
+    if (n >= h->capacity)
+        BroadcastWriter::counters.Add(COUNTER_BROADCAST_OVERWRITTEN);
+}
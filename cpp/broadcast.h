@@ -0,0 +1,216 @@
+/**
+ * Gaze broadcast over shared memory, for other processes on the same
+ * machine to read every stream of a Screen at full rate, without a
+ * socket or a copy through the kernel.
+ *
+ * The segment, shm_open(name) or a named file mapping on Windows, holds
+ * a header followed by one ring of slots per stream, in RecordType order:
+ *
+ *   BroadcastHeader
+ *   capacity slots per stream, a BroadcastSlot followed by the IL_* record
+ *
+ * The tracker thread is the only writer. Each slot is a seqlock: the
+ * writer makes its sequence odd, writes the record, and makes it
+ * 2 * (n + 1) for the nth record of the stream. A reader that sees that
+ * sequence both before and after looking at the record saw it whole.
+ * Readers never write to the segment, so any number of them can attach,
+ * and one that falls a ring behind skips what was overwritten.
+ *
+ * Focus ids are encoded as in recordings, see recording.h.
+ *
+ * The reader is header-only so other services can use it on its own:
+ *
+ *   BroadcastReader reader;
+ *   reader.Open("focus");
+ *
+ *   uint64_t next = reader.Written(RECORD_GAZE_POINT);
+ *   IL_GazePointData points[64];
+ *   uint64_t lost = 0;
+ *   size_t count = reader.Read(RECORD_GAZE_POINT, next, points, 64, lost);
+ */
+
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <interaction_lib/InteractionLib.h>
+
+#include "counters.h"
+#include "mapping.h"
+#include "recording.h"
+
+static const uint32_t BROADCAST_MAGIC = 0x425a4746;
+static const uint32_t BROADCAST_VERSION = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the broadcast needs lock-free 64 bit atomics");
+
+struct BroadcastHeader
+{
+    // Stored last, readers ignore a segment until it is set.
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+
+    // Slots per stream, a power of two.
+    uint32_t capacity;
+
+    // Set when the writer goes away, reopen to follow the next one.
+    std::atomic<uint32_t> closed;
+
+    // Of each stream, indexed by type - 1.
+    uint32_t sizes[RECORD_TYPES];
+    uint32_t strides[RECORD_TYPES];
+    uint64_t offsets[RECORD_TYPES];
+
+    // Records written so far.
+    alignas(64) std::atomic<uint64_t> written[RECORD_TYPES];
+};
+
+struct BroadcastSlot
+{
+    std::atomic<uint64_t> sequence;
+};
+
+/**
+ * Writer side, used by the tracker thread, see broadcast.cc.
+ */
+class BroadcastWriter
+{
+public:
+    explicit BroadcastWriter(PipelineCounters &counters);
+    ~BroadcastWriter();
+
+    // Create the segment with room for at least records per stream.
+    bool Open(const std::string &name, uint32_t records);
+
+    void Append(RecordType type, const void *record);
+
+    // Tell readers the broadcast is over and remove its name. Appending
+    // afterwards is harmless, so any thread can call it.
+    void Close();
+
+private:
+    PipelineCounters &counters;
+    SharedMapping segment;
+    BroadcastHeader *header;
+
+    // Records written of each stream, only the tracker thread writes them.
+    uint64_t written[RECORD_TYPES];
+};
+
+class BroadcastReader
+{
+public:
+    BroadcastReader() : header(nullptr) {}
+
+    /**
+     * Attach to the broadcast of a Screen, false if there is none by
+     * that name or it isn't ready yet.
+     * */
+    bool Open(const std::string &name)
+    {
+        BroadcastReader::segment.Close();
+        BroadcastReader::header = nullptr;
+
+        if (!BroadcastReader::segment.Open(name) || BroadcastReader::segment.Size() < sizeof(BroadcastHeader))
+            return false;
+
+        const BroadcastHeader *header = reinterpret_cast<const BroadcastHeader *>(BroadcastReader::segment.Data());
+        if (header->magic.load(std::memory_order_acquire) != BROADCAST_MAGIC || header->version != BROADCAST_VERSION)
+            return false;
+
+        // The last stream has to end inside the mapping.
+        const uint32_t last = RECORD_TYPES - 1;
+        if (header->offsets[last] + static_cast<uint64_t>(header->capacity) * header->strides[last] > BroadcastReader::segment.Size())
+            return false;
+
+        BroadcastReader::header = header;
+        return true;
+    }
+
+    bool IsOpen() const { return BroadcastReader::header != nullptr; }
+
+    // The writer went away, Open again to follow the next one.
+    bool Closed() const { return !BroadcastReader::header || BroadcastReader::header->closed.load(std::memory_order_acquire) != 0; }
+
+    uint32_t Capacity() const { return BroadcastReader::header->capacity; }
+    uint32_t Size(uint32_t type) const { return BroadcastReader::header->sizes[type - 1]; }
+
+    // Records of the stream written so far, the next one will be this.
+    uint64_t Written(uint32_t type) const
+    {
+        return BroadcastReader::header->written[type - 1].load(std::memory_order_acquire);
+    }
+
+    /**
+     * Call visit with the nth record of the stream where it lies in the
+     * segment, no copy made. Returns false if the record isn't there,
+     * not written yet or overwritten, including while visit looked at
+     * it, in which case whatever visit made of it must be thrown away.
+     * */
+    template <typename F>
+    bool Visit(uint32_t type, uint64_t n, F visit) const
+    {
+        const char *slot = Slot(type, n);
+        const std::atomic<uint64_t> &sequence = reinterpret_cast<const BroadcastSlot *>(slot)->sequence;
+
+        uint64_t expected = 2 * (n + 1);
+        if (sequence.load(std::memory_order_acquire) != expected)
+            return false;
+
+        visit(static_cast<const void *>(slot + sizeof(BroadcastSlot)));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+    /**
+     * Copy up to max records of the stream from next on, and move next
+     * past them. Records the reader fell too far behind for are skipped
+     * and added to lost. Returns how many were copied.
+     * */
+    size_t Read(uint32_t type, uint64_t &next, void *records, size_t max, uint64_t &lost) const
+    {
+        uint32_t size = Size(type);
+        char *out = static_cast<char *>(records);
+        size_t count = 0;
+
+        while (count < max)
+        {
+            uint64_t written = Written(type);
+            if (next >= written)
+                break;
+
+            if (written - next > BroadcastReader::header->capacity)
+            {
+                lost += written - BroadcastReader::header->capacity - next;
+                next = written - BroadcastReader::header->capacity;
+            }
+
+            bool copied = Visit(type, next, [&](const void *record)
+                                { std::memcpy(out + count * size, record, size); });
+
+            if (copied)
+                count++;
+            else
+                lost++;
+            next++;
+        }
+
+        return count;
+    }
+
+private:
+    SharedMapping segment;
+    const BroadcastHeader *header;
+
+    const char *Slot(uint32_t type, uint64_t n) const
+    {
+        const BroadcastHeader *h = BroadcastReader::header;
+        return BroadcastReader::segment.Data() + h->offsets[type - 1] + (n & (h->capacity - 1)) * h->strides[type - 1];
+    }
+};
+
+#endif // BROADCAST_H
@@ -0,0 +1,173 @@
+#include "broadcastfile.h"
+
+#include <algorithm>
+
+/**
+ * Binds the Broadcast object to v8.
+ * */
+void BroadcastFile::Init(v8::Local<v8::Object> exports)
+{
+    v8::Isolate *isolate = exports->GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    v8::Local<v8::FunctionTemplate> tpl = v8::FunctionTemplate::New(isolate, BroadcastFile::New);
+    tpl->SetClassName(v8::String::NewFromUtf8(isolate, "Broadcast").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    NODE_SET_PROTOTYPE_METHOD(tpl, "Read", BroadcastFile::Read);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetLost", BroadcastFile::GetLost);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetCapacity", BroadcastFile::GetCapacity);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "IsClosed", BroadcastFile::IsClosed);
+
+    v8::Local<v8::Function> construct = tpl->GetFunction(context).ToLocalChecked();
+
+    v8::Local<v8::String> object_name = v8::String::NewFromUtf8(isolate, "Broadcast").ToLocalChecked();
+    exports->Set(context, object_name, construct).FromJust();
+}
+
+/**
+ * JS constructor, let broadcast = new Broadcast('focus');
+ * Reading starts from the records written after this.
+ * Throws if there is no broadcast by that name.
+ * */
+void BroadcastFile::New(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    if (!args.IsConstructCall())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "Please init Broadcast with the 'new' keyword");
+        return;
+    }
+
+    if (!args[0]->IsString())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a broadcast name");
+        return;
+    }
+
+    v8::String::Utf8Value name(isolate, args[0]);
+
+    BroadcastFile *b = new BroadcastFile();
+    if (!b->reader.Open(*name))
+    {
+        delete b;
+
+        std::string message = std::string("Could not open broadcast ") + *name;
+        isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+        return;
+    }
+
+    for (uint32_t type = 1; type <= RECORD_TYPES; type++)
+    {
+        b->next[type - 1] = b->reader.Written(type);
+        b->lost[type - 1] = 0;
+    }
+
+    b->Wrap(args.This());
+    args.GetReturnValue().Set(args.This());
+}
+
+/**
+ * Stream numbers are the RecordType values, 1 gaze point to 5 focus.
+ * */
+bool BroadcastFile::Stream(v8::Isolate *isolate, v8::Local<v8::Value> value, uint32_t &type)
+{
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    if (!value->IsNumber())
+        return false;
+
+    int64_t stream = value->IntegerValue(ctx).FromMaybe(0);
+    if (stream < 1 || stream > RECORD_TYPES)
+        return false;
+
+    type = static_cast<uint32_t>(stream);
+    return true;
+}
+
+/**
+ * Copy the records of a stream written since the last Read into one
+ * ArrayBuffer of IL_* structs, empty if there are none.
+ *
+ * params
+ * stream   number
+ * max      number, optional, at most this many records
+ * */
+void BroadcastFile::Read(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    BroadcastFile *b = ObjectWrap::Unwrap<BroadcastFile>(args.Holder());
+
+    uint32_t type;
+    if (!Stream(isolate, args[0], type))
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a stream number");
+        return;
+    }
+
+    size_t max = DEFAULT_READ;
+    if (args[1]->IsNumber())
+        max = static_cast<size_t>(std::max<int64_t>(0, args[1]->IntegerValue(ctx).FromMaybe(0)));
+
+    // No more than a ring's worth can be there to read.
+    uint64_t &next = b->next[type - 1];
+    uint64_t pending = b->reader.Written(type) - std::min(next, b->reader.Written(type));
+    max = static_cast<size_t>(std::min<uint64_t>({max, pending, b->reader.Capacity()}));
+
+    size_t size = b->reader.Size(type);
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, max * size);
+    size_t count = b->reader.Read(type, next, buffer->Data(), max, b->lost[type - 1]);
+
+    // Records overwritten while they were copied leave the end unused.
+    if (count < max)
+    {
+        v8::Local<v8::ArrayBuffer> whole = v8::ArrayBuffer::New(isolate, count * size);
+        std::memcpy(whole->Data(), buffer->Data(), count * size);
+        buffer = whole;
+    }
+
+    args.GetReturnValue().Set(buffer);
+}
+
+/**
+ * Records of a stream this reader missed, overwritten before it got to
+ * them because it read too seldom.
+ * */
+void BroadcastFile::GetLost(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    BroadcastFile *b = ObjectWrap::Unwrap<BroadcastFile>(args.Holder());
+
+    uint32_t type;
+    if (!Stream(isolate, args[0], type))
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a stream number");
+        return;
+    }
+
+    args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(b->lost[type - 1])));
+}
+
+/**
+ * Records of each stream the ring holds.
+ * */
+void BroadcastFile::GetCapacity(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    BroadcastFile *b = ObjectWrap::Unwrap<BroadcastFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), b->reader.Capacity()));
+}
+
+/**
+ * True once the Screen that broadcasts is gone.
+ * */
+void BroadcastFile::IsClosed(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    BroadcastFile *b = ObjectWrap::Unwrap<BroadcastFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Boolean::New(args.GetIsolate(), b->reader.Closed()));
+}
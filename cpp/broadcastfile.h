@@ -0,0 +1,49 @@
+/**
+ * JS binding of BroadcastReader, for following the broadcast of a
+ * Screen in another process, e.g.
+ *
+ *   let broadcast = new Screen.Broadcast('focus');
+ *   setInterval(() => {
+ *       let points = new Float32Array(broadcast.Read(1));
+ *   }, 16);
+ *
+ * Read copies out what was written since the last call, the segment
+ * itself is never handed to JS since the writer reuses its slots.
+ */
+
+#ifndef BROADCASTFILE_H
+#define BROADCASTFILE_H
+
+#include <node.h>
+#include <v8.h>
+#include <node_object_wrap.h>
+
+#include "broadcast.h"
+#include "logging.h"
+
+class BroadcastFile : public node::ObjectWrap
+{
+private:
+    // Most records a Read returns unless told otherwise.
+    static const size_t DEFAULT_READ = 65536;
+
+    BroadcastReader reader;
+
+    // Next record to read and records lost of each stream.
+    uint64_t next[RECORD_TYPES];
+    uint64_t lost[RECORD_TYPES];
+
+    static bool Stream(v8::Isolate *isolate, v8::Local<v8::Value> value, uint32_t &type);
+
+    static void New(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void Read(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetLost(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetCapacity(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void IsClosed(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+public:
+    static void Init(v8::Local<v8::Object> exports);
+};
+
+#endif // BROADCASTFILE_H
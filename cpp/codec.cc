@@ -0,0 +1,352 @@
+#include "codec.h"
+#include "recording.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+enum class FieldKind
+{
+    Timestamp,
+    Integer,
+    Fixed
+};
+
+struct Field
+{
+    FieldKind kind;
+    uint32_t offset;
+    uint32_t size;
+
+    // Fixed-point steps per unit.
+    float scale;
+};
+
+#define FIELD_TIMESTAMP(T) {FieldKind::Timestamp, static_cast<uint32_t>(offsetof(T, timestamp_us)), 8, 0.0f}
+#define FIELD_INTEGER(T, m) {FieldKind::Integer, static_cast<uint32_t>(offsetof(T, m)), sizeof(T::m), 0.0f}
+#define FIELD_FIXED(T, m, s) {FieldKind::Fixed, static_cast<uint32_t>(offsetof(T, m)), 4, s}
+
+// Display units, i.e. pixels, to a tenth.
+static const float PIXEL_SCALE = 10.0f;
+
+// Millimetres to a hundredth.
+static const float MM_SCALE = 100.0f;
+
+// Radians to about a hundredth of a degree.
+static const float RADIAN_SCALE = 10000.0f;
+
+static const Field GAZE_POINT_FIELDS[] = {
+    FIELD_TIMESTAMP(IL_GazePointData),
+    FIELD_INTEGER(IL_GazePointData, validity),
+    FIELD_FIXED(IL_GazePointData, x, PIXEL_SCALE),
+    FIELD_FIXED(IL_GazePointData, y, PIXEL_SCALE),
+};
+
+static const Field GAZE_ORIGIN_FIELDS[] = {
+    FIELD_TIMESTAMP(IL_GazeOriginData),
+    FIELD_INTEGER(IL_GazeOriginData, leftValidity),
+    FIELD_FIXED(IL_GazeOriginData, left_xyz[0], MM_SCALE),
+    FIELD_FIXED(IL_GazeOriginData, left_xyz[1], MM_SCALE),
+    FIELD_FIXED(IL_GazeOriginData, left_xyz[2], MM_SCALE),
+    FIELD_INTEGER(IL_GazeOriginData, rightValidity),
+    FIELD_FIXED(IL_GazeOriginData, right_xyz[0], MM_SCALE),
+    FIELD_FIXED(IL_GazeOriginData, right_xyz[1], MM_SCALE),
+    FIELD_FIXED(IL_GazeOriginData, right_xyz[2], MM_SCALE),
+};
+
+static const Field HEAD_POSE_FIELDS[] = {
+    FIELD_TIMESTAMP(IL_HeadPoseData),
+    FIELD_INTEGER(IL_HeadPoseData, position_validity),
+    FIELD_FIXED(IL_HeadPoseData, position_xyz[0], MM_SCALE),
+    FIELD_FIXED(IL_HeadPoseData, position_xyz[1], MM_SCALE),
+    FIELD_FIXED(IL_HeadPoseData, position_xyz[2], MM_SCALE),
+    {FieldKind::Integer, static_cast<uint32_t>(offsetof(IL_HeadPoseData, rotation_validity_xyz[0])), sizeof(IL_Validity), 0.0f},
+    {FieldKind::Integer, static_cast<uint32_t>(offsetof(IL_HeadPoseData, rotation_validity_xyz[1])), sizeof(IL_Validity), 0.0f},
+    {FieldKind::Integer, static_cast<uint32_t>(offsetof(IL_HeadPoseData, rotation_validity_xyz[2])), sizeof(IL_Validity), 0.0f},
+    FIELD_FIXED(IL_HeadPoseData, rotation_xyz[0], RADIAN_SCALE),
+    FIELD_FIXED(IL_HeadPoseData, rotation_xyz[1], RADIAN_SCALE),
+    FIELD_FIXED(IL_HeadPoseData, rotation_xyz[2], RADIAN_SCALE),
+};
+
+static const Field PRESENCE_FIELDS[] = {
+    FIELD_TIMESTAMP(IL_PresenceData),
+    FIELD_INTEGER(IL_PresenceData, presence),
+};
+
+static const Field GAZE_FOCUS_FIELDS[] = {
+    FIELD_TIMESTAMP(IL_GazeFocusEvent),
+    FIELD_INTEGER(IL_GazeFocusEvent, id),
+    FIELD_INTEGER(IL_GazeFocusEvent, hasFocus),
+};
+
+#undef FIELD_TIMESTAMP
+#undef FIELD_INTEGER
+#undef FIELD_FIXED
+
+static const Field *Fields(uint32_t type, size_t &count)
+{
+#define FIELDS(a) (count = sizeof(a) / sizeof(a[0]), a)
+    switch (type)
+    {
+    case RECORD_GAZE_POINT:
+        return FIELDS(GAZE_POINT_FIELDS);
+    case RECORD_GAZE_ORIGIN:
+        return FIELDS(GAZE_ORIGIN_FIELDS);
+    case RECORD_HEAD_POSE:
+        return FIELDS(HEAD_POSE_FIELDS);
+    case RECORD_PRESENCE:
+        return FIELDS(PRESENCE_FIELDS);
+    case RECORD_GAZE_FOCUS:
+        return FIELDS(GAZE_FOCUS_FIELDS);
+    default:
+        count = 0;
+        return nullptr;
+    }
+#undef FIELDS
+}
+
+static inline uint64_t ZigZag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static inline int64_t UnZigZag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static inline void PutVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static inline void PutSigned(std::vector<uint8_t> &out, int64_t value)
+{
+    PutVarint(out, ZigZag(value));
+}
+
+/**
+ * Bounds checked varint reader over one block.
+ * */
+struct Reader
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    bool ok;
+
+    inline uint64_t Varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (p == end)
+            {
+                ok = false;
+                return 0;
+            }
+
+            uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+
+        ok = false;
+        return 0;
+    }
+
+    inline int64_t Signed()
+    {
+        return UnZigZag(Varint());
+    }
+};
+
+static inline int64_t LoadInteger(const char *p, uint32_t size)
+{
+    switch (size)
+    {
+    case 1:
+        return *reinterpret_cast<const int8_t *>(p);
+    case 4:
+    {
+        int32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+    default:
+    {
+        int64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+    }
+}
+
+static inline void StoreInteger(char *p, uint32_t size, int64_t value)
+{
+    switch (size)
+    {
+    case 1:
+        *reinterpret_cast<int8_t *>(p) = static_cast<int8_t>(value);
+        break;
+    case 4:
+    {
+        int32_t v = static_cast<int32_t>(value);
+        std::memcpy(p, &v, 4);
+        break;
+    }
+    default:
+        std::memcpy(p, &value, 8);
+        break;
+    }
+}
+
+static inline int64_t Quantize(float value, float scale)
+{
+    if (!std::isfinite(value))
+        return 0;
+
+    double q = std::nearbyint(static_cast<double>(value) * scale);
+    if (q > INT32_MAX)
+        return INT32_MAX;
+    if (q < INT32_MIN)
+        return INT32_MIN;
+    return static_cast<int64_t>(q);
+}
+
+bool EncodeBlock(uint32_t type, const char *records, uint32_t count, std::vector<uint8_t> &out)
+{
+    size_t fields;
+    const Field *field = Fields(type, fields);
+    if (!field)
+        return false;
+
+    const uint32_t stride = RecordSize(type);
+
+    for (size_t f = 0; f < fields; f++, field++)
+    {
+        const char *p = records + field->offset;
+
+        switch (field->kind)
+        {
+        case FieldKind::Timestamp:
+        {
+            int64_t previous = 0;
+            int64_t delta = 0;
+            for (uint32_t i = 0; i < count; i++, p += stride)
+            {
+                int64_t value = LoadInteger(p, 8);
+                int64_t next = value - previous;
+
+                // The first value and delta are stored as is, the rest as delta-of-delta.
+                PutSigned(out, i < 2 ? next : next - delta);
+                delta = next;
+                previous = value;
+            }
+            break;
+        }
+        case FieldKind::Integer:
+        {
+            uint32_t i = 0;
+            while (i < count)
+            {
+                int64_t value = LoadInteger(p, field->size);
+                uint32_t run = 1;
+                while (i + run < count && LoadInteger(p + run * stride, field->size) == value)
+                    run++;
+
+                PutSigned(out, value);
+                PutVarint(out, run);
+                i += run;
+                p += run * stride;
+            }
+            break;
+        }
+        case FieldKind::Fixed:
+        {
+            int64_t previous = 0;
+            for (uint32_t i = 0; i < count; i++, p += stride)
+            {
+                float value;
+                std::memcpy(&value, p, 4);
+                int64_t q = Quantize(value, field->scale);
+
+                PutSigned(out, q - previous);
+                previous = q;
+            }
+            break;
+        }
+        }
+    }
+
+    return true;
+}
+
+bool DecodeBlock(uint32_t type, const uint8_t *data, size_t bytes, uint32_t count, char *records)
+{
+    size_t fields;
+    const Field *field = Fields(type, fields);
+    if (!field)
+        return false;
+
+    const uint32_t stride = RecordSize(type);
+    std::memset(records, 0, static_cast<size_t>(stride) * count);
+
+    Reader in = {data, data + bytes, true};
+
+    for (size_t f = 0; f < fields && in.ok; f++, field++)
+    {
+        char *p = records + field->offset;
+
+        switch (field->kind)
+        {
+        case FieldKind::Timestamp:
+        {
+            int64_t value = 0;
+            int64_t delta = 0;
+            for (uint32_t i = 0; i < count; i++, p += stride)
+            {
+                int64_t stored = in.Signed();
+                delta = i < 2 ? stored : delta + stored;
+                value += delta;
+                std::memcpy(p, &value, 8);
+            }
+            break;
+        }
+        case FieldKind::Integer:
+        {
+            uint32_t i = 0;
+            while (i < count && in.ok)
+            {
+                int64_t value = in.Signed();
+                uint64_t run = in.Varint();
+                if (run == 0 || run > count - i)
+                    return false;
+
+                for (uint64_t r = 0; r < run; r++, p += stride)
+                    StoreInteger(p, field->size, value);
+                i += static_cast<uint32_t>(run);
+            }
+            break;
+        }
+        case FieldKind::Fixed:
+        {
+            int64_t q = 0;
+            for (uint32_t i = 0; i < count; i++, p += stride)
+            {
+                q += in.Signed();
+                float value = static_cast<float>(q / static_cast<double>(field->scale));
+                std::memcpy(p, &value, 4);
+            }
+            break;
+        }
+        }
+    }
+
+    return in.ok && in.p == in.end;
+}
@@ -0,0 +1,36 @@
+/**
+ * Columnar block codec for compressed recordings.
+ *
+ * A block of fixed size records of one stream is stored column by
+ * column, each field with the encoding that suits it:
+ *
+ *   timestamps   delta-of-delta, zigzag varint
+ *   enums, ids   run-length, (value, run) zigzag varint pairs
+ *   floats       fixed-point with a per-field scale, zigzag varint deltas
+ *
+ * Blocks are self-contained so any one of them can be decoded on its
+ * own. Floats are quantized, e.g. gaze points to a tenth of a pixel,
+ * and non-finite values are stored as 0. Padding is not stored and
+ * decodes as zeros.
+ */
+
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Append the encoded records to out.
+ * Returns false for a type without a codec.
+ * */
+bool EncodeBlock(uint32_t type, const char *records, uint32_t count, std::vector<uint8_t> &out);
+
+/**
+ * Decode count records into records, which must hold count records
+ * of RecordSize(type). Returns false on a corrupt or truncated block.
+ * */
+bool DecodeBlock(uint32_t type, const uint8_t *data, size_t bytes, uint32_t count, char *records);
+
+#endif // CODEC_H
@@ -0,0 +1,91 @@
+#include "counters.h"
+
+// Errors count up from Error_Unknown, warnings from one past Ok.
+static const int ERRORS = IL_Result_Error_MAX - IL_Result_Error_Unknown;
+static const int WARNINGS = IL_Result_Warning_MAX - IL_Result_Ok - 1;
+
+static_assert(ERRORS + WARNINGS == COUNTER_RESULT_OTHER - COUNTER_RESULT_FIRST, "one counter per IL::Result");
+
+static const char *NAMES[COUNTERS] = {
+    "received.gazeFocus",
+    "received.gazePoint",
+    "received.gazeOrigin",
+    "received.headPose",
+    "received.presence",
+    "filtered.invalid",
+    "queued.gazeFocus",
+    "queued.gazePoint",
+    "queued.blink",
+    "dropped.gazeFocus",
+    "dropped.gazePoint",
+    "dropped.blink",
+    "depth.gazeFocus",
+    "depth.gazePoint",
+    "depth.blink",
+    "delivered.gazeFocus",
+    "delivered.gazePoint",
+    "delivered.blink",
+    "server.clients",
+    "server.sent",
+    "server.dropped",
+    "server.overflow",
+    "recording.dropped",
+    "flight.overwritten",
+    "flight.dropped",
+    "broadcast.written",
+    "broadcast.overwritten",
+    "updates",
+    "updates.errors",
+    "result.Error_Unknown",
+    "result.Error_StreamTypeNotAvailable",
+    "result.Error_NotInTransaction",
+    "result.Error_UnknownInteractorId",
+    "result.Error_UnknownWeightDistributionId",
+    "result.Error_CustomWeightDistributionInUse",
+    "result.Error_InvalidParamValue",
+    "result.Error_NoAdapterSet",
+    "result.Error_AllocationFailed",
+    "result.Warning_NotInTransaction",
+    "result.Warning_AlreadyInTransaction",
+    "result.Warning_UnknownInteractorId",
+    "result.Warning_UnknownWeightDistributionId",
+    "result.Warning_InsufficientInformationForCoordinateTransform",
+    "result.Warning_NoAdapterSet",
+    "result.Warning_NoDeviceAvailable",
+    "result.Warning_Timeout",
+    "result.other"};
+
+PipelineCounters::PipelineCounters()
+{
+    for (std::atomic<uint64_t> &value : PipelineCounters::values)
+        value = 0;
+}
+
+void PipelineCounters::Update(IL::Result result)
+{
+    Add(COUNTER_UPDATES);
+
+    int r = static_cast<int>(result);
+    if (r == IL_Result_Ok)
+        return;
+
+    Add(COUNTER_UPDATE_ERRORS);
+
+    if (r >= IL_Result_Error_Unknown && r < IL_Result_Error_MAX)
+        Add(static_cast<PipelineCounter>(COUNTER_RESULT_FIRST + r - IL_Result_Error_Unknown));
+    else if (r > IL_Result_Ok && r < IL_Result_Warning_MAX)
+        Add(static_cast<PipelineCounter>(COUNTER_RESULT_FIRST + ERRORS + r - IL_Result_Ok - 1));
+    else
+        Add(COUNTER_RESULT_OTHER);
+}
+
+void PipelineCounters::Read(uint64_t values[COUNTERS]) const
+{
+    for (int i = 0; i < COUNTERS; i++)
+        values[i] = PipelineCounters::values[i].load(std::memory_order_relaxed);
+}
+
+const char *PipelineCounters::Name(int counter)
+{
+    return counter >= 0 && counter < COUNTERS ? NAMES[counter] : "";
+}
@@ -0,0 +1,102 @@
+/**
+ * Throughput and drop counters of the tracker pipeline.
+ *
+ * Counters are plain relaxed atomics, bumped where things happen on the
+ * tracker and JS threads and read together as one flat array for
+ * monitoring. Queue depths are gauges, filled in when read.
+ */
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <interaction_lib/InteractionLib.h>
+
+enum PipelineCounter
+{
+    // Records delivered by the IL, per stream.
+    COUNTER_RECEIVED_GAZE_FOCUS,
+    COUNTER_RECEIVED_GAZE_POINT,
+    COUNTER_RECEIVED_GAZE_ORIGIN,
+    COUNTER_RECEIVED_HEAD_POSE,
+    COUNTER_RECEIVED_PRESENCE,
+
+    // Gaze points not delivered to JS because they were invalid.
+    COUNTER_FILTERED_INVALID,
+
+    // Events queued for JS, and dropped because the queue was full.
+    COUNTER_QUEUED_GAZE_FOCUS,
+    COUNTER_QUEUED_GAZE_POINT,
+    COUNTER_QUEUED_BLINK,
+    COUNTER_DROPPED_GAZE_FOCUS,
+    COUNTER_DROPPED_GAZE_POINT,
+    COUNTER_DROPPED_BLINK,
+
+    // Events waiting in the queues when read.
+    COUNTER_DEPTH_GAZE_FOCUS,
+    COUNTER_DEPTH_GAZE_POINT,
+    COUNTER_DEPTH_BLINK,
+
+    // JS callbacks called.
+    COUNTER_DELIVERED_GAZE_FOCUS,
+    COUNTER_DELIVERED_GAZE_POINT,
+    COUNTER_DELIVERED_BLINK,
+
+    // Gaze server clients connected, frames sent to them, frames dropped
+    // for clients that read too slowly, and frames the server thread
+    // fell too far behind to take.
+    COUNTER_SERVER_CLIENTS,
+    COUNTER_SERVER_SENT,
+    COUNTER_SERVER_DROPPED,
+    COUNTER_SERVER_OVERFLOW,
+
+    // Records the recording had no free block for, records the flight
+    // recorder overwrote while they were still inside its window, and
+    // records that came after a dump's trigger and didn't fit.
+    COUNTER_RECORDING_DROPPED,
+    COUNTER_FLIGHT_OVERWRITTEN,
+    COUNTER_FLIGHT_DROPPED,
+
+    // Records broadcast, and records whose slot was reused before every
+    // reader may have read them. Each reader counts what it lost itself.
+    COUNTER_BROADCAST_WRITTEN,
+    COUNTER_BROADCAST_OVERWRITTEN,
+
+    // WaitAndUpdate calls, and those that did not return Ok, by result.
+    COUNTER_UPDATES,
+    COUNTER_UPDATE_ERRORS,
+    COUNTER_RESULT_FIRST,
+    COUNTER_RESULT_OTHER = COUNTER_RESULT_FIRST + 17,
+
+    COUNTERS
+};
+
+class PipelineCounters
+{
+public:
+    PipelineCounters();
+
+    void Add(PipelineCounter counter, uint64_t n = 1)
+    {
+        PipelineCounters::values[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void Set(PipelineCounter counter, uint64_t value)
+    {
+        PipelineCounters::values[counter].store(value, std::memory_order_relaxed);
+    }
+
+    // Count a WaitAndUpdate call and its result.
+    void Update(IL::Result result);
+
+    void Read(uint64_t values[COUNTERS]) const;
+
+    // Dotted name of each counter, e.g. "dropped.gazePoint".
+    static const char *Name(int counter);
+
+private:
+    std::atomic<uint64_t> values[COUNTERS];
+};
+
+#endif // COUNTERS_H
@@ -0,0 +1,640 @@
+#include "engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+InteractionEngine::InteractionEngine(IL::FieldOfUse fieldOfUse, IL_Logger *logger)
+{
+    InteractionEngine::fieldOfUse = fieldOfUse;
+    InteractionEngine::logger = logger ? *logger : IL_Logger{nullptr, IL_LoggingLevel_Error, nullptr};
+
+    InteractionEngine::adapter = {};
+    InteractionEngine::adapterContext = nullptr;
+    InteractionEngine::hasAdapter = false;
+    InteractionEngine::started = false;
+
+    InteractionEngine::cleared = false;
+    InteractionEngine::inTransaction = false;
+    InteractionEngine::hasFocus = false;
+    InteractionEngine::focused = IL::EmptyInteractorId();
+
+    InteractionEngine::focusSubscription = {nullptr, nullptr};
+    InteractionEngine::gazePointSubscription = {nullptr, nullptr};
+    InteractionEngine::gazeOriginSubscription = {nullptr, nullptr};
+    InteractionEngine::presenceSubscription = {nullptr, nullptr};
+    InteractionEngine::headPoseSubscription = {nullptr, nullptr};
+    InteractionEngine::capabilitiesSubscription = {nullptr, nullptr};
+}
+
+InteractionEngine::~InteractionEngine()
+{
+    ReleaseAdapter();
+}
+
+void InteractionEngine::Log(IL_LoggingLevel level, const char *text)
+{
+    if (InteractionEngine::logger.callback && level <= InteractionEngine::logger.level)
+        InteractionEngine::logger.callback(level, text, InteractionEngine::logger.context);
+}
+
+void InteractionEngine::ReleaseAdapter()
+{
+    if (!InteractionEngine::hasAdapter)
+        return;
+
+    if (InteractionEngine::started)
+        InteractionEngine::adapter.stopAdapter(InteractionEngine::adapterContext);
+
+    InteractionEngine::adapter.destroyAdapter(InteractionEngine::adapter.createDestroyContext, &adapterContext);
+
+    InteractionEngine::hasAdapter = false;
+    InteractionEngine::started = false;
+    InteractionEngine::provided.clear();
+}
+
+/**
+ * Create the adapter and route its streams into the engine.
+ * Passing nullptr removes the current adapter.
+ * */
+IL::Result InteractionEngine::SetAdapter(IL_AdapterFunctions *adapterFunctions)
+{
+    ReleaseAdapter();
+
+    if (!adapterFunctions)
+        return IL::Result::Ok;
+
+    InteractionEngine::adapter = *adapterFunctions;
+    InteractionEngine::adapterContext = nullptr;
+
+    IL_AdapterFunctions &a = InteractionEngine::adapter;
+    if (!a.createAdapter(a.createDestroyContext, &adapterContext))
+        return IL::Result::Error_Unknown;
+
+    InteractionEngine::hasAdapter = true;
+
+    a.registerPostGazePointDataCallback(InteractionEngine::adapterContext, InteractionEngine::OnGazePoint, this);
+    a.registerPostGazeOriginDataCallback(InteractionEngine::adapterContext, InteractionEngine::OnGazeOrigin, this);
+    a.registerPostPresenceDataCallback(InteractionEngine::adapterContext, InteractionEngine::OnPresence, this);
+    a.registerPostHeadPoseDataCallback(InteractionEngine::adapterContext, InteractionEngine::OnHeadPose, this);
+    a.getStreamTypesProvided(InteractionEngine::adapterContext, InteractionEngine::OnStreamTypesProvided, this);
+
+    Log(IL_LoggingLevel_Info, "Adapter set");
+    return IL::Result::Ok;
+}
+
+/**
+ * Adapters post gaze in display units already, see adapter.h,
+ * so there is nothing to transform.
+ * */
+IL::Result InteractionEngine::CoordinateTransformAddOrUpdateDisplayArea(float widthUserUnits, float heightUserUnits,
+                                                                        float widthVirtualUnits, float heightVirtualUnits,
+                                                                        float xOriginVirtualUnits, float yOriginVirtualUnits,
+                                                                        const char *virtualDisplayAreaId)
+{
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::CoordinateTransformSetOriginOffset(float xOriginOffsetVirtualUnits, float yOriginOffsetVirtualUnits)
+{
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::CoordinateTransformSetDisplayDensity(float xUnitsPerMm, float yUnitsPerMm)
+{
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::BeginInteractorUpdates()
+{
+    if (InteractionEngine::inTransaction)
+        return IL::Result::Warning_AlreadyInTransaction;
+
+    InteractionEngine::inTransaction = true;
+    InteractionEngine::cleared = false;
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::CommitInteractorUpdates()
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Warning_NotInTransaction;
+
+    InteractionEngine::inTransaction = false;
+    ApplyStaged();
+    return IL::Result::Ok;
+}
+
+/**
+ * Apply the changes of the transaction. Updates are written in place,
+ * removals compact the interactors once for the whole transaction and
+ * additions are appended, so a commit costs the changes it holds, plus
+ * one pass over the interactors if any were removed.
+ * */
+void InteractionEngine::ApplyStaged()
+{
+    std::vector<Interactor> &interactors = InteractionEngine::interactors;
+    std::unordered_map<IL::InteractorId, size_t> &index = InteractionEngine::index;
+
+    if (InteractionEngine::cleared)
+    {
+        interactors.clear();
+        index.clear();
+    }
+
+    std::vector<bool> removed;
+    std::vector<Interactor> added;
+
+    for (size_t i = 0; i < InteractionEngine::staged.size(); i++)
+    {
+        const Change &change = InteractionEngine::staged[i];
+        auto committed = index.find(change.interactor.id);
+
+        if (change.type == CHANGE_UPDATE)
+        {
+            interactors[committed->second] = change.interactor;
+            continue;
+        }
+
+        // Added interactors were either new or removed before in this transaction.
+        if (committed != index.end())
+        {
+            removed.resize(interactors.size());
+            removed[committed->second] = true;
+            index.erase(committed);
+        }
+
+        // Unless it was removed again later on.
+        if (change.type == CHANGE_ADD && InteractionEngine::stagedIndex[change.interactor.id] == i)
+            added.push_back(change.interactor);
+    }
+
+    if (!removed.empty())
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < interactors.size(); i++)
+        {
+            if (!removed[i])
+                interactors[kept++] = interactors[i];
+        }
+        interactors.resize(kept);
+
+        for (size_t i = 0; i < interactors.size(); i++)
+            index[interactors[i].id] = i;
+    }
+
+    for (const Interactor &interactor : added)
+    {
+        index[interactor.id] = interactors.size();
+        interactors.push_back(interactor);
+    }
+
+    InteractionEngine::staged.clear();
+    InteractionEngine::stagedIndex.clear();
+    InteractionEngine::cleared = false;
+}
+
+/**
+ * The interactor as the transaction left it, nullptr if there is none.
+ * A committed interactor is staged as an update the first time.
+ * */
+Interactor *InteractionEngine::Find(IL::InteractorId id)
+{
+    auto staged = InteractionEngine::stagedIndex.find(id);
+    if (staged != InteractionEngine::stagedIndex.end())
+    {
+        Change &change = InteractionEngine::staged[staged->second];
+        return change.type == CHANGE_REMOVE ? nullptr : &change.interactor;
+    }
+
+    if (InteractionEngine::cleared)
+        return nullptr;
+
+    auto committed = InteractionEngine::index.find(id);
+    if (committed == InteractionEngine::index.end())
+        return nullptr;
+
+    Stage(CHANGE_UPDATE, InteractionEngine::interactors[committed->second]);
+    return &InteractionEngine::staged.back().interactor;
+}
+
+void InteractionEngine::Stage(ChangeType type, const Interactor &interactor)
+{
+    InteractionEngine::stagedIndex[interactor.id] = InteractionEngine::staged.size();
+    InteractionEngine::staged.push_back({type, interactor});
+}
+
+IL::Result InteractionEngine::AddOrUpdateInteractor(IL::InteractorId id, IL::Rectangle bounds, float z)
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    Interactor *interactor = Find(id);
+    if (interactor)
+    {
+        interactor->bounds = bounds;
+        interactor->z = z;
+    }
+    else
+    {
+        Stage(CHANGE_ADD, {id, bounds, z});
+    }
+
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::UpdateInteractorBounds(IL::InteractorId id, IL::Rectangle bounds)
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    Interactor *interactor = Find(id);
+    if (!interactor)
+        return IL::Result::Error_UnknownInteractorId;
+
+    interactor->bounds = bounds;
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::UpdateInteractorZ(IL::InteractorId id, float z)
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    Interactor *interactor = Find(id);
+    if (!interactor)
+        return IL::Result::Error_UnknownInteractorId;
+
+    interactor->z = z;
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::RemoveInteractor(IL::InteractorId id)
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    Interactor *interactor = Find(id);
+    if (!interactor)
+        return IL::Result::Warning_UnknownInteractorId;
+
+    // A change staged before stays, commit applies it and then the removal.
+    Stage(CHANGE_REMOVE, *interactor);
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::ClearInteractors()
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    InteractionEngine::staged.clear();
+    InteractionEngine::stagedIndex.clear();
+    InteractionEngine::cleared = true;
+    return IL::Result::Ok;
+}
+
+// Weight distributions only shape focus within the real IL's gaze model,
+// plain rectangles are all the stand-in does.
+
+IL::Result InteractionEngine::UpdateInteractorStandardWeightDistributionTypes(IL::InteractorId id, IL::WeightDistributionType weightDistributionTypes)
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    return Find(id) ? IL::Result::Ok : IL::Result::Error_UnknownInteractorId;
+}
+
+IL::Result InteractionEngine::AddOrUpdateCustomWeightDistributionBitmap(IL::WeightDistributionId weightDistributionId, bool isWeightDistribution, bool isStencilMap, int bitmapColumns, int bitmapRows, const unsigned char *bitmap)
+{
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::RemoveCustomWeightDistributionBitmap(IL::WeightDistributionId weightDistributionId)
+{
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::AddOrUpdateBindingToCustomWeightDistribution(IL::InteractorId id, IL::WeightDistributionId weightDistributionId)
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    return Find(id) ? IL::Result::Ok : IL::Result::Error_UnknownInteractorId;
+}
+
+IL::Result InteractionEngine::RemoveBindingToCustomWeightDistribution(IL::InteractorId id, IL::WeightDistributionId weightDistributionId)
+{
+    if (!InteractionEngine::inTransaction)
+        return IL::Result::Error_NotInTransaction;
+
+    return Find(id) ? IL::Result::Ok : IL::Result::Error_UnknownInteractorId;
+}
+
+IL::Result InteractionEngine::SubscribeGazeFocusEvents(IL::GazeFocusEventCallback callback, void *context)
+{
+    InteractionEngine::focusSubscription = {callback, context};
+    return IL::Result::Ok;
+}
+
+void InteractionEngine::UnsubscribeGazeFocusEvents()
+{
+    InteractionEngine::focusSubscription = {nullptr, nullptr};
+}
+
+IL::Result InteractionEngine::SubscribeGazePointData(IL::GazePointDataCallback callback, void *context)
+{
+    InteractionEngine::gazePointSubscription = {callback, context};
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::SubscribeGazeOriginData(IL::GazeOriginDataCallback callback, void *context)
+{
+    InteractionEngine::gazeOriginSubscription = {callback, context};
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::SubscribePresenceData(IL::PresenceDataCallback callback, void *context)
+{
+    InteractionEngine::presenceSubscription = {callback, context};
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::SubscribeHeadPoseData(IL::HeadPoseDataCallback callback, void *context)
+{
+    InteractionEngine::headPoseSubscription = {callback, context};
+    return IL::Result::Ok;
+}
+
+void InteractionEngine::UnsubscribeGazePointData()
+{
+    InteractionEngine::gazePointSubscription = {nullptr, nullptr};
+}
+
+void InteractionEngine::UnsubscribeGazeOriginData()
+{
+    InteractionEngine::gazeOriginSubscription = {nullptr, nullptr};
+}
+
+void InteractionEngine::UnsubscribePresenceData()
+{
+    InteractionEngine::presenceSubscription = {nullptr, nullptr};
+}
+
+void InteractionEngine::UnsubscribeHeadPoseData()
+{
+    InteractionEngine::headPoseSubscription = {nullptr, nullptr};
+}
+
+/**
+ * Enabled if subscribed, available if the adapter provides it.
+ * */
+void InteractionEngine::GetDataStreamCapability(IL::StreamType streamType, IL::Capability *capability)
+{
+    bool subscribed = false;
+    switch (streamType)
+    {
+    case IL::StreamType::GazePointData:
+        subscribed = InteractionEngine::gazePointSubscription.callback != nullptr;
+        break;
+    case IL::StreamType::GazeOriginData:
+        subscribed = InteractionEngine::gazeOriginSubscription.callback != nullptr;
+        break;
+    case IL::StreamType::PresenceData:
+        subscribed = InteractionEngine::presenceSubscription.callback != nullptr;
+        break;
+    case IL::StreamType::HeadPoseData:
+        subscribed = InteractionEngine::headPoseSubscription.callback != nullptr;
+        break;
+    default:
+        break;
+    }
+
+    // IL_StreamType and IL_StreamInputType share their values.
+    bool available = false;
+    for (IL_StreamInputType type : InteractionEngine::provided)
+    {
+        if (static_cast<int>(type) == static_cast<int>(streamType))
+            available = true;
+    }
+
+    if (!available)
+        *capability = InteractionEngine::hasAdapter ? IL::Capability::Unavailable : IL::Capability::Unknown;
+    else
+        *capability = subscribed ? IL::Capability::Enabled : IL::Capability::Available;
+}
+
+void InteractionEngine::SubscribeDataStreamCapabilitiesChanged(IL::DataStreamCapabilitiesChangedCallback callback, void *context)
+{
+    InteractionEngine::capabilitiesSubscription = {callback, context};
+}
+
+void InteractionEngine::UnsubscribeDataStreamCapabilitiesChanged()
+{
+    InteractionEngine::capabilitiesSubscription = {nullptr, nullptr};
+}
+
+/**
+ * Same contract as the real IL, except that without an adapter the
+ * calling thread sleeps for the connection interval instead of
+ * returning right away, so update loops don't spin.
+ * */
+IL::Result InteractionEngine::WaitAndUpdate(unsigned long connectionIntervalMs)
+{
+    IL::Result result = InteractionEngine::hasAdapter ? WaitForDeviceConnection() : IL::Result::Warning_NoAdapterSet;
+
+    if (result != IL::Result::Ok)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(connectionIntervalMs));
+        return result;
+    }
+
+    result = WaitForDeviceDataAvailable();
+    if (result != IL::Result::Ok)
+        return result;
+
+    return Update();
+}
+
+IL::Result InteractionEngine::WaitForDeviceConnection()
+{
+    if (!InteractionEngine::hasAdapter)
+        return IL::Result::Warning_NoAdapterSet;
+
+    if (!InteractionEngine::adapter.waitForDeviceConnection(InteractionEngine::adapterContext))
+        return IL::Result::Warning_NoDeviceAvailable;
+
+    if (!InteractionEngine::started)
+    {
+        InteractionEngine::started = true;
+        InteractionEngine::adapter.startAdapter(InteractionEngine::adapterContext, static_cast<IL_FieldOfUse>(InteractionEngine::fieldOfUse));
+    }
+
+    return IL::Result::Ok;
+}
+
+IL::Result InteractionEngine::Update()
+{
+    IL::Result result = UpdateStreamingDataOutput();
+    if (result != IL::Result::Ok)
+        return result;
+
+    return UpdateInteraction();
+}
+
+IL::Result InteractionEngine::WaitForDeviceDataAvailable()
+{
+    if (!InteractionEngine::hasAdapter)
+        return IL::Result::Warning_NoAdapterSet;
+
+    if (!InteractionEngine::adapter.waitForStreamingDataAvailable(InteractionEngine::adapterContext))
+        return IL::Result::Warning_Timeout;
+
+    return IL::Result::Ok;
+}
+
+/**
+ * Let the adapter post its data. Stream callbacks run right away,
+ * gaze points are also kept for the interaction update.
+ * */
+IL::Result InteractionEngine::UpdateStreamingDataOutput()
+{
+    if (!InteractionEngine::hasAdapter)
+        return IL::Result::Error_NoAdapterSet;
+
+    if (!InteractionEngine::started)
+        return IL::Result::Warning_NoDeviceAvailable;
+
+    InteractionEngine::adapter.updateAdapter(InteractionEngine::adapterContext);
+    return IL::Result::Ok;
+}
+
+/**
+ * Move the focus to the top interactor under each new gaze point,
+ * reporting the loss before the gain.
+ * */
+IL::Result InteractionEngine::UpdateInteraction()
+{
+    if (!InteractionEngine::hasAdapter)
+        return IL::Result::Error_NoAdapterSet;
+
+    Subscription<IL::GazeFocusEventCallback> &subscription = InteractionEngine::focusSubscription;
+
+    for (const IL::GazePointData &point : InteractionEngine::gaze)
+    {
+        const Interactor *hit = HitTest(InteractionEngine::interactors, point.x, point.y);
+
+        bool hasFocus = hit != nullptr;
+        IL::InteractorId id = hasFocus ? hit->id : IL::EmptyInteractorId();
+
+        if (hasFocus == InteractionEngine::hasFocus && id == InteractionEngine::focused)
+            continue;
+
+        if (InteractionEngine::hasFocus && subscription.callback)
+            subscription.callback({point.timestamp_us, InteractionEngine::focused, false}, subscription.context);
+
+        if (hasFocus && subscription.callback)
+            subscription.callback({point.timestamp_us, id, true}, subscription.context);
+
+        InteractionEngine::hasFocus = hasFocus;
+        InteractionEngine::focused = id;
+    }
+
+    InteractionEngine::gaze.clear();
+    return IL::Result::Ok;
+}
+
+void InteractionEngine::OnGazePoint(const IL_GazePointData *data, void *context)
+{
+    InteractionEngine *e = static_cast<InteractionEngine *>(context);
+
+    if (data->validity == IL_Validity_Valid)
+        e->gaze.push_back(*data);
+
+    if (e->gazePointSubscription.callback)
+        e->gazePointSubscription.callback(*data, e->gazePointSubscription.context);
+}
+
+void InteractionEngine::OnGazeOrigin(const IL_GazeOriginData *data, void *context)
+{
+    InteractionEngine *e = static_cast<InteractionEngine *>(context);
+
+    if (e->gazeOriginSubscription.callback)
+        e->gazeOriginSubscription.callback(*data, e->gazeOriginSubscription.context);
+}
+
+void InteractionEngine::OnPresence(const IL_PresenceData *data, void *context)
+{
+    InteractionEngine *e = static_cast<InteractionEngine *>(context);
+
+    if (e->presenceSubscription.callback)
+        e->presenceSubscription.callback(*data, e->presenceSubscription.context);
+}
+
+void InteractionEngine::OnHeadPose(const IL_HeadPoseData *data, void *context)
+{
+    InteractionEngine *e = static_cast<InteractionEngine *>(context);
+
+    if (e->headPoseSubscription.callback)
+        e->headPoseSubscription.callback(*data, e->headPoseSubscription.context);
+}
+
+void InteractionEngine::OnStreamTypesProvided(const IL_StreamInputType *types, unsigned count, void *context)
+{
+    InteractionEngine *e = static_cast<InteractionEngine *>(context);
+
+    e->provided.assign(types, types + count);
+}
+
+// The factory functions and operators the Tobii DLL would export.
+
+namespace IL
+{
+    InteractionLib *CreateInteractionLib(FieldOfUse fieldOfUse)
+    {
+        return CreateInteractionLib(fieldOfUse, nullptr, nullptr);
+    }
+
+    InteractionLib *CreateInteractionLib(FieldOfUse fieldOfUse, IL_Logger *logger)
+    {
+        return CreateInteractionLib(fieldOfUse, logger, nullptr);
+    }
+
+    InteractionLib *CreateInteractionLib(FieldOfUse fieldOfUse, IL_Logger *logger, IL_AdapterFunctions *adapterFunctions)
+    {
+        InteractionEngine *engine = new InteractionEngine(fieldOfUse, logger);
+
+        if (adapterFunctions)
+            engine->SetAdapter(adapterFunctions);
+
+        return engine;
+    }
+
+    void DestroyInteractionLib(InteractionLib *instance)
+    {
+        delete static_cast<InteractionEngine *>(instance);
+    }
+}
+
+bool operator==(const IL_Validity &lhs, const IL::Validity &rhs) { return static_cast<int>(lhs) == static_cast<int>(rhs); }
+bool operator==(const IL::Validity &lhs, const IL_Validity &rhs) { return rhs == lhs; }
+
+bool operator==(const IL_Presence &lhs, const IL::Presence &rhs) { return static_cast<int>(lhs) == static_cast<int>(rhs); }
+bool operator==(const IL::Presence &lhs, const IL_Presence &rhs) { return rhs == lhs; }
+
+bool operator==(const IL_FieldOfUse &lhs, const IL::FieldOfUse &rhs) { return static_cast<int>(lhs) == static_cast<int>(rhs); }
+bool operator==(const IL::FieldOfUse &lhs, const IL_FieldOfUse &rhs) { return rhs == lhs; }
+
+bool operator==(const IL_LoggingLevel &lhs, const IL::LoggingLevel &rhs) { return static_cast<int>(lhs) == static_cast<int>(rhs); }
+bool operator==(const IL::LoggingLevel &lhs, const IL_LoggingLevel &rhs) { return rhs == lhs; }
+bool operator<(const IL_LoggingLevel &lhs, const IL::LoggingLevel &rhs) { return static_cast<int>(lhs) < static_cast<int>(rhs); }
+bool operator<(const IL::LoggingLevel &lhs, const IL_LoggingLevel &rhs) { return static_cast<int>(lhs) < static_cast<int>(rhs); }
+
+bool operator==(const IL_StreamType &lhs, const IL::StreamType &rhs) { return static_cast<int>(lhs) == static_cast<int>(rhs); }
+bool operator==(const IL::StreamType &lhs, const IL_StreamType &rhs) { return rhs == lhs; }
+
+bool operator==(const IL_StreamInputType &lhs, const IL::StreamInputType &rhs) { return static_cast<int>(lhs) == static_cast<int>(rhs); }
+bool operator==(const IL::StreamInputType &lhs, const IL_StreamInputType &rhs) { return rhs == lhs; }
+
+bool operator==(const IL_Capability &lhs, const IL::Capability &rhs) { return static_cast<int>(lhs) == static_cast<int>(rhs); }
+bool operator==(const IL::Capability &lhs, const IL_Capability &rhs) { return rhs == lhs; }
@@ -0,0 +1,146 @@
+/**
+ * Stand-in for the Tobii interaction library on platforms without it.
+ *
+ * Implements the IL::InteractionLib interface in plain C++: interactor
+ * transactions, rectangle based gaze focus with z-order, and the gaze
+ * point, gaze origin, presence and head pose streams. Data comes from
+ * an IL_AdapterFunctions source, such as the replay adapter, since
+ * there is no default device adapter.
+ *
+ * Focus goes to the top interactor under the latest valid gaze point.
+ * Invalid samples, e.g. blinks, leave the focus where it is.
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+
+#include "hittest.h"
+
+class InteractionEngine final : public IL::InteractionLib
+{
+public:
+    InteractionEngine(IL::FieldOfUse fieldOfUse, IL_Logger *logger);
+    ~InteractionEngine();
+
+    IL::Result SetAdapter(IL_AdapterFunctions *adapterFunctions) override;
+
+    IL::Result CoordinateTransformAddOrUpdateDisplayArea(float widthUserUnits, float heightUserUnits,
+                                                         float widthVirtualUnits, float heightVirtualUnits,
+                                                         float xOriginVirtualUnits, float yOriginVirtualUnits,
+                                                         const char *virtualDisplayAreaId) override;
+    IL::Result CoordinateTransformSetOriginOffset(float xOriginOffsetVirtualUnits, float yOriginOffsetVirtualUnits) override;
+    IL::Result CoordinateTransformSetDisplayDensity(float xUnitsPerMm, float yUnitsPerMm) override;
+
+    IL::Result BeginInteractorUpdates() override;
+    IL::Result CommitInteractorUpdates() override;
+    IL::Result AddOrUpdateInteractor(IL::InteractorId id, IL::Rectangle bounds, float z) override;
+    IL::Result UpdateInteractorBounds(IL::InteractorId id, IL::Rectangle bounds) override;
+    IL::Result UpdateInteractorZ(IL::InteractorId id, float z) override;
+    IL::Result RemoveInteractor(IL::InteractorId id) override;
+    IL::Result ClearInteractors() override;
+
+    IL::Result UpdateInteractorStandardWeightDistributionTypes(IL::InteractorId id, IL::WeightDistributionType weightDistributionTypes) override;
+    IL::Result AddOrUpdateCustomWeightDistributionBitmap(IL::WeightDistributionId weightDistributionId, bool isWeightDistribution, bool isStencilMap, int bitmapColumns, int bitmapRows, const unsigned char *bitmap) override;
+    IL::Result RemoveCustomWeightDistributionBitmap(IL::WeightDistributionId weightDistributionId) override;
+    IL::Result AddOrUpdateBindingToCustomWeightDistribution(IL::InteractorId id, IL::WeightDistributionId weightDistributionId) override;
+    IL::Result RemoveBindingToCustomWeightDistribution(IL::InteractorId id, IL::WeightDistributionId weightDistributionId) override;
+
+    IL::Result SubscribeGazeFocusEvents(IL::GazeFocusEventCallback callback, void *context) override;
+    void UnsubscribeGazeFocusEvents() override;
+
+    IL::Result SubscribeGazePointData(IL::GazePointDataCallback callback, void *context) override;
+    IL::Result SubscribeGazeOriginData(IL::GazeOriginDataCallback callback, void *context) override;
+    IL::Result SubscribePresenceData(IL::PresenceDataCallback callback, void *context) override;
+    IL::Result SubscribeHeadPoseData(IL::HeadPoseDataCallback callback, void *context) override;
+    void UnsubscribeGazePointData() override;
+    void UnsubscribeGazeOriginData() override;
+    void UnsubscribePresenceData() override;
+    void UnsubscribeHeadPoseData() override;
+
+    void GetDataStreamCapability(IL::StreamType streamType, IL::Capability *capability) override;
+    void SubscribeDataStreamCapabilitiesChanged(IL::DataStreamCapabilitiesChangedCallback callback, void *context) override;
+    void UnsubscribeDataStreamCapabilitiesChanged() override;
+
+    IL::Result WaitAndUpdate(unsigned long connectionIntervalMs) override;
+    IL::Result WaitForDeviceConnection() override;
+    IL::Result Update() override;
+    IL::Result WaitForDeviceDataAvailable() override;
+    IL::Result UpdateStreamingDataOutput() override;
+    IL::Result UpdateInteraction() override;
+
+private:
+    template <typename T>
+    struct Subscription
+    {
+        T callback;
+        void *context;
+    };
+
+    // What a transaction does to one interactor, applied on commit in
+    // the order they were made. An added interactor goes to the end, as
+    // ties in the hit test go to the one added last.
+    enum ChangeType
+    {
+        CHANGE_UPDATE,
+        CHANGE_ADD,
+        CHANGE_REMOVE
+    };
+
+    struct Change
+    {
+        ChangeType type;
+        Interactor interactor;
+    };
+
+    IL::FieldOfUse fieldOfUse;
+    IL_Logger logger;
+
+    // Adapter and its context, if one is set.
+    IL_AdapterFunctions adapter;
+    ILAdapter_AdapterContext adapterContext;
+    bool hasAdapter;
+    bool started;
+    std::vector<IL_StreamInputType> provided;
+
+    // Committed interactors in the order they were added, and where each one is.
+    std::vector<Interactor> interactors;
+    std::unordered_map<IL::InteractorId, size_t> index;
+
+    // Changes of the open transaction, and the latest change of each
+    // interactor. Cleared drops every committed interactor first.
+    std::vector<Change> staged;
+    std::unordered_map<IL::InteractorId, size_t> stagedIndex;
+    bool cleared;
+    bool inTransaction;
+
+    // Valid gaze points waiting for the next interaction update.
+    std::vector<IL::GazePointData> gaze;
+    bool hasFocus;
+    IL::InteractorId focused;
+
+    Subscription<IL::GazeFocusEventCallback> focusSubscription;
+    Subscription<IL::GazePointDataCallback> gazePointSubscription;
+    Subscription<IL::GazeOriginDataCallback> gazeOriginSubscription;
+    Subscription<IL::PresenceDataCallback> presenceSubscription;
+    Subscription<IL::HeadPoseDataCallback> headPoseSubscription;
+    Subscription<IL::DataStreamCapabilitiesChangedCallback> capabilitiesSubscription;
+
+    void Log(IL_LoggingLevel level, const char *text);
+    void ReleaseAdapter();
+    Interactor *Find(IL::InteractorId id);
+    void Stage(ChangeType type, const Interactor &interactor);
+    void ApplyStaged();
+
+    static void OnGazePoint(const IL_GazePointData *data, void *context);
+    static void OnGazeOrigin(const IL_GazeOriginData *data, void *context);
+    static void OnPresence(const IL_PresenceData *data, void *context);
+    static void OnHeadPose(const IL_HeadPoseData *data, void *context);
+    static void OnStreamTypesProvided(const IL_StreamInputType *types, unsigned count, void *context);
+};
+
+#endif // ENGINE_H
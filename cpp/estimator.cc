@@ -0,0 +1,160 @@
+#include "estimator.h"
+
+#include <cmath>
+#include <string>
+
+void Estimator::Init(v8::Local<v8::Object> exports)
+{
+    NODE_SET_METHOD(exports, "EstimateRobustness", Estimator::EstimateRobustness);
+}
+
+/**
+ * Simulate noisy fixations on every interactor of a layout and call
+ * back with how often they activate it, nothing, or another one.
+ *
+ * params
+ * layout     array of { id, x, y, width, height }, optionally z
+ * model      optional { accuracy, precision, biasX, biasY, samples, threshold, trials, seed },
+ *            see NoiseModel and DEFAULT_NOISE_MODEL
+ * callback   function (results), results are
+ *            { id, trials, activations, misses, falseActivations, stolen, missRate, falseActivationRate }
+ *            in the order of the layout
+ *
+ * Throws a RangeError for a model the simulation can't run, before any work is queued.
+ * */
+void Estimator::EstimateRobustness(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    v8::Local<v8::Value> options = args[1];
+    v8::Local<v8::Value> callback = args[2];
+
+    if (args[1]->IsFunction())
+    {
+        options = v8::Undefined(isolate);
+        callback = args[1];
+    }
+
+    std::unique_ptr<Estimate> estimate(new Estimate());
+
+    if (!ReadLayout(isolate, args[0], estimate->layout) || !callback->IsFunction())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "arguments must be a layout of { id, x, y, width, height }, optional options and a callback");
+        return;
+    }
+
+    NoiseModel &model = estimate->model;
+    model = DEFAULT_NOISE_MODEL;
+
+    if (options->IsObject())
+    {
+        v8::Local<v8::Object> o = options.As<v8::Object>();
+        v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+        for (const char *name : {"accuracy", "precision", "biasX", "biasY", "samples", "threshold", "trials", "seed"})
+        {
+            v8::Local<v8::Value> value = o->Get(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked()).ToLocalChecked();
+            if (!value->IsUndefined() && !value->IsNumber())
+            {
+                std::string message = std::string(name) + " must be a number";
+                isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+                return;
+            }
+        }
+
+        double accuracy = Option(isolate, o, "accuracy", model.accuracy);
+        double precision = Option(isolate, o, "precision", model.precision);
+        double biasX = Option(isolate, o, "biasX", model.biasX);
+        double biasY = Option(isolate, o, "biasY", model.biasY);
+        double samples = Option(isolate, o, "samples", model.samples);
+        double threshold = Option(isolate, o, "threshold", model.threshold);
+        double trials = Option(isolate, o, "trials", static_cast<double>(model.trials));
+        double seed = Option(isolate, o, "seed", static_cast<double>(model.seed));
+
+        // Checked here, a bad size would throw on a worker thread and abort the process.
+        const char *invalid = nullptr;
+        if (!std::isfinite(accuracy) || accuracy < 0.0 || !std::isfinite(precision) || precision < 0.0)
+            invalid = "accuracy and precision must be finite and not negative";
+        else if (!std::isfinite(biasX) || !std::isfinite(biasY))
+            invalid = "biasX and biasY must be finite";
+        else if (!(samples >= 1.0 && samples <= MAX_NOISE_SAMPLES))
+            invalid = "samples must be from 1 to 1000";
+        else if (!(threshold > 0.0 && threshold <= 1.0))
+            invalid = "threshold must be above 0 and at most 1";
+        else if (!(trials >= 1.0 && trials <= static_cast<double>(MAX_NOISE_TRIALS)))
+            invalid = "trials must be from 1 to 100000000";
+        else if (!(seed >= 0.0 && seed < 18446744073709551616.0))
+            invalid = "seed must be an integer from 0 to 2^64";
+
+        if (invalid)
+        {
+            isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, invalid).ToLocalChecked()));
+            return;
+        }
+
+        model.accuracy = static_cast<float>(accuracy);
+        model.precision = static_cast<float>(precision);
+        model.biasX = static_cast<float>(biasX);
+        model.biasY = static_cast<float>(biasY);
+        model.samples = static_cast<uint32_t>(samples);
+        model.threshold = static_cast<float>(threshold);
+        model.trials = static_cast<uint64_t>(trials);
+        model.seed = static_cast<uint64_t>(seed);
+    }
+
+    estimate->request.data = estimate.get();
+    estimate->callback.Reset(isolate, callback.As<v8::Function>());
+    estimate->context.Reset(isolate, isolate->GetCurrentContext());
+
+    uv_queue_work(node::GetCurrentEventLoop(isolate), &estimate->request, Estimator::Run, Estimator::Finish);
+    estimate.release();
+}
+
+void Estimator::Run(uv_work_t *request)
+{
+    Estimate *estimate = static_cast<Estimate *>(request->data);
+
+    WorkPool pool;
+    ::EstimateRobustness(estimate->layout, estimate->model, pool, estimate->results);
+}
+
+void Estimator::Finish(uv_work_t *request, int status)
+{
+    std::unique_ptr<Estimate> estimate(static_cast<Estimate *>(request->data));
+    v8::Isolate *isolate = v8::Isolate::GetCurrent();
+
+    v8::HandleScope handle_scope(isolate);
+
+    v8::Local<v8::Context> ctx = estimate->context.Get(isolate);
+    v8::Context::Scope context_scope(ctx);
+
+    auto set = [&](v8::Local<v8::Object> object, const char *name, double value)
+    {
+        object->Set(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked(), v8::Number::New(isolate, value)).FromJust();
+    };
+
+    v8::Local<v8::Array> results = v8::Array::New(isolate, static_cast<int>(estimate->results.size()));
+
+    for (uint32_t i = 0; i < estimate->results.size(); i++)
+    {
+        const TargetRobustness &target = estimate->results[i];
+        double trials = static_cast<double>(target.trials);
+
+        v8::Local<v8::Object> result = v8::Object::New(isolate);
+        set(result, "id", static_cast<double>(target.id));
+        set(result, "trials", trials);
+        set(result, "activations", static_cast<double>(target.activations));
+        set(result, "misses", static_cast<double>(target.misses));
+        set(result, "falseActivations", static_cast<double>(target.falseActivations));
+        set(result, "stolen", static_cast<double>(target.stolen));
+        set(result, "missRate", trials > 0 ? target.misses / trials : 0.0);
+        set(result, "falseActivationRate", trials > 0 ? target.falseActivations / trials : 0.0);
+
+        results->Set(ctx, i, result).FromJust();
+    }
+
+    const unsigned int argc = 1;
+    v8::Local<v8::Value> argv[argc] = {results};
+
+    node::MakeCallback(isolate, ctx->Global(), estimate->callback.Get(isolate), argc, argv, {0, 0});
+}
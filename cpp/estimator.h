@@ -0,0 +1,43 @@
+/**
+ * JS binding of the layout robustness estimate, see robustness.h:
+ *
+ *   Screen.EstimateRobustness(layout, { precision: 15 }, (results) => { ... });
+ *
+ * The simulation runs on the libuv thread pool, spread over all cores,
+ * and calls back on the JS thread with one result per interactor.
+ */
+
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+#include <memory>
+#include <node.h>
+#include <v8.h>
+#include <uv.h>
+
+#include "jsutil.h"
+#include "logging.h"
+#include "robustness.h"
+
+class Estimator
+{
+private:
+    struct Estimate
+    {
+        uv_work_t request;
+        std::vector<Interactor> layout;
+        NoiseModel model;
+        std::vector<TargetRobustness> results;
+        v8::Global<v8::Function> callback;
+        v8::Global<v8::Context> context;
+    };
+
+    static void EstimateRobustness(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void Run(uv_work_t *request);
+    static void Finish(uv_work_t *request, int status);
+
+public:
+    static void Init(v8::Local<v8::Object> exports);
+};
+
+#endif // ESTIMATOR_H
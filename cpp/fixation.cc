@@ -0,0 +1,160 @@
+#include "fixation.h"
+
+#include <cmath>
+
+// Fixed point scale of window sums, in steps per display unit.
+static const double SCALE = 1024.0;
+
+FixationDetector::FixationDetector(const FixationOptions &options, IL::Timestamp origin_us, std::vector<Fixation> &runs)
+    : runs(runs)
+{
+    FixationDetector::options = options;
+    FixationDetector::recent = {};
+    FixationDetector::older = {};
+    FixationDetector::origin_us = origin_us;
+    FixationDetector::open = false;
+    FixationDetector::run = {};
+}
+
+void FixationDetector::Push(Window &window, const IL_GazePointData &sample)
+{
+    window.samples.push_back(sample);
+    window.x += std::llround(sample.x * SCALE);
+    window.y += std::llround(sample.y * SCALE);
+    window.t += sample.timestamp_us - FixationDetector::origin_us;
+}
+
+void FixationDetector::Pop(Window &window)
+{
+    const IL_GazePointData &sample = window.samples.front();
+    window.x -= std::llround(sample.x * SCALE);
+    window.y -= std::llround(sample.y * SCALE);
+    window.t -= sample.timestamp_us - FixationDetector::origin_us;
+    window.samples.pop_front();
+}
+
+void FixationDetector::Prime(const IL_GazePointData &sample)
+{
+    Window &recent = FixationDetector::recent;
+    Window &older = FixationDetector::older;
+
+    bool valid = sample.validity == IL_Validity_Valid && std::isfinite(sample.x) && std::isfinite(sample.y);
+
+    bool restart = !valid;
+    if (valid && !recent.samples.empty())
+    {
+        IL::Timestamp dt_us = sample.timestamp_us - recent.samples.back().timestamp_us;
+        restart = dt_us <= 0 || dt_us > FixationDetector::options.maxGap_us;
+    }
+
+    if (restart)
+    {
+        recent = {};
+        older = {};
+        if (!valid)
+            return;
+    }
+
+    Push(recent, sample);
+
+    IL::Timestamp from_us = sample.timestamp_us - FixationDetector::options.window_us;
+    while (recent.samples.front().timestamp_us <= from_us)
+    {
+        Push(older, recent.samples.front());
+        Pop(recent);
+    }
+
+    from_us -= FixationDetector::options.window_us;
+    while (!older.samples.empty() && older.samples.front().timestamp_us <= from_us)
+        Pop(older);
+}
+
+void FixationDetector::Add(const IL_GazePointData &sample, uint64_t index)
+{
+    Prime(sample);
+
+    const Window &recent = FixationDetector::recent;
+    const Window &older = FixationDetector::older;
+
+    bool fixating = false;
+
+    // An invalid sample or a gap empties both windows.
+    if (!older.samples.empty())
+    {
+        double n = static_cast<double>(recent.samples.size());
+        double m = static_cast<double>(older.samples.size());
+
+        double dx = (recent.x / n - older.x / m) / SCALE;
+        double dy = (recent.y / n - older.y / m) / SCALE;
+        double dt = recent.t / n - older.t / m;
+        double velocity = std::sqrt(dx * dx + dy * dy) * 1000000.0 / dt;
+
+        fixating = velocity < FixationDetector::options.velocity;
+    }
+
+    if (!fixating)
+    {
+        Flush();
+        return;
+    }
+
+    if (!FixationDetector::open)
+    {
+        FixationDetector::open = true;
+        FixationDetector::run = {index, index, sample.timestamp_us, sample.timestamp_us, 0.0, 0.0, 0};
+    }
+
+    Fixation &run = FixationDetector::run;
+    run.last = index;
+    run.end_us = sample.timestamp_us;
+    run.sumX += sample.x;
+    run.sumY += sample.y;
+    run.samples++;
+}
+
+void FixationDetector::Flush()
+{
+    if (!FixationDetector::open)
+        return;
+
+    FixationDetector::open = false;
+    FixationDetector::runs.push_back(FixationDetector::run);
+}
+
+void FixationDetector::Reset()
+{
+    Flush();
+    FixationDetector::recent = {};
+    FixationDetector::older = {};
+}
+
+void MergeFixations(const std::vector<std::vector<Fixation>> &chunks, const FixationOptions &options, std::vector<Fixation> &fixations)
+{
+    bool open = false;
+    Fixation current = {};
+
+    for (const std::vector<Fixation> &runs : chunks)
+    {
+        for (const Fixation &run : runs)
+        {
+            if (open && current.last + 1 == run.first)
+            {
+                current.last = run.last;
+                current.end_us = run.end_us;
+                current.sumX += run.sumX;
+                current.sumY += run.sumY;
+                current.samples += run.samples;
+                continue;
+            }
+
+            if (open && current.Duration() >= options.minDuration_us)
+                fixations.push_back(current);
+
+            open = true;
+            current = run;
+        }
+    }
+
+    if (open && current.Duration() >= options.minDuration_us)
+        fixations.push_back(current);
+}
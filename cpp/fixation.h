@@ -0,0 +1,110 @@
+/**
+ * Velocity threshold (I-VT) fixation detection on the gaze point stream.
+ *
+ * A sample belongs to a fixation if it is valid and the gaze moved
+ * slower than the threshold between the window before it and the window
+ * before that, with no invalid sample or long gap in between. Comparing
+ * the means of two windows rather than neighbouring samples keeps the
+ * noise of fast trackers from reading as movement, while at low rates
+ * it comes down to plain sample to sample velocity. A fixation is a run
+ * of such samples that lasts at least the minimum duration.
+ *
+ * Since a sample only looks two windows back, a stream can be split into
+ * chunks that are detected in parallel: each chunk is primed with the
+ * last two windows of the chunk before, and runs that meet at a chunk
+ * boundary are joined afterwards by MergeFixations.
+ */
+
+#ifndef FIXATION_H
+#define FIXATION_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+
+struct FixationOptions
+{
+    // Display units per second.
+    double velocity;
+
+    IL::Timestamp minDuration_us;
+
+    // Longer gaps between samples end a fixation.
+    IL::Timestamp maxGap_us;
+
+    // Length of the windows velocity is measured between.
+    IL::Timestamp window_us;
+};
+
+static const FixationOptions DEFAULT_FIXATION_OPTIONS = {1000.0, 60000, 100000, 20000};
+
+struct Fixation
+{
+    // Index of the first and last sample in the stream.
+    uint64_t first;
+    uint64_t last;
+
+    IL::Timestamp start_us;
+    IL::Timestamp end_us;
+
+    double sumX;
+    double sumY;
+    uint32_t samples;
+
+    float X() const { return static_cast<float>(sumX / samples); }
+    float Y() const { return static_cast<float>(sumY / samples); }
+    IL::Timestamp Duration() const { return end_us - start_us; }
+};
+
+class FixationDetector
+{
+public:
+    // Timestamps are measured from origin_us, e.g. the start of the recording.
+    FixationDetector(const FixationOptions &options, IL::Timestamp origin_us, std::vector<Fixation> &runs);
+
+    // Feed a sample from before the first one added, without classifying it.
+    void Prime(const IL_GazePointData &sample);
+
+    void Add(const IL_GazePointData &sample, uint64_t index);
+
+    // Close the open run. Runs are not filtered by duration.
+    void Flush();
+
+    // Close the open run and forget the window, e.g. after lost samples.
+    void Reset();
+
+private:
+    FixationOptions options;
+    std::vector<Fixation> &runs;
+
+    /**
+     * Valid samples of a window with their sums, kept in fixed point so
+     * they come out the same however the stream was chunked.
+     */
+    struct Window
+    {
+        std::deque<IL_GazePointData> samples;
+        int64_t x;
+        int64_t y;
+        int64_t t;
+    };
+
+    Window recent;
+    Window older;
+    IL::Timestamp origin_us;
+
+    void Push(Window &window, const IL_GazePointData &sample);
+    void Pop(Window &window);
+
+    bool open;
+    Fixation run;
+};
+
+/**
+ * Join the runs of consecutive chunks that meet at the boundary and
+ * keep those that last long enough.
+ * */
+void MergeFixations(const std::vector<std::vector<Fixation>> &chunks, const FixationOptions &options, std::vector<Fixation> &fixations);
+
+#endif // FIXATION_H
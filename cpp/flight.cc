@@ -0,0 +1,231 @@
+#include "flight.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "trace.h"
+
+// How long past the end of the window a dump waits for records
+// before it is written with what it has.
+static const std::chrono::seconds QUIET_TIMEOUT(1);
+
+FlightRecorder::FlightRecorder(PipelineCounters &counters, double seconds, double rate) : counters(counters)
+{
+    FlightRecorder::window_us = static_cast<IL::Timestamp>(seconds * 1000000.0);
+    FlightRecorder::latest_us = 0;
+    FlightRecorder::state = IDLE;
+    FlightRecorder::after_us = 0;
+    FlightRecorder::from_us = 0;
+    FlightRecorder::to_us = 0;
+    FlightRecorder::written = false;
+    FlightRecorder::closing = false;
+
+    uint32_t capacity = static_cast<uint32_t>(std::max(1.0, std::ceil(seconds * rate)));
+
+    // All the memory the tracker thread will ever write to is allocated here.
+    for (uint32_t type = 1; type <= RECORD_TYPES; type++)
+    {
+        for (Buffer *buffers : {FlightRecorder::history, FlightRecorder::before, FlightRecorder::after})
+        {
+            Buffer &buffer = buffers[type - 1];
+            buffer.size = RecordSize(type);
+            buffer.capacity = capacity;
+            buffer.count = 0;
+            buffer.next = 0;
+            buffer.data.resize(static_cast<size_t>(capacity) * buffer.size);
+        }
+    }
+
+    FlightRecorder::writer = std::thread(&FlightRecorder::Write, this);
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    {
+        std::lock_guard<std::mutex> guard(FlightRecorder::wakeLock);
+        FlightRecorder::closing = true;
+    }
+
+    FlightRecorder::wake.notify_one();
+    FlightRecorder::writer.join();
+}
+
+/**
+ * Called on the JS thread. The file is opened right away so errors can
+ * be reported, the window is taken on the next tracker update.
+ * */
+bool FlightRecorder::Dump(const std::string &path, double secondsAfter, bool compressed)
+{
+    std::lock_guard<std::mutex> guard(FlightRecorder::requestLock);
+
+    if (FlightRecorder::state != IDLE)
+        return false;
+
+    if (!FlightRecorder::output.Open(path, compressed))
+        return false;
+
+    // The post trigger buffers hold one window.
+    IL::Timestamp after_us = static_cast<IL::Timestamp>(secondsAfter * 1000000.0);
+    FlightRecorder::after_us = std::min(std::max(after_us, IL::Timestamp(0)), FlightRecorder::window_us);
+
+    FlightRecorder::state = REQUESTED;
+    return true;
+}
+
+/**
+ * Overwrite the oldest record of the type, and keep a copy while a dump
+ * is collecting what comes after the trigger. Records that don't fit
+ * the post trigger buffer are dropped.
+ * */
+void FlightRecorder::Append(RecordType type, const void *record)
+{
+    Buffer &history = FlightRecorder::history[type - 1];
+
+    // A full buffer loses its oldest record, which is only a loss while
+    // it is still inside the window, i.e. the rate was underestimated.
+    if (history.count == history.capacity && RecordTimestamp(history.Record(history.next)) + FlightRecorder::window_us > FlightRecorder::latest_us)
+        FlightRecorder::counters.Add(COUNTER_FLIGHT_OVERWRITTEN);
+
+    std::memcpy(history.data.data() + static_cast<size_t>(history.next) * history.size, record, history.size);
+    history.next = (history.next + 1) % history.capacity;
+    history.count = std::min(history.count + 1, history.capacity);
+
+    FlightRecorder::latest_us = std::max(FlightRecorder::latest_us, RecordTimestamp(record));
+
+    if (FlightRecorder::state.load(std::memory_order_relaxed) != CAPTURING)
+        return;
+
+    Buffer &after = FlightRecorder::after[type - 1];
+    if (after.count < after.capacity)
+    {
+        std::memcpy(after.data.data() + static_cast<size_t>(after.count) * after.size, record, after.size);
+        after.count++;
+    }
+    else
+        FlightRecorder::counters.Add(COUNTER_FLIGHT_DROPPED);
+}
+
+bool FlightRecorder::Update(bool &ok)
+{
+    switch (FlightRecorder::state)
+    {
+    case REQUESTED:
+        Trigger();
+        FlightRecorder::state = CAPTURING;
+        return false;
+
+    case CAPTURING:
+        if (FlightRecorder::latest_us < FlightRecorder::to_us && std::chrono::steady_clock::now() < FlightRecorder::deadline)
+            return false;
+
+        {
+            std::lock_guard<std::mutex> guard(FlightRecorder::wakeLock);
+            FlightRecorder::state = WRITING;
+        }
+        FlightRecorder::wake.notify_one();
+        return false;
+
+    case WRITTEN:
+        ok = FlightRecorder::written;
+
+        for (Buffer &after : FlightRecorder::after)
+            after.count = 0;
+
+        FlightRecorder::state = IDLE;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Freeze the history, oldest record first, and fix the span of the dump.
+ * */
+void FlightRecorder::Trigger()
+{
+    for (uint32_t i = 0; i < RECORD_TYPES; i++)
+    {
+        const Buffer &history = FlightRecorder::history[i];
+        Buffer &before = FlightRecorder::before[i];
+
+        uint32_t oldest = (history.next + history.capacity - history.count) % history.capacity;
+        uint32_t wrapped = std::min(history.count, history.capacity - oldest);
+
+        std::memcpy(before.data.data(), history.Record(oldest), static_cast<size_t>(wrapped) * history.size);
+        std::memcpy(before.data.data() + static_cast<size_t>(wrapped) * history.size, history.Record(0), static_cast<size_t>(history.count - wrapped) * history.size);
+        before.count = history.count;
+    }
+
+    FlightRecorder::from_us = FlightRecorder::latest_us - FlightRecorder::window_us;
+    FlightRecorder::to_us = FlightRecorder::latest_us + FlightRecorder::after_us;
+    FlightRecorder::deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(FlightRecorder::after_us) + QUIET_TIMEOUT;
+}
+
+/**
+ * Writer thread, waits for a complete dump and writes each stream from
+ * the start of the window to the end of the span.
+ * */
+void FlightRecorder::Write()
+{
+    Tracing::NameThread("flight recorder");
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(FlightRecorder::wakeLock);
+            FlightRecorder::wake.wait(lock, [this] { return FlightRecorder::closing || FlightRecorder::state == WRITING; });
+
+            if (FlightRecorder::state != WRITING)
+                return;
+        }
+
+        TraceSpan span("WriteDump");
+
+        for (uint32_t type = 1; type <= RECORD_TYPES; type++)
+        {
+            const Buffer &before = FlightRecorder::before[type - 1];
+            const Buffer &after = FlightRecorder::after[type - 1];
+
+            // Timestamps only go up within a stream.
+            uint32_t first = 0;
+            uint32_t count = before.count;
+            while (count > 0)
+            {
+                uint32_t half = count / 2;
+                if (RecordTimestamp(before.Record(first + half)) <= FlightRecorder::from_us)
+                {
+                    first += half + 1;
+                    count -= half + 1;
+                }
+                else
+                {
+                    count = half;
+                }
+            }
+
+            uint32_t last = after.count;
+            while (last > 0 && RecordTimestamp(after.Record(last - 1)) > FlightRecorder::to_us)
+                last--;
+
+            WriteBuffer(before, type, first, before.count);
+            WriteBuffer(after, type, 0, last);
+        }
+
+        FlightRecorder::written = FlightRecorder::output.Finish();
+        FlightRecorder::state = WRITTEN;
+    }
+}
+
+/**
+ * Write records first to last in chunks the size of a Recorder block,
+ * so dumps seek like any other recording.
+ * */
+void FlightRecorder::WriteBuffer(const Buffer &buffer, uint32_t type, uint32_t first, uint32_t last)
+{
+    uint32_t chunk = static_cast<uint32_t>(Recorder::BLOCK_SIZE / buffer.size) - 1;
+
+    for (uint32_t i = first; i < last; i += chunk)
+        FlightRecorder::output.WriteChunk(type, buffer.Record(i), std::min(chunk, last - i));
+}
@@ -0,0 +1,111 @@
+/**
+ * Flight recorder: the last seconds of every recorded stream, kept in
+ * memory at all times and written to a recording file on demand.
+ *
+ * Each stream goes into a circular buffer sized for the window at the
+ * expected sample rate, the oldest records are overwritten. A dump
+ * freezes a copy of the buffers, keeps collecting records for the
+ * seconds after the trigger, and then hands both to a writer thread that
+ * writes an ordinary recording, see recording.h. All buffers are
+ * allocated up front, so the tracker thread never allocates or waits
+ * on the disk. One dump runs at a time.
+ */
+
+#ifndef FLIGHT_H
+#define FLIGHT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "counters.h"
+#include "recording.h"
+
+class FlightRecorder
+{
+public:
+    // Records per second assumed when sizing the buffers.
+    static constexpr double DEFAULT_RATE = 1200.0;
+
+    FlightRecorder(PipelineCounters &counters, double seconds, double rate = DEFAULT_RATE);
+    ~FlightRecorder();
+
+    /**
+     * Open the file and trigger a dump of the window before now and the
+     * secondsAfter after it, at most the length of the window.
+     * False if a dump is already running or the file can't be created.
+     * */
+    bool Dump(const std::string &path, double secondsAfter, bool compressed = false);
+
+    // Tracker thread only.
+    void Append(RecordType type, const void *record);
+
+    /**
+     * Tracker thread, once per update. Starts a requested dump, hands a
+     * complete one to the writer, and returns true once it was written,
+     * with ok telling whether it succeeded.
+     * */
+    bool Update(bool &ok);
+
+private:
+    enum State
+    {
+        IDLE,
+        REQUESTED,
+        CAPTURING,
+        WRITING,
+        WRITTEN
+    };
+
+    // Records of one type in a fixed amount of memory.
+    struct Buffer
+    {
+        uint32_t size;
+        uint32_t capacity;
+        uint32_t count;
+        uint32_t next;
+        std::vector<char> data;
+
+        const char *Record(uint32_t index) const { return data.data() + static_cast<size_t>(index) * size; }
+    };
+
+    PipelineCounters &counters;
+    IL::Timestamp window_us;
+
+    // Circular, indexed by type - 1.
+    Buffer history[RECORD_TYPES];
+
+    // Linear, frozen copy of history and what came in after the trigger.
+    Buffer before[RECORD_TYPES];
+    Buffer after[RECORD_TYPES];
+
+    // Latest timestamp seen on any stream.
+    IL::Timestamp latest_us;
+
+    std::atomic<State> state;
+    std::mutex requestLock;
+    RecordingWriter output;
+    IL::Timestamp after_us;
+
+    // Span of the dump, the wall clock deadline covers streams going quiet.
+    IL::Timestamp from_us;
+    IL::Timestamp to_us;
+    std::chrono::steady_clock::time_point deadline;
+    bool written;
+
+    std::thread writer;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    bool closing;
+
+    void Trigger();
+    void Write();
+    void WriteBuffer(const Buffer &buffer, uint32_t type, uint32_t first, uint32_t last);
+};
+
+#endif // FLIGHT_H
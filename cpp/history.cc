@@ -0,0 +1,142 @@
+#include "history.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Fixed point scale of the running sums, in steps per display unit.
+static const double SCALE = 1024.0;
+
+// Slots next to the one being written that readers leave alone,
+// so a reader falling slightly behind still gets its samples.
+static const uint64_t GUARD = 64;
+
+GazeHistory::GazeHistory(uint32_t capacity)
+    : slots(new Slot[capacity + GUARD])
+{
+    GazeHistory::capacity = capacity + static_cast<uint32_t>(GUARD);
+    GazeHistory::written = 0;
+    GazeHistory::sumX = 0;
+    GazeHistory::sumY = 0;
+}
+
+/**
+ * Invalid samples are left out, they carry no position.
+ * */
+void GazeHistory::Add(const IL_GazePointData &sample)
+{
+    if (sample.validity != IL_Validity_Valid || !std::isfinite(sample.x) || !std::isfinite(sample.y))
+        return;
+
+    uint64_t sequence = GazeHistory::written.load(std::memory_order_relaxed);
+    Slot &slot = GazeHistory::slots[sequence % GazeHistory::capacity];
+
+    GazeHistory::sumX += std::llround(sample.x * SCALE);
+    GazeHistory::sumY += std::llround(sample.y * SCALE);
+
+    slot.timestamp_us.store(sample.timestamp_us, std::memory_order_relaxed);
+    slot.x.store(sample.x, std::memory_order_relaxed);
+    slot.y.store(sample.y, std::memory_order_relaxed);
+    slot.sumX.store(GazeHistory::sumX, std::memory_order_relaxed);
+    slot.sumY.store(GazeHistory::sumY, std::memory_order_relaxed);
+
+    GazeHistory::written.store(sequence + 1, std::memory_order_release);
+}
+
+IL::Timestamp GazeHistory::Latest() const
+{
+    uint64_t written = GazeHistory::written.load(std::memory_order_acquire);
+    if (written == 0)
+        return 0;
+
+    return At(written - 1).timestamp_us.load(std::memory_order_relaxed);
+}
+
+uint64_t GazeHistory::Oldest(uint64_t written) const
+{
+    return written > GazeHistory::capacity - GUARD ? written - (GazeHistory::capacity - GUARD) : 0;
+}
+
+/**
+ * True if the writer has not come round to sequence number first yet.
+ * Called after reading, the fence keeps the reads before the check.
+ * */
+bool GazeHistory::Intact(uint64_t first) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    uint64_t written = GazeHistory::written.load(std::memory_order_relaxed);
+    return written < GazeHistory::capacity || first > written - GazeHistory::capacity;
+}
+
+void GazeHistory::Find(IL::Timestamp since_us, uint64_t &first, uint64_t &last) const
+{
+    do
+    {
+        last = GazeHistory::written.load(std::memory_order_acquire);
+        first = Oldest(last);
+
+        // First sample at or after since_us.
+        uint64_t count = last - first;
+        while (count > 0)
+        {
+            uint64_t half = count / 2;
+            if (At(first + half).timestamp_us.load(std::memory_order_relaxed) < since_us)
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
+        }
+    } while (!Intact(first));
+}
+
+bool GazeHistory::Copy(uint64_t first, uint64_t last, double *out) const
+{
+    for (uint64_t i = first; i < last; i++)
+    {
+        const Slot &slot = At(i);
+        *out++ = static_cast<double>(slot.timestamp_us.load(std::memory_order_relaxed));
+        *out++ = slot.x.load(std::memory_order_relaxed);
+        *out++ = slot.y.load(std::memory_order_relaxed);
+    }
+
+    return Intact(first);
+}
+
+bool GazeHistory::Stats(uint64_t first, uint64_t last, HistoryStats &stats) const
+{
+    stats = {};
+    if (first == last)
+        return true;
+
+    const Slot &start = At(first);
+    const Slot &end = At(last - 1);
+
+    stats.count = static_cast<uint32_t>(last - first);
+    stats.from_us = start.timestamp_us.load(std::memory_order_relaxed);
+    stats.to_us = end.timestamp_us.load(std::memory_order_relaxed);
+
+    // The sums up to last, less the sums before first.
+    double n = static_cast<double>(stats.count);
+    int64_t x = end.sumX.load(std::memory_order_relaxed) - start.sumX.load(std::memory_order_relaxed) + std::llround(start.x.load(std::memory_order_relaxed) * SCALE);
+    int64_t y = end.sumY.load(std::memory_order_relaxed) - start.sumY.load(std::memory_order_relaxed) + std::llround(start.y.load(std::memory_order_relaxed) * SCALE);
+    stats.meanX = static_cast<float>(x / SCALE / n);
+    stats.meanY = static_cast<float>(y / SCALE / n);
+
+    stats.minX = stats.maxX = start.x.load(std::memory_order_relaxed);
+    stats.minY = stats.maxY = start.y.load(std::memory_order_relaxed);
+    for (uint64_t i = first + 1; i < last; i++)
+    {
+        float sx = At(i).x.load(std::memory_order_relaxed);
+        float sy = At(i).y.load(std::memory_order_relaxed);
+        stats.minX = std::min(stats.minX, sx);
+        stats.maxX = std::max(stats.maxX, sx);
+        stats.minY = std::min(stats.minY, sy);
+        stats.maxY = std::max(stats.maxY, sy);
+    }
+
+    return Intact(first);
+}
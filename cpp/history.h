@@ -0,0 +1,100 @@
+/**
+ * The most recent valid gaze points, indexed by time, for questions like
+ * "where was the gaze in the last 200 ms".
+ *
+ * The tracker thread appends to a fixed-size ring and the JS thread
+ * reads it without locking: samples are numbered by a sequence number,
+ * the writer publishes how many it has written, and a reader checks
+ * afterwards that none of the slots it read were overwritten in the
+ * meantime, retrying if they were. Timestamps only go up, so the start
+ * of a range is a binary search. Each slot also carries the running sum
+ * of the coordinates up to it, so the mean of any range is the
+ * difference of two sums.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <interaction_lib/InteractionLib.h>
+
+struct HistoryStats
+{
+    uint32_t count;
+
+    // Timestamps of the first and last sample.
+    IL::Timestamp from_us;
+    IL::Timestamp to_us;
+
+    float meanX;
+    float meanY;
+
+    // Bounding box of the samples.
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+};
+
+class GazeHistory
+{
+public:
+    // Values per sample written by Copy: timestamp, x, y.
+    static const int FIELDS = 3;
+
+    explicit GazeHistory(uint32_t capacity);
+
+    // Tracker thread only.
+    void Add(const IL_GazePointData &sample);
+
+    // Timestamp of the newest sample, 0 if there is none yet.
+    IL::Timestamp Latest() const;
+
+    /**
+     * Sequence numbers [first, last) of the samples at or after since_us.
+     * */
+    void Find(IL::Timestamp since_us, uint64_t &first, uint64_t &last) const;
+
+    /**
+     * Copy samples first to last into out, FIELDS values each, and
+     * false if some of them were overwritten meanwhile.
+     * */
+    bool Copy(uint64_t first, uint64_t last, double *out) const;
+
+    /**
+     * Stats of samples first to last, false as for Copy.
+     * */
+    bool Stats(uint64_t first, uint64_t last, HistoryStats &stats) const;
+
+private:
+    // Fields are atomic so reading a slot being overwritten is only stale, never undefined.
+    struct Slot
+    {
+        std::atomic<int64_t> timestamp_us;
+        std::atomic<float> x;
+        std::atomic<float> y;
+
+        // Fixed point sums of x and y over every sample up to this one.
+        std::atomic<int64_t> sumX;
+        std::atomic<int64_t> sumY;
+    };
+
+    uint32_t capacity;
+    std::unique_ptr<Slot[]> slots;
+
+    // Samples written so far, published after the slot.
+    std::atomic<uint64_t> written;
+
+    int64_t sumX;
+    int64_t sumY;
+
+    const Slot &At(uint64_t sequence) const { return slots[sequence % capacity]; }
+
+    // Oldest sequence number that can't be overwritten before a reader is done with it.
+    uint64_t Oldest(uint64_t written) const;
+    bool Intact(uint64_t first) const;
+};
+
+#endif // HISTORY_H
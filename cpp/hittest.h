@@ -0,0 +1,40 @@
+/**
+ * Rectangle interactors and the hit test used to pick the one in focus.
+ */
+
+#ifndef HITTEST_H
+#define HITTEST_H
+
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+
+struct Interactor
+{
+    IL::InteractorId id;
+    IL::Rectangle bounds;
+    float z;
+};
+
+inline bool Contains(const IL::Rectangle &rect, float x, float y)
+{
+    return x >= rect.x && x < rect.x + rect.w && y >= rect.y && y < rect.y + rect.h;
+}
+
+/**
+ * The interactor on top at (x, y), nullptr if none.
+ * The highest z wins, ties go to the interactor added last.
+ */
+inline const Interactor *HitTest(const std::vector<Interactor> &interactors, float x, float y)
+{
+    const Interactor *hit = nullptr;
+
+    for (const Interactor &interactor : interactors)
+    {
+        if (Contains(interactor.bounds, x, y) && (!hit || interactor.z >= hit->z))
+            hit = &interactor;
+    }
+
+    return hit;
+}
+
+#endif // HITTEST_H
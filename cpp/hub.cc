@@ -0,0 +1,42 @@
+#include "hub.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "logging.h"
+
+static std::mutex lock;
+static std::weak_ptr<Tracker> shared;
+static std::atomic<uint32_t> spaces(0);
+
+std::shared_ptr<Tracker> TrackerHub::Acquire(float width, float height, std::unique_ptr<Adapter> adapter)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::shared_ptr<Tracker> tracker = shared.lock();
+    if (tracker)
+    {
+        if (adapter)
+            Logging::Write(IL_LoggingLevel_Warn, "the shared tracker is already running, ignoring the data source");
+        return tracker;
+    }
+
+    tracker = std::make_shared<Tracker>(width, height, std::move(adapter));
+    shared = tracker;
+    return tracker;
+}
+
+/**
+ * Spaces take the top 16 bits of an id, 0 is for Screens of their own.
+ * */
+uint32_t TrackerHub::NextSpace()
+{
+    uint32_t space = ++spaces;
+    if (space > (UINT32_C(1) << (64 - INTERACTOR_SPACE_SHIFT)) - 1)
+    {
+        Logging::Write(IL_LoggingLevel_Error, "out of interactor id spaces, shared screens may see each other's focus");
+        space = (space - 1) % 0xffff + 1;
+    }
+
+    return space;
+}
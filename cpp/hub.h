@@ -0,0 +1,39 @@
+/**
+ * Process-wide tracker shared by the Screens created with shared: true.
+ *
+ * Each Screen of its own runs an interaction library instance and a
+ * tracker thread, which is a waste when a process shows several windows
+ * on the one display. Shared Screens hold a reference to the same
+ * Tracker instead, it is created by the first of them and goes away
+ * with the last. Each attaches a TrackerClient of its own, the tracker
+ * fans the gaze points and blinks out to all of them and each focus
+ * event to the one that added the interactor.
+ *
+ * The interactor ids of a shared Screen are namespaced by its space, see
+ * TrackerClient, so two Screens can both use id 1.
+ */
+
+#ifndef HUB_H
+#define HUB_H
+
+#include <cstdint>
+#include <memory>
+
+#include "adapter.h"
+#include "tracker.h"
+
+class TrackerHub
+{
+public:
+    /**
+     * The shared tracker, created for the display size and data source of
+     * the first caller. Later callers get it as it is, an adapter they
+     * pass is dropped.
+     * */
+    static std::shared_ptr<Tracker> Acquire(float width, float height, std::unique_ptr<Adapter> adapter);
+
+    // A new interactor id space, one for each shared Screen.
+    static uint32_t NextSpace();
+};
+
+#endif // HUB_H
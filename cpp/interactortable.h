@@ -0,0 +1,288 @@
+/**
+ * Interactor table in shared memory, for a renderer in another process
+ * to hand its layout to the Screen without serializing it.
+ *
+ * The renderer creates the table and owns it. The segment holds a
+ * header and two buffers of capacity rectangles, stored as one array
+ * per field:
+ *
+ *   InteractorTableHeader
+ *   buffer 0: ids, x, y, width, height, z
+ *   buffer 1: ids, x, y, width, height, z
+ *
+ * The generation counts the layouts published, the last one is in buffer
+ * generation & 1 and the writer edits the other. Each buffer has a
+ * seqlock, odd while the writer is in it, so a reader that copies a
+ * buffer the writer got to in the meantime knows to try again.
+ *
+ * The tracker reads the table once per update, and only when the
+ * generation moved, and commits what changed to the IL. The writer is
+ * header-only so renderers can use it on its own:
+ *
+ *   InteractorTableWriter table;
+ *   table.Create("layout", 1024);
+ *
+ *   InteractorColumns columns = table.Edit();
+ *   columns.ids[0] = 1;
+ *   columns.x[0] = 100.0f;
+ *   ...
+ *   table.Publish(1);
+ */
+
+#ifndef INTERACTORTABLE_H
+#define INTERACTORTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+
+#include "hittest.h"
+#include "mapping.h"
+
+static const uint32_t INTERACTOR_TABLE_MAGIC = 0x4c545a46;
+static const uint32_t INTERACTOR_TABLE_VERSION = 1;
+
+struct InteractorTableHeader
+{
+    // Stored last, readers ignore a segment until it is set.
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+
+    // Rectangles each buffer has room for.
+    uint32_t capacity;
+
+    // Set when the writer goes away.
+    std::atomic<uint32_t> closed;
+
+    // Of each buffer, counts written under its seqlock.
+    uint64_t offsets[2];
+    uint32_t counts[2];
+
+    alignas(64) std::atomic<uint64_t> sequences[2];
+    alignas(64) std::atomic<uint64_t> generation;
+};
+
+// The fields of a buffer, capacity entries each.
+struct InteractorColumns
+{
+    uint64_t *ids;
+    float *x;
+    float *y;
+    float *width;
+    float *height;
+    float *z;
+};
+
+inline uint64_t InteractorTableBufferSize(uint32_t capacity)
+{
+    uint64_t size = static_cast<uint64_t>(capacity) * (sizeof(uint64_t) + 5 * sizeof(float));
+    return (size + 63) & ~uint64_t(63);
+}
+
+inline InteractorColumns InteractorTableColumns(char *data, const InteractorTableHeader *header, uint32_t buffer)
+{
+    char *base = data + header->offsets[buffer];
+    float *fields = reinterpret_cast<float *>(base + static_cast<size_t>(header->capacity) * sizeof(uint64_t));
+    uint32_t n = header->capacity;
+
+    return {reinterpret_cast<uint64_t *>(base), fields, fields + n, fields + 2 * n, fields + 3 * n, fields + 4 * n};
+}
+
+/**
+ * Renderer side, one writer per table.
+ */
+class InteractorTableWriter
+{
+public:
+    InteractorTableWriter() : header(nullptr), editing(false) {}
+
+    ~InteractorTableWriter() { Close(); }
+
+    InteractorTableWriter(const InteractorTableWriter &) = delete;
+    InteractorTableWriter &operator=(const InteractorTableWriter &) = delete;
+
+    /**
+     * Create the table, empty at generation 0, replacing one of the same
+     * name left behind. False if the segment can't be created.
+     * */
+    bool Create(const std::string &name, uint32_t capacity)
+    {
+        uint64_t offset = (sizeof(InteractorTableHeader) + 63) & ~uint64_t(63);
+        uint64_t buffer = InteractorTableBufferSize(capacity);
+
+        if (capacity == 0 || !InteractorTableWriter::segment.Create(name, static_cast<size_t>(offset + 2 * buffer)))
+            return false;
+
+        // A new segment is zeroed, both buffers are empty and unlocked.
+        InteractorTableHeader *header = new (InteractorTableWriter::segment.Data()) InteractorTableHeader();
+        header->version = INTERACTOR_TABLE_VERSION;
+        header->capacity = capacity;
+        header->closed.store(0, std::memory_order_relaxed);
+        header->offsets[0] = offset;
+        header->offsets[1] = offset + buffer;
+        header->counts[0] = 0;
+        header->counts[1] = 0;
+        header->sequences[0].store(0, std::memory_order_relaxed);
+        header->sequences[1].store(0, std::memory_order_relaxed);
+        header->generation.store(0, std::memory_order_relaxed);
+
+        header->magic.store(INTERACTOR_TABLE_MAGIC, std::memory_order_release);
+
+        InteractorTableWriter::header = header;
+        return true;
+    }
+
+    // Tell the tracker the table is gone and remove its name.
+    void Close()
+    {
+        if (InteractorTableWriter::header)
+            InteractorTableWriter::header->closed.store(1, std::memory_order_release);
+
+        InteractorTableWriter::segment.Unlink();
+    }
+
+    uint32_t Capacity() const { return InteractorTableWriter::header->capacity; }
+    uint64_t Generation() const { return InteractorTableWriter::header->generation.load(std::memory_order_relaxed); }
+
+    /**
+     * Columns of the next layout, starting as a copy of the published
+     * one so it can be edited in place. Valid until Publish.
+     * */
+    InteractorColumns Edit()
+    {
+        InteractorTableHeader *h = InteractorTableWriter::header;
+        uint32_t back = Back();
+
+        if (!InteractorTableWriter::editing)
+        {
+            // Odd while the buffer is being written.
+            h->sequences[back].fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            // Only the entries in use, the rest is the writer's to fill.
+            uint32_t front = back ^ 1;
+            uint32_t count = h->counts[front];
+            InteractorColumns from = InteractorTableColumns(InteractorTableWriter::segment.Data(), h, front);
+            InteractorColumns to = InteractorTableColumns(InteractorTableWriter::segment.Data(), h, back);
+
+            std::memcpy(to.ids, from.ids, count * sizeof(uint64_t));
+            std::memcpy(to.x, from.x, count * sizeof(float));
+            std::memcpy(to.y, from.y, count * sizeof(float));
+            std::memcpy(to.width, from.width, count * sizeof(float));
+            std::memcpy(to.height, from.height, count * sizeof(float));
+            std::memcpy(to.z, from.z, count * sizeof(float));
+            h->counts[back] = count;
+
+            InteractorTableWriter::editing = true;
+        }
+
+        return InteractorTableColumns(InteractorTableWriter::segment.Data(), h, back);
+    }
+
+    // Entries in use of the layout being edited, or else the published one.
+    uint32_t Count() const
+    {
+        uint32_t buffer = InteractorTableWriter::editing ? Back() : Back() ^ 1;
+        return InteractorTableWriter::header->counts[buffer];
+    }
+
+    /**
+     * Make the first count entries of the edited columns the layout.
+     * */
+    void Publish(uint32_t count)
+    {
+        InteractorTableHeader *h = InteractorTableWriter::header;
+        uint32_t back = Back();
+
+        Edit();
+        h->counts[back] = count < h->capacity ? count : h->capacity;
+
+        h->sequences[back].fetch_add(1, std::memory_order_release);
+        h->generation.fetch_add(1, std::memory_order_release);
+        InteractorTableWriter::editing = false;
+    }
+
+private:
+    SharedMapping segment;
+    InteractorTableHeader *header;
+    bool editing;
+
+    uint32_t Back() const
+    {
+        return static_cast<uint32_t>((InteractorTableWriter::header->generation.load(std::memory_order_relaxed) + 1) & 1);
+    }
+};
+
+/**
+ * Tracker side.
+ */
+class InteractorTableReader
+{
+public:
+    InteractorTableReader() : header(nullptr) {}
+
+    /**
+     * Map the table by name, false if there is none or it isn't ready yet.
+     * */
+    bool Open(const std::string &name)
+    {
+        InteractorTableReader::segment.Close();
+        InteractorTableReader::header = nullptr;
+
+        if (!InteractorTableReader::segment.Open(name) || InteractorTableReader::segment.Size() < sizeof(InteractorTableHeader))
+            return false;
+
+        const InteractorTableHeader *header = reinterpret_cast<const InteractorTableHeader *>(InteractorTableReader::segment.Data());
+        if (header->magic.load(std::memory_order_acquire) != INTERACTOR_TABLE_MAGIC || header->version != INTERACTOR_TABLE_VERSION)
+            return false;
+
+        if (header->offsets[1] + InteractorTableBufferSize(header->capacity) > InteractorTableReader::segment.Size())
+            return false;
+
+        InteractorTableReader::header = header;
+        return true;
+    }
+
+    bool Closed() const { return InteractorTableReader::header->closed.load(std::memory_order_acquire) != 0; }
+
+    uint64_t Generation() const { return InteractorTableReader::header->generation.load(std::memory_order_acquire); }
+
+    /**
+     * Copy the published layout, and its generation. False if the writer
+     * got to the buffer while it was copied, try again later.
+     * */
+    bool Read(std::vector<Interactor> &layout, uint64_t &generation) const
+    {
+        const InteractorTableHeader *h = InteractorTableReader::header;
+
+        generation = h->generation.load(std::memory_order_acquire);
+        uint32_t buffer = static_cast<uint32_t>(generation & 1);
+
+        uint64_t sequence = h->sequences[buffer].load(std::memory_order_acquire);
+        if (sequence & 1)
+            return false;
+
+        uint32_t count = h->counts[buffer];
+        if (count > h->capacity)
+            return false;
+
+        InteractorColumns columns = InteractorTableColumns(InteractorTableReader::segment.Data(), h, buffer);
+
+        layout.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+            layout[i] = {columns.ids[i], {columns.x[i], columns.y[i], columns.width[i], columns.height[i]}, columns.z[i]};
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return h->sequences[buffer].load(std::memory_order_relaxed) == sequence;
+    }
+
+private:
+    SharedMapping segment;
+    const InteractorTableHeader *header;
+};
+
+#endif // INTERACTORTABLE_H
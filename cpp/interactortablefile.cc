@@ -0,0 +1,190 @@
+#include "interactortablefile.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+/**
+ * Tables created from JS. Their objects may never be collected, so the
+ * tables are closed here at exit, for the tracker to know and for the
+ * names to go away.
+ */
+static struct Tables
+{
+    std::mutex lock;
+    std::vector<std::weak_ptr<InteractorTableWriter>> open;
+
+    ~Tables()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (std::weak_ptr<InteractorTableWriter> &table : open)
+        {
+            if (std::shared_ptr<InteractorTableWriter> writer = table.lock())
+                writer->Close();
+        }
+    }
+} tables;
+
+/**
+ * Binds the InteractorTable object to v8.
+ * */
+void InteractorTableFile::Init(v8::Local<v8::Object> exports)
+{
+    v8::Isolate *isolate = exports->GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    v8::Local<v8::FunctionTemplate> tpl = v8::FunctionTemplate::New(isolate, InteractorTableFile::New);
+    tpl->SetClassName(v8::String::NewFromUtf8(isolate, "InteractorTable").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    NODE_SET_PROTOTYPE_METHOD(tpl, "Edit", InteractorTableFile::Edit);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "Publish", InteractorTableFile::Publish);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetCount", InteractorTableFile::GetCount);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetCapacity", InteractorTableFile::GetCapacity);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetGeneration", InteractorTableFile::GetGeneration);
+
+    v8::Local<v8::Function> construct = tpl->GetFunction(context).ToLocalChecked();
+
+    v8::Local<v8::String> object_name = v8::String::NewFromUtf8(isolate, "InteractorTable").ToLocalChecked();
+    exports->Set(context, object_name, construct).FromJust();
+}
+
+/**
+ * JS constructor, let table = new InteractorTable('layout', capacity);
+ * Creates the table, empty. Throws if it can't be created.
+ * */
+void InteractorTableFile::New(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    if (!args.IsConstructCall())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "Please init InteractorTable with the 'new' keyword");
+        return;
+    }
+
+    if (!args[0]->IsString() || !args[1]->IsNumber())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "arguments must be a table name and a capacity");
+        return;
+    }
+
+    v8::String::Utf8Value name(isolate, args[0]);
+    int64_t capacity = args[1]->IntegerValue(ctx).FromMaybe(0);
+
+    InteractorTableFile *t = new InteractorTableFile();
+    t->writer = std::make_shared<InteractorTableWriter>();
+
+    if (capacity <= 0 || capacity > UINT32_MAX || !t->writer->Create(*name, static_cast<uint32_t>(capacity)))
+    {
+        delete t;
+
+        std::string message = std::string("Could not create interactor table ") + *name;
+        isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(tables.lock);
+        tables.open.push_back(t->writer);
+    }
+
+    t->Wrap(args.This());
+    args.GetReturnValue().Set(args.This());
+}
+
+/**
+ * Columns of the next layout as { ids, x, y, width, height, z }, ids a
+ * BigUint64Array and the rest Float32Arrays, capacity entries each.
+ * They start as a copy of the published layout and must not be used
+ * after Publish, call Edit again for the next one.
+ * */
+void InteractorTableFile::Edit(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    InteractorTableFile *t = ObjectWrap::Unwrap<InteractorTableFile>(args.Holder());
+
+    InteractorColumns columns = t->writer->Edit();
+    size_t capacity = t->writer->Capacity();
+
+    std::shared_ptr<InteractorTableWriter> *owner = new std::shared_ptr<InteractorTableWriter>(t->writer);
+    std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(
+        columns.ids, static_cast<size_t>(InteractorTableBufferSize(t->writer->Capacity())),
+        [](void *data, size_t length, void *owner)
+        {
+            delete static_cast<std::shared_ptr<InteractorTableWriter> *>(owner);
+        },
+        owner);
+
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(store));
+
+    auto column = [&](const float *data)
+    {
+        size_t offset = reinterpret_cast<const char *>(data) - reinterpret_cast<const char *>(columns.ids);
+        return v8::Float32Array::New(buffer, offset, capacity);
+    };
+
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    result->Set(ctx, v8::String::NewFromUtf8(isolate, "ids").ToLocalChecked(), v8::BigUint64Array::New(buffer, 0, capacity)).FromJust();
+    result->Set(ctx, v8::String::NewFromUtf8(isolate, "x").ToLocalChecked(), column(columns.x)).FromJust();
+    result->Set(ctx, v8::String::NewFromUtf8(isolate, "y").ToLocalChecked(), column(columns.y)).FromJust();
+    result->Set(ctx, v8::String::NewFromUtf8(isolate, "width").ToLocalChecked(), column(columns.width)).FromJust();
+    result->Set(ctx, v8::String::NewFromUtf8(isolate, "height").ToLocalChecked(), column(columns.height)).FromJust();
+    result->Set(ctx, v8::String::NewFromUtf8(isolate, "z").ToLocalChecked(), column(columns.z)).FromJust();
+
+    args.GetReturnValue().Set(result);
+}
+
+/**
+ * Make the first count entries of the edited columns the layout the
+ * tracker commits at its next update.
+ *
+ * params
+ * count   number
+ * */
+void InteractorTableFile::Publish(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    InteractorTableFile *t = ObjectWrap::Unwrap<InteractorTableFile>(args.Holder());
+
+    if (!args[0]->IsNumber())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a count");
+        return;
+    }
+
+    int64_t count = args[0]->IntegerValue(ctx).FromMaybe(0);
+    t->writer->Publish(static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(count, 0), t->writer->Capacity())));
+}
+
+/**
+ * Entries of the layout being edited, or else of the published one.
+ * */
+void InteractorTableFile::GetCount(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    InteractorTableFile *t = ObjectWrap::Unwrap<InteractorTableFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), t->writer->Count()));
+}
+
+void InteractorTableFile::GetCapacity(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    InteractorTableFile *t = ObjectWrap::Unwrap<InteractorTableFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), t->writer->Capacity()));
+}
+
+/**
+ * Layouts published so far.
+ * */
+void InteractorTableFile::GetGeneration(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    InteractorTableFile *t = ObjectWrap::Unwrap<InteractorTableFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), static_cast<double>(t->writer->Generation())));
+}
@@ -0,0 +1,46 @@
+/**
+ * JS binding of InteractorTableWriter, for a renderer process to publish
+ * its layout to the process that owns the Screen, e.g.
+ *
+ *   let table = new Screen.InteractorTable('layout', 1024);
+ *   let columns = table.Edit();
+ *   columns.ids[0] = 1n;
+ *   columns.x[0] = 100;
+ *   ...
+ *   table.Publish(1);
+ *
+ * The columns are typed arrays over the shared memory itself, what the
+ * renderer writes there is what the tracker reads, no copy in between.
+ */
+
+#ifndef INTERACTORTABLEFILE_H
+#define INTERACTORTABLEFILE_H
+
+#include <memory>
+#include <node.h>
+#include <v8.h>
+#include <node_object_wrap.h>
+
+#include "interactortable.h"
+#include "logging.h"
+
+class InteractorTableFile : public node::ObjectWrap
+{
+private:
+    // Shared with the ArrayBuffers handed out, the mapping stays until
+    // the last of them is collected.
+    std::shared_ptr<InteractorTableWriter> writer;
+
+    static void New(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void Edit(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void Publish(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetCount(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetCapacity(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetGeneration(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+public:
+    static void Init(v8::Local<v8::Object> exports);
+};
+
+#endif // INTERACTORTABLEFILE_H
@@ -0,0 +1,56 @@
+#include "jsutil.h"
+
+/**
+ * Read a number from an options object, or keep the default.
+ * */
+double Option(v8::Isolate *isolate, v8::Local<v8::Object> options, const char *name, double value)
+{
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    v8::Local<v8::Value> option = options->Get(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked()).ToLocalChecked();
+    if (option->IsNumber())
+        value = option->NumberValue(ctx).FromMaybe(value);
+
+    return value;
+}
+
+/**
+ * Read an array of rectangles in the format AddRectangles takes,
+ * { id, x, y, width, height }, with an optional z.
+ * */
+bool ReadLayout(v8::Isolate *isolate, v8::Local<v8::Value> value, std::vector<Interactor> &layout)
+{
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    if (!value->IsArray())
+        return false;
+
+    v8::Local<v8::Array> array = value.As<v8::Array>();
+
+    for (uint32_t i = 0; i < array->Length(); i++)
+    {
+        v8::Local<v8::Value> item = array->Get(ctx, i).ToLocalChecked();
+        if (!item->IsObject())
+            return false;
+
+        v8::Local<v8::Object> rect = item.As<v8::Object>();
+        double fields[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        const char *names[6] = {"id", "x", "y", "width", "height", "z"};
+
+        for (int f = 0; f < 6; f++)
+        {
+            v8::Local<v8::Value> field = rect->Get(ctx, v8::String::NewFromUtf8(isolate, names[f]).ToLocalChecked()).ToLocalChecked();
+            if (field->IsNumber())
+                fields[f] = field->NumberValue(ctx).FromMaybe(0.0);
+            else if (f < 5)
+                return false;
+        }
+
+        IL::Rectangle bounds = {static_cast<float>(fields[1]), static_cast<float>(fields[2]),
+                                static_cast<float>(fields[3]), static_cast<float>(fields[4])};
+
+        layout.push_back({static_cast<IL::InteractorId>(fields[0]), bounds, static_cast<float>(fields[5])});
+    }
+
+    return true;
+}
@@ -0,0 +1,20 @@
+/**
+ * Reading arguments shared by the JS bindings.
+ */
+
+#ifndef JSUTIL_H
+#define JSUTIL_H
+
+#include <vector>
+#include <node.h>
+#include <v8.h>
+
+#include "hittest.h"
+
+// A number from an options object, or the default.
+double Option(v8::Isolate *isolate, v8::Local<v8::Object> options, const char *name, double value);
+
+// An array of rectangles as AddRectangles takes them, false if it isn't one.
+bool ReadLayout(v8::Isolate *isolate, v8::Local<v8::Value> value, std::vector<Interactor> &layout);
+
+#endif // JSUTIL_H
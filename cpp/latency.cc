@@ -0,0 +1,98 @@
+#include "latency.h"
+
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+/**
+ * Values below 2 * SUB_BUCKETS are their own bucket. Above, the top
+ * SUB_BITS + 1 bits pick one of SUB_BUCKETS buckets for each power of two.
+ * */
+int LatencyHistogram::Bucket(uint64_t value)
+{
+    if (value < 2 * SUB_BUCKETS)
+        return static_cast<int>(value);
+
+    if (value >> (MAX_EXPONENT + 1))
+        return BUCKETS - 1;
+
+    // Position of the top bit, portable and short for latencies.
+    int exponent = SUB_BITS + 1;
+    while (value >> (exponent + 1))
+        exponent++;
+
+    int shift = exponent - SUB_BITS;
+    return static_cast<int>((shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+}
+
+// Largest value that falls in the bucket.
+uint64_t LatencyHistogram::Highest(int bucket)
+{
+    if (bucket < static_cast<int>(2 * SUB_BUCKETS))
+        return static_cast<uint64_t>(bucket);
+
+    int shift = bucket / static_cast<int>(SUB_BUCKETS) - 1;
+    uint64_t mantissa = SUB_BUCKETS + bucket % SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(int64_t us)
+{
+    uint64_t value = static_cast<uint64_t>(std::max(us, int64_t(0)));
+
+    LatencyHistogram::counts[Bucket(value)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t seen = LatencyHistogram::max.load(std::memory_order_relaxed);
+    while (value > seen && !LatencyHistogram::max.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+        ;
+}
+
+void LatencyHistogram::Reset()
+{
+    for (std::atomic<uint64_t> &count : LatencyHistogram::counts)
+        count.store(0, std::memory_order_relaxed);
+
+    LatencyHistogram::max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Percentiles are the largest value of the bucket they fall in,
+ * and never above the largest value recorded.
+ * */
+LatencySummary LatencyHistogram::Summarize() const
+{
+    uint64_t counts[BUCKETS];
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        counts[i] = LatencyHistogram::counts[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    LatencySummary summary = {};
+    summary.count = total;
+    summary.max = LatencyHistogram::max.load(std::memory_order_relaxed);
+
+    if (total == 0)
+        return summary;
+
+    const double quantiles[] = {0.5, 0.99, 0.999};
+    uint64_t *values[] = {&summary.p50, &summary.p99, &summary.p999};
+
+    int bucket = 0;
+    uint64_t seen = counts[0];
+    for (int q = 0; q < 3; q++)
+    {
+        // The rank-th smallest value, counting from 1.
+        uint64_t rank = std::max(static_cast<uint64_t>(quantiles[q] * total + 0.999999), uint64_t(1));
+        while (seen < rank && bucket < BUCKETS - 1)
+            seen += counts[++bucket];
+
+        *values[q] = std::min(Highest(bucket), summary.max);
+    }
+
+    return summary;
+}
@@ -0,0 +1,92 @@
+/**
+ * Latency histograms for the path of an event from the tracker to JS.
+ *
+ * Each stream delivered to JS is timed at three stages:
+ *
+ *   tracker to callback   the event's timestamp to entry of the native
+ *                         callback on the tracker thread
+ *   callback to queue     callback entry to the event being queued
+ *   dequeue to return     the event leaving the queue on the JS thread
+ *                         to the return of the JS callback
+ *
+ * The first stage compares tracker timestamps with the steady clock, as
+ * Stream Engine and the synthetic source both use the system's monotonic
+ * clock. It means nothing for replays, whose timestamps are from the past.
+ *
+ * Histograms are HDR style: buckets are linear up to 2 * SUB_BUCKETS
+ * microseconds and then split every power of two into SUB_BUCKETS, so
+ * any value is within 1/SUB_BUCKETS of its bucket. Recording is a
+ * relaxed atomic increment, it takes no lock on either thread.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+enum LatencyStream
+{
+    LATENCY_GAZE_FOCUS,
+    LATENCY_GAZE_POINT,
+    LATENCY_BLINK,
+    LATENCY_STREAMS
+};
+
+enum LatencyStage
+{
+    STAGE_TRACKER_TO_CALLBACK,
+    STAGE_CALLBACK_TO_QUEUE,
+    STAGE_DEQUEUE_TO_RETURN,
+    LATENCY_STAGES
+};
+
+struct LatencySummary
+{
+    uint64_t count;
+
+    // Microseconds.
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+};
+
+/**
+ * Steady clock microseconds, the clock latencies are measured with.
+ */
+inline int64_t LatencyClock()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class LatencyHistogram
+{
+public:
+    static const int SUB_BITS = 6;
+    static const uint64_t SUB_BUCKETS = 1 << SUB_BITS;
+
+    // Values from 2^MAX_EXPONENT microseconds, about 18 minutes, share the last bucket.
+    static const int MAX_EXPONENT = 30;
+    static const int BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    // Any thread, negative values count as 0.
+    void Record(int64_t us);
+
+    // Counts recorded while resetting may be lost, nothing else is.
+    void Reset();
+
+    LatencySummary Summarize() const;
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> max;
+
+    static int Bucket(uint64_t value);
+    static uint64_t Highest(int bucket);
+};
+
+#endif // LATENCY_H
@@ -0,0 +1,123 @@
+#include "layout.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+static void SkipSpace(const char *&p)
+{
+    while (*p && std::isspace(static_cast<unsigned char>(*p)))
+        p++;
+}
+
+/**
+ * One { "key": number, ... } object. Unknown keys are ignored,
+ * missing ones are 0.
+ * */
+static bool ParseInteractor(const char *&p, Interactor &interactor)
+{
+    double id = 0, x = 0, y = 0, width = 0, height = 0, z = 0;
+
+    p++;
+    SkipSpace(p);
+
+    while (*p && *p != '}')
+    {
+        if (*p != '"')
+            return false;
+
+        const char *key = ++p;
+        while (*p && *p != '"')
+            p++;
+        if (!*p)
+            return false;
+        std::string name(key, p - key);
+        p++;
+
+        SkipSpace(p);
+        if (*p != ':')
+            return false;
+        p++;
+
+        char *end;
+        double value = std::strtod(p, &end);
+        if (end == p)
+            return false;
+        p = end;
+
+        if (name == "id")
+            id = value;
+        else if (name == "x")
+            x = value;
+        else if (name == "y")
+            y = value;
+        else if (name == "width")
+            width = value;
+        else if (name == "height")
+            height = value;
+        else if (name == "z")
+            z = value;
+
+        SkipSpace(p);
+        if (*p == ',')
+        {
+            p++;
+            SkipSpace(p);
+        }
+    }
+
+    if (*p != '}')
+        return false;
+    p++;
+
+    interactor.id = static_cast<IL::InteractorId>(id);
+    interactor.bounds = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(width), static_cast<float>(height)};
+    interactor.z = static_cast<float>(z);
+    return true;
+}
+
+bool ParseLayout(const std::string &json, std::vector<Interactor> &layout)
+{
+    const char *p = json.c_str();
+
+    SkipSpace(p);
+    if (*p != '[')
+        return false;
+    p++;
+
+    while (true)
+    {
+        SkipSpace(p);
+
+        if (*p == ']')
+            return true;
+
+        if (*p != '{')
+            return false;
+
+        Interactor interactor;
+        if (!ParseInteractor(p, interactor))
+            return false;
+        layout.push_back(interactor);
+
+        SkipSpace(p);
+        if (*p == ',')
+            p++;
+    }
+}
+
+bool LoadLayout(const std::string &path, std::vector<Interactor> &layout)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    std::string json;
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        json.append(buffer, read);
+
+    std::fclose(file);
+    return ParseLayout(json, layout);
+}
@@ -0,0 +1,22 @@
+/**
+ * Interactor layouts stored as JSON, in the format AddRectangles takes:
+ *
+ *   [{ "id": 1, "x": 0, "y": 0, "width": 500, "height": 500 }, ...]
+ *
+ * Only flat objects with numeric fields are understood, which is all a
+ * layout needs, so the offline tools don't depend on a JSON library.
+ * An optional "z" orders overlapping rectangles like the IL does.
+ */
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <string>
+#include <vector>
+
+#include "hittest.h"
+
+bool ParseLayout(const std::string &json, std::vector<Interactor> &layout);
+bool LoadLayout(const std::string &path, std::vector<Interactor> &layout);
+
+#endif // LAYOUT_H
@@ -0,0 +1,174 @@
+#include "logger.h"
+
+v8::Isolate *Logger::isolate = nullptr;
+v8::Global<v8::Context> Logger::context;
+v8::Global<v8::Function> Logger::callback;
+uv_async_t Logger::async;
+bool Logger::initialized = false;
+
+std::mutex Logger::pendingLock;
+std::vector<Logging::Record> Logger::pending;
+
+void Logger::Init(v8::Local<v8::Object> exports)
+{
+    NODE_SET_METHOD(exports, "SetLogging", Logger::SetLogging);
+}
+
+/**
+ * Level by name or IL::LoggingLevel number, false if it is neither.
+ * */
+bool Logger::SetLevel(v8::Isolate *isolate, v8::Local<v8::Value> value)
+{
+    if (value->IsNumber())
+    {
+        int level = static_cast<int>(value.As<v8::Number>()->Value());
+        if (level < IL_LoggingLevel_Error || level > IL_LoggingLevel_Trace)
+            return false;
+
+        Logging::SetLevel(static_cast<IL_LoggingLevel>(level));
+        return true;
+    }
+
+    if (!value->IsString())
+        return false;
+
+    std::string name = *v8::String::Utf8Value(isolate, value);
+    for (int level = IL_LoggingLevel_Error; level <= IL_LoggingLevel_Trace; level++)
+    {
+        if (name == Logging::Name(static_cast<IL_LoggingLevel>(level)))
+        {
+            Logging::SetLevel(static_cast<IL_LoggingLevel>(level));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Change where the log goes and what is logged. Options left out stay
+ * as they are.
+ *
+ * params
+ * options    object
+ *   level      'error', 'warn', 'info' (default), 'debug' or 'trace', or 0 to 4
+ *   file       path to append to, null to stop
+ *   callback   called with (level, message, time in ms), null to stop
+ *
+ * Returns false if the file can't be opened.
+ * */
+void Logger::SetLogging(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    if (!args[0]->IsObject())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be an object of { level, file, callback }");
+        return;
+    }
+
+    v8::Local<v8::Object> options = args[0].As<v8::Object>();
+    auto get = [&](const char *name)
+    {
+        return options->Get(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked()).ToLocalChecked();
+    };
+
+    v8::Local<v8::Value> level = get("level");
+    if (!level->IsUndefined() && !SetLevel(isolate, level))
+        Logging::Write(IL_LoggingLevel_Error, "level must be one of error, warn, info, debug or trace");
+
+    bool ok = true;
+    v8::Local<v8::Value> file = get("file");
+    if (file->IsString())
+        ok = Logging::SetFile(*v8::String::Utf8Value(isolate, file));
+    else if (file->IsNull())
+        Logging::SetFile("");
+
+    v8::Local<v8::Value> function = get("callback");
+    if (function->IsFunction())
+    {
+        if (!Logger::initialized)
+        {
+            Logger::initialized = true;
+            Logger::isolate = isolate;
+            uv_async_init(node::GetCurrentEventLoop(isolate), &Logger::async, Logger::Dispatch);
+            uv_unref(reinterpret_cast<uv_handle_t *>(&Logger::async));
+            node::AddEnvironmentCleanupHook(isolate, Logger::Cleanup, nullptr);
+        }
+
+        Logger::context.Reset(isolate, ctx);
+        Logger::callback.Reset(isolate, function.As<v8::Function>());
+        Logging::SetSink(Logger::Sink, nullptr);
+    }
+    else if (function->IsNull())
+    {
+        Logging::SetSink(nullptr, nullptr);
+        Logger::callback.Reset();
+    }
+
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, ok));
+}
+
+/**
+ * Called on the drain thread.
+ * */
+void Logger::Sink(const Logging::Record &record, void *context)
+{
+    {
+        std::lock_guard<std::mutex> guard(Logger::pendingLock);
+        if (Logger::pending.size() == MAX_PENDING)
+            return;
+
+        Logger::pending.push_back(record);
+    }
+
+    uv_async_send(&Logger::async);
+}
+
+void Logger::Dispatch(uv_async_t *handle)
+{
+    std::vector<Logging::Record> records;
+    {
+        std::lock_guard<std::mutex> guard(Logger::pendingLock);
+        records.swap(Logger::pending);
+    }
+
+    if (Logger::callback.IsEmpty())
+        return;
+
+    v8::Isolate *isolate = Logger::isolate;
+    v8::HandleScope handle_scope(isolate);
+
+    v8::Local<v8::Context> ctx = Logger::context.Get(isolate);
+    v8::Context::Scope context_scope(ctx);
+
+    for (const Logging::Record &record : records)
+    {
+        v8::HandleScope scope(isolate);
+        const unsigned int argc = 3;
+
+        v8::Local<v8::Value> argv[argc] = {
+            v8::String::NewFromUtf8(isolate, Logging::Name(record.level)).ToLocalChecked(),
+            v8::String::NewFromUtf8(isolate, record.message).ToLocalChecked(),
+            v8::Number::New(isolate, static_cast<double>(record.time_ms))};
+
+        node::MakeCallback(isolate, ctx->Global(), Logger::callback.Get(isolate), argc, argv, {0, 0});
+
+        // The callback may have removed itself.
+        if (Logger::callback.IsEmpty())
+            return;
+    }
+}
+
+/**
+ * The environment is going away, messages still to come go to stdout.
+ * */
+void Logger::Cleanup(void *arg)
+{
+    Logging::SetSink(nullptr, nullptr);
+
+    Logger::callback.Reset();
+    Logger::context.Reset();
+    uv_close(reinterpret_cast<uv_handle_t *>(&Logger::async), nullptr);
+}
@@ -0,0 +1,49 @@
+/**
+ * JS binding of the log, see logging.h:
+ *
+ *   Screen.SetLogging({ level: 'debug', file: 'focus.log', callback: (level, message, time) => { ... } });
+ *
+ * The callback is called on the JS thread with the messages the drain
+ * thread handed over since the last call, it doesn't keep the process
+ * alive.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <node.h>
+#include <v8.h>
+#include <uv.h>
+
+#include "logging.h"
+
+class Logger
+{
+private:
+    // Records waiting for the JS thread, beyond this they are dropped.
+    static const size_t MAX_PENDING = 4096;
+
+    static v8::Isolate *isolate;
+    static v8::Global<v8::Context> context;
+    static v8::Global<v8::Function> callback;
+    static uv_async_t async;
+    static bool initialized;
+
+    static std::mutex pendingLock;
+    static std::vector<Logging::Record> pending;
+
+    static void SetLogging(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static bool SetLevel(v8::Isolate *isolate, v8::Local<v8::Value> value);
+
+    static void Sink(const Logging::Record &record, void *context);
+    static void Dispatch(uv_async_t *handle);
+    static void Cleanup(void *arg);
+
+public:
+    static void Init(v8::Local<v8::Object> exports);
+};
+
+#endif // LOGGER_H
@@ -0,0 +1,203 @@
+#include "logging.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+#include "ring.h"
+
+// How often the drain thread looks at the ring, producers never wake it.
+static const std::chrono::milliseconds DRAIN_INTERVAL(20);
+
+static const char *NAMES[] = {"error", "warn", "info", "debug", "trace"};
+
+/**
+ * The drain thread and where it writes to. Started by the first
+ * message, stopped at exit after writing what is left.
+ */
+struct Drain
+{
+    MpscRing<Logging::Record, Logging::RING_RECORDS> ring;
+    std::atomic<uint64_t> dropped{0};
+    uint64_t reported = 0;
+
+    std::once_flag started;
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool closing = false;
+
+    // Under lock.
+    std::FILE *file = nullptr;
+    Logging::Sink sink = nullptr;
+    void *context = nullptr;
+
+    void Start()
+    {
+        std::call_once(started, [this]()
+                       { thread = std::thread(&Drain::Run, this); });
+    }
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        while (true)
+        {
+            bool stop = wake.wait_for(guard, DRAIN_INTERVAL, [this] { return closing; });
+
+            Logging::Record record;
+            bool wrote = false;
+            while (ring.Pop(record))
+            {
+                Write(record);
+                wrote = true;
+            }
+
+            // Say so when messages were lost, once the ring has room again.
+            uint64_t lost = dropped.load(std::memory_order_relaxed);
+            if (lost != reported)
+            {
+                record.level = IL_LoggingLevel_Warn;
+                record.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                std::snprintf(record.message, sizeof(record.message), "%llu log messages dropped", static_cast<unsigned long long>(lost - reported));
+                Write(record);
+                reported = lost;
+                wrote = true;
+            }
+
+            if (wrote && file)
+                std::fflush(file);
+            if (wrote && !file && !sink)
+                std::fflush(stdout);
+
+            if (stop)
+                return;
+        }
+    }
+
+    void Write(const Logging::Record &record)
+    {
+        if (sink)
+            sink(record, context);
+
+        if (!file)
+        {
+            if (!sink)
+                std::fprintf(stdout, "%s\n", record.message);
+            return;
+        }
+
+        std::time_t seconds = static_cast<std::time_t>(record.time_ms / 1000);
+        std::tm utc;
+#ifdef _WIN32
+        gmtime_s(&utc, &seconds);
+#else
+        gmtime_r(&seconds, &utc);
+#endif
+
+        char time[32];
+        std::strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%S", &utc);
+        std::fprintf(file, "%s.%03dZ %-5s %s\n", time, static_cast<int>(record.time_ms % 1000), Logging::Name(record.level), record.message);
+    }
+
+    ~Drain()
+    {
+        if (!thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closing = true;
+        }
+        wake.notify_one();
+        thread.join();
+
+        if (file)
+            std::fclose(file);
+    }
+};
+
+static Drain drain;
+
+static IL_Logger ilLogger = {nullptr, IL_LoggingLevel_Trace, nullptr};
+
+std::atomic<int> Logging::level(IL_LoggingLevel_Info);
+
+void Logging::SetLevel(IL_LoggingLevel level)
+{
+    Logging::level = level;
+}
+
+IL_LoggingLevel Logging::Level()
+{
+    return static_cast<IL_LoggingLevel>(Logging::level.load());
+}
+
+void Logging::Write(IL_LoggingLevel level, const char *format, ...)
+{
+    if (!Enabled(level))
+        return;
+
+    Record record;
+    record.level = level;
+    record.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(record.message, sizeof(record.message), format, args);
+    va_end(args);
+
+    drain.Start();
+
+    if (!drain.ring.Push(record))
+        drain.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Logging::SetFile(const std::string &path)
+{
+    std::FILE *file = nullptr;
+    if (!path.empty())
+    {
+        file = std::fopen(path.c_str(), "a");
+        if (!file)
+            return false;
+    }
+
+    drain.Start();
+
+    std::lock_guard<std::mutex> guard(drain.lock);
+    if (drain.file)
+        std::fclose(drain.file);
+    drain.file = file;
+    return true;
+}
+
+void Logging::SetSink(Sink sink, void *context)
+{
+    drain.Start();
+
+    std::lock_guard<std::mutex> guard(drain.lock);
+    drain.sink = sink;
+    drain.context = context;
+}
+
+IL_Logger *Logging::ILLogger()
+{
+    ilLogger.callback = Logging::OnILLog;
+    return &ilLogger;
+}
+
+const char *Logging::Name(IL_LoggingLevel level)
+{
+    return level >= IL_LoggingLevel_Error && level <= IL_LoggingLevel_Trace ? NAMES[level] : "";
+}
+
+void Logging::OnILLog(IL_LoggingLevel level, const char *text, void *context)
+{
+    Write(level, "IL: %s", text);
+}
@@ -0,0 +1,73 @@
+/**
+ * Process-wide asynchronous log of the addon and the interaction
+ * library.
+ *
+ * Writing a message formats it into a fixed size record and pushes it
+ * into a lock-free ring, from any thread, so the tracker thread never
+ * waits on the console or a disk. Messages below the level are not
+ * formatted at all, and messages that find the ring full are dropped
+ * and counted in a warning. A background thread drains the ring to the
+ * log file and the sink, or to stdout when neither is set.
+ *
+ * The IL logs through ILLogger(). Its level is fixed when the IL is
+ * created, so it is created logging everything and filtered here.
+ */
+
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <interaction_lib/InteractionLib.h>
+
+#if defined(__GNUC__)
+#define LOGGING_FORMAT(string, first) __attribute__((format(printf, string, first)))
+#else
+#define LOGGING_FORMAT(string, first)
+#endif
+
+class Logging
+{
+public:
+    static const size_t RING_RECORDS = 1024;
+    static const size_t MESSAGE_SIZE = 256;
+
+    struct Record
+    {
+        IL_LoggingLevel level;
+
+        // Wall clock, milliseconds since the epoch.
+        int64_t time_ms;
+
+        // Cut short to fit.
+        char message[MESSAGE_SIZE];
+    };
+
+    // Called on the drain thread for every record.
+    typedef void (*Sink)(const Record &record, void *context);
+
+    static bool Enabled(IL_LoggingLevel level) { return level <= Logging::level.load(std::memory_order_relaxed); }
+
+    static void SetLevel(IL_LoggingLevel level);
+    static IL_LoggingLevel Level();
+
+    static void Write(IL_LoggingLevel level, const char *format, ...) LOGGING_FORMAT(2, 3);
+
+    // Append to a file as well, an empty path closes it. False if it can't be opened.
+    static bool SetFile(const std::string &path);
+
+    static void SetSink(Sink sink, void *context);
+
+    // For CreateInteractionLib.
+    static IL_Logger *ILLogger();
+
+    static const char *Name(IL_LoggingLevel level);
+
+private:
+    static std::atomic<int> level;
+
+    static void OnILLog(IL_LoggingLevel level, const char *text, void *context);
+};
+
+#endif // LOGGING_H
@@ -5,12 +5,24 @@
 #include <interaction_lib/misc/InteractionLibPtr.h>
 
 #include "screen.h"
+#include "estimator.h"
+#include "broadcastfile.h"
+#include "interactortablefile.h"
+#include "recordingfile.h"
+#include "tracer.h"
+#include "logger.h"
 
 using namespace v8;
 
 void Initialize(Local<Object> exports)
 {
     Screen::Init(exports);
+    RecordingFile::Init(exports);
+    BroadcastFile::Init(exports);
+    InteractorTableFile::Init(exports);
+    Estimator::Init(exports);
+    Tracer::Init(exports);
+    Logger::Init(exports);
 }
 
 NODE_MODULE(NODE_GYP_MODULE_NAME, Initialize)
@@ -0,0 +1,200 @@
+/**
+ * Shared memory segments by name, shm_open or a named file mapping on
+ * Windows. One process creates a segment read-write, others map it
+ * read-only. Used by the broadcast and the interactor table.
+ *
+ * Creating a name that is in use fails. On POSIX the creator holds an
+ * flock on the segment for as long as it has it open, the kernel drops
+ * the lock when the process dies, so a segment whose lock is free was
+ * left behind by a crash and is replaced.
+ */
+
+#ifndef MAPPING_H
+#define MAPPING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class SharedMapping
+{
+public:
+    SharedMapping() : data(nullptr), size(0)
+    {
+#ifdef _WIN32
+        SharedMapping::mapping = nullptr;
+#else
+        SharedMapping::fd = -1;
+#endif
+    }
+
+    ~SharedMapping() { Close(); }
+
+    SharedMapping(const SharedMapping &) = delete;
+    SharedMapping &operator=(const SharedMapping &) = delete;
+
+    bool Create(const std::string &name, size_t size)
+    {
+#ifdef _WIN32
+        SharedMapping::mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                                       static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size),
+                                                       ("Local\\" + name).c_str());
+        if (!SharedMapping::mapping)
+            return false;
+
+        // Mappings go away with their last handle, one that exists is in use.
+        if (GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            CloseHandle(SharedMapping::mapping);
+            SharedMapping::mapping = nullptr;
+            return false;
+        }
+
+        SharedMapping::data = static_cast<char *>(MapViewOfFile(SharedMapping::mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+#else
+        std::string path = "/" + name;
+
+        int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 && errno == EEXIST && Reclaim(path))
+            fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+            return false;
+
+        // Locked before it has a size, see Reclaim.
+        void *data = MAP_FAILED;
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0 && ftruncate(fd, static_cast<off_t>(size)) == 0)
+            data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            shm_unlink(path.c_str());
+            return false;
+        }
+
+        SharedMapping::fd = fd;
+        SharedMapping::data = static_cast<char *>(data);
+        SharedMapping::name = path;
+#endif
+        SharedMapping::size = size;
+        return SharedMapping::data != nullptr;
+    }
+
+    bool Open(const std::string &name)
+    {
+#ifdef _WIN32
+        SharedMapping::mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, ("Local\\" + name).c_str());
+        if (!SharedMapping::mapping)
+            return false;
+
+        SharedMapping::data = static_cast<char *>(MapViewOfFile(SharedMapping::mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!SharedMapping::data)
+            return false;
+
+        MEMORY_BASIC_INFORMATION info;
+        if (!VirtualQuery(SharedMapping::data, &info, sizeof(info)))
+            return false;
+        SharedMapping::size = info.RegionSize;
+#else
+        int fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        void *data = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+            data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED)
+            return false;
+
+        SharedMapping::data = static_cast<char *>(data);
+        SharedMapping::size = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    // Remove the name so no one else can open it, the mapping stays.
+    // Only the creator has a name to remove.
+    void Unlink()
+    {
+#ifndef _WIN32
+        if (!SharedMapping::name.empty())
+            shm_unlink(SharedMapping::name.c_str());
+        SharedMapping::name.clear();
+#endif
+    }
+
+    void Close()
+    {
+        Unlink();
+
+#ifdef _WIN32
+        if (SharedMapping::data)
+            UnmapViewOfFile(SharedMapping::data);
+        if (SharedMapping::mapping)
+            CloseHandle(SharedMapping::mapping);
+        SharedMapping::mapping = nullptr;
+#else
+        if (SharedMapping::data)
+            munmap(SharedMapping::data, SharedMapping::size);
+        if (SharedMapping::fd >= 0)
+            close(SharedMapping::fd);
+        SharedMapping::fd = -1;
+#endif
+        SharedMapping::data = nullptr;
+        SharedMapping::size = 0;
+    }
+
+    char *Data() const { return SharedMapping::data; }
+    size_t Size() const { return SharedMapping::size; }
+
+private:
+    char *data;
+    size_t size;
+
+#ifdef _WIN32
+    HANDLE mapping;
+#else
+    std::string name;
+
+    // Kept open by the creator to hold the lock.
+    int fd;
+
+    /**
+     * Remove a segment whose creator is gone: it has a size, so the
+     * creator had locked it, and the lock is free. Holding the lock while
+     * removing it keeps another process from reclaiming the same name.
+     * */
+    static bool Reclaim(const std::string &path)
+    {
+        int fd = shm_open(path.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            return errno == ENOENT;
+
+        struct stat info;
+        bool stale = fstat(fd, &info) == 0 && info.st_size > 0 && flock(fd, LOCK_EX | LOCK_NB) == 0;
+        if (stale)
+            shm_unlink(path.c_str());
+
+        close(fd);
+        return stale;
+    }
+#endif
+};
+
+#endif // MAPPING_H
@@ -0,0 +1,131 @@
+#include "pool.h"
+
+thread_local int WorkPool::self = -1;
+thread_local WorkPool *WorkPool::owner = nullptr;
+
+WorkPool::WorkPool(unsigned threads)
+    : queued(0), pending(0), next(0)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    WorkPool::stopping = false;
+
+    for (unsigned i = 0; i < threads; i++)
+        WorkPool::queues.emplace_back(new Queue());
+
+    for (unsigned i = 0; i < threads; i++)
+        WorkPool::workers.emplace_back(&WorkPool::Run, this, i);
+}
+
+WorkPool::~WorkPool()
+{
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> guard(WorkPool::idleLock);
+        WorkPool::stopping = true;
+    }
+    WorkPool::idle.notify_all();
+
+    for (std::thread &worker : WorkPool::workers)
+        worker.join();
+}
+
+unsigned WorkPool::Threads() const
+{
+    return static_cast<unsigned>(WorkPool::workers.size());
+}
+
+void WorkPool::Submit(Task task)
+{
+    // Workers keep their own work, other threads spread it round robin.
+    unsigned index = WorkPool::owner == this ? static_cast<unsigned>(WorkPool::self)
+                                             : WorkPool::next.fetch_add(1, std::memory_order_relaxed) % WorkPool::queues.size();
+
+    WorkPool::pending.fetch_add(1);
+
+    // Counted under the queue lock, a worker can't take the task and
+    // count it out before it is counted in.
+    {
+        std::lock_guard<std::mutex> guard(WorkPool::queues[index]->lock);
+        WorkPool::queues[index]->tasks.push_back(std::move(task));
+        WorkPool::queued.fetch_add(1);
+    }
+
+    // A worker checks the count under idleLock before it waits, taking it
+    // here means the worker either sees the task or gets the notify.
+    {
+        std::lock_guard<std::mutex> guard(WorkPool::idleLock);
+    }
+    WorkPool::idle.notify_one();
+}
+
+void WorkPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(WorkPool::idleLock);
+    WorkPool::done.wait(lock, [this] { return WorkPool::pending.load() == 0; });
+}
+
+/**
+ * Newest task of our own deque, else the oldest one of somebody else's.
+ * */
+bool WorkPool::Take(unsigned index, Task &task)
+{
+    size_t count = WorkPool::queues.size();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        Queue &queue = *WorkPool::queues[(index + i) % count];
+        std::lock_guard<std::mutex> guard(queue.lock);
+
+        if (queue.tasks.empty())
+            continue;
+
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        WorkPool::queued.fetch_sub(1);
+        return true;
+    }
+
+    return false;
+}
+
+void WorkPool::Run(unsigned index)
+{
+    WorkPool::self = static_cast<int>(index);
+    WorkPool::owner = this;
+
+    while (true)
+    {
+        Task task;
+        if (Take(index, task))
+        {
+            task();
+
+            if (WorkPool::pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> guard(WorkPool::idleLock);
+                WorkPool::done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(WorkPool::idleLock);
+        WorkPool::idle.wait(lock, [this] { return WorkPool::stopping || WorkPool::queued.load() > 0; });
+
+        if (WorkPool::stopping)
+            return;
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * Work-stealing thread pool for the offline tools.
+ *
+ * Every worker has its own deque. Tasks submitted from a worker go to
+ * the back of its deque and it takes them back LIFO, which keeps the
+ * data of a file it just opened hot in its cache. Idle workers steal
+ * from the front of the other deques, i.e. the oldest and usually the
+ * largest pieces of work.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    // 0 threads uses one per hardware thread.
+    explicit WorkPool(unsigned threads = 0);
+    ~WorkPool();
+
+    unsigned Threads() const;
+
+    // Callable from any thread, including from inside a task.
+    void Submit(Task task);
+
+    // Block until every submitted task, and the tasks they submitted, ran.
+    void Wait();
+
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    // Tasks sitting in queues, and tasks not finished yet.
+    std::atomic<size_t> queued;
+    std::atomic<size_t> pending;
+    std::atomic<unsigned> next;
+    bool stopping;
+
+    std::mutex idleLock;
+    std::condition_variable idle;
+    std::condition_variable done;
+
+    // Worker the current thread is, -1 outside the pool.
+    static thread_local int self;
+    static thread_local WorkPool *owner;
+
+    void Run(unsigned index);
+    bool Take(unsigned index, Task &task);
+};
+
+#endif // POOL_H
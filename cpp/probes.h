@@ -0,0 +1,40 @@
+/**
+ * Statically defined tracepoints at the stages of the pipeline, for
+ * perf and bpftrace on Linux, under the provider "focus":
+ *
+ *   sample(stream, id, timestamp_us, arrival_us)       IL callback entered
+ *   filter(stream, timestamp_us, output_us)             filter emitted an event
+ *   enqueue(stream, timestamp_us, enqueued_us)          pushed into the JS ring
+ *   dequeue(stream, timestamp_us, dequeued_us)          popped on the JS thread
+ *   dispatch(stream, timestamp_us, dequeued_us, returned_us)   JS callback returned
+ *   commit(count, begin_us, end_us)                     interactors committed to the IL
+ *
+ * stream is a LatencyStream, id the interactor of a focus event, and
+ * every _us argument is LatencyClock(). A sample is followed through
+ * the stages by its stream and device timestamp, see bpftrace/.
+ *
+ * With <sys/sdt.h> (systemtap-sdt-dev) each probe is a nop and a note
+ * in the binary until a tracer attaches, without it probes compile to
+ * nothing. The arguments are values the pipeline has at hand anyway.
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define FOCUS_PROBES 1
+#endif
+#endif
+
+#ifdef FOCUS_PROBES
+#define FOCUS_PROBE3(name, a, b, c) DTRACE_PROBE3(focus, name, a, b, c)
+#define FOCUS_PROBE4(name, a, b, c, d) DTRACE_PROBE4(focus, name, a, b, c, d)
+#else
+// Not evaluated, only keeps the arguments used.
+#define FOCUS_PROBE3(name, a, b, c) ((void)sizeof(a), (void)sizeof(b), (void)sizeof(c))
+#define FOCUS_PROBE4(name, a, b, c, d) ((void)sizeof(a), (void)sizeof(b), (void)sizeof(c), (void)sizeof(d))
+#endif
+
+#endif // PROBES_H
@@ -0,0 +1,194 @@
+#include "quality.h"
+
+#include <cmath>
+
+const IL::Timestamp QualityMonitor::INTERVAL_BOUNDS_US[] = {
+    2000, 4000, 6000, 8000, 10000, 12000, 14000, 17000, 20000, 34000, 100000};
+
+RunningStats::RunningStats()
+{
+    Reset();
+}
+
+void RunningStats::Reset()
+{
+    RunningStats::n = 0.0;
+    RunningStats::mean = 0.0;
+    RunningStats::m2 = 0.0;
+}
+
+void RunningStats::Add(double x)
+{
+    n += 1.0;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+}
+
+/**
+ * Inverse of Add, for values leaving the window.
+ * */
+void RunningStats::Remove(double x)
+{
+    if (n <= 1.0)
+    {
+        Reset();
+        return;
+    }
+
+    n -= 1.0;
+    double delta = x - mean;
+    mean -= delta / n;
+    m2 -= delta * (x - mean);
+
+    // Rounding can push m2 slightly below zero.
+    if (m2 < 0.0)
+        m2 = 0.0;
+}
+
+/**
+ * Chan et al. pairwise update, the result is the same as if
+ * every value had been added here.
+ * */
+void RunningStats::Merge(const RunningStats &other)
+{
+    if (other.n == 0.0)
+        return;
+
+    double total = n + other.n;
+    double delta = other.mean - mean;
+
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * n * other.n / total;
+    n = total;
+}
+
+double RunningStats::Variance() const
+{
+    return n > 1.0 ? m2 / (n - 1.0) : 0.0;
+}
+
+QualityMonitor::QualityMonitor(IL::Timestamp window_us)
+{
+    QualityMonitor::window_us = window_us;
+    Reset();
+}
+
+void QualityMonitor::Reset()
+{
+    window.clear();
+    invalid = 0;
+    x.Reset();
+    y.Reset();
+    steps.Reset();
+    intervals.Reset();
+
+    for (int i = 0; i < QualityStats::INTERVAL_BUCKETS; i++)
+        buckets[i] = 0;
+}
+
+void QualityMonitor::OnGazePoint(const IL::GazePointData &evt)
+{
+    Sample sample = {};
+    sample.timestamp_us = evt.timestamp_us;
+    sample.valid = evt.validity == IL::Validity::Valid;
+    sample.x = evt.x;
+    sample.y = evt.y;
+
+    if (!window.empty())
+    {
+        const Sample &last = window.back();
+
+        sample.hasInterval = true;
+        sample.interval = static_cast<double>(evt.timestamp_us - last.timestamp_us);
+
+        int bucket = Bucket(sample.interval);
+        sample.bucket = bucket;
+
+        intervals.Add(sample.interval);
+        buckets[bucket]++;
+
+        // Sample to sample precision only between two valid samples.
+        if (sample.valid && last.valid)
+        {
+            double dx = sample.x - last.x;
+            double dy = sample.y - last.y;
+
+            sample.hasStep = true;
+            sample.step2 = dx * dx + dy * dy;
+            steps.Add(sample.step2);
+        }
+    }
+
+    if (sample.valid)
+    {
+        x.Add(sample.x);
+        y.Add(sample.y);
+    }
+    else
+    {
+        invalid++;
+    }
+
+    window.push_back(sample);
+
+    // Drop whatever fell out of the window.
+    while (window.front().timestamp_us < evt.timestamp_us - window_us)
+    {
+        Remove(window.front());
+        window.pop_front();
+    }
+}
+
+int QualityMonitor::Bucket(double interval_us)
+{
+    int bucket = 0;
+    while (bucket < QualityStats::INTERVAL_BUCKETS - 1 && interval_us >= INTERVAL_BOUNDS_US[bucket])
+        bucket++;
+
+    return bucket;
+}
+
+void QualityMonitor::Remove(const Sample &sample)
+{
+    if (sample.hasInterval)
+    {
+        intervals.Remove(sample.interval);
+        buckets[sample.bucket]--;
+    }
+
+    if (sample.hasStep)
+        steps.Remove(sample.step2);
+
+    if (sample.valid)
+    {
+        x.Remove(sample.x);
+        y.Remove(sample.y);
+    }
+    else
+    {
+        invalid--;
+    }
+}
+
+QualityStats QualityMonitor::Stats() const
+{
+    QualityStats stats = {};
+
+    stats.samples = static_cast<unsigned int>(window.size());
+    stats.dataLoss = stats.samples ? static_cast<double>(invalid) / stats.samples : 0.0;
+
+    stats.precisionRms = std::sqrt(steps.Mean());
+
+    stats.sdX = std::sqrt(x.Variance());
+    stats.sdY = std::sqrt(y.Variance());
+    stats.sd = std::sqrt(x.Variance() + y.Variance());
+
+    stats.intervalMean = intervals.Mean();
+    stats.intervalSd = std::sqrt(intervals.Variance());
+
+    for (int i = 0; i < QualityStats::INTERVAL_BUCKETS; i++)
+        stats.intervals[i] = buckets[i];
+
+    return stats;
+}
@@ -0,0 +1,111 @@
+/**
+ * Running data quality metrics over a sliding time window of the
+ * gaze point stream.
+ *
+ * Each metric is kept as a running accumulator that samples are added
+ * to on arrival and removed from when they fall out of the window,
+ * so a sample costs O(1) no matter how long the window is.
+ */
+
+#ifndef QUALITY_H
+#define QUALITY_H
+
+#include <deque>
+#include <interaction_lib/InteractionLib.h>
+
+/**
+ * Welford mean and variance that also supports removing values.
+ */
+class RunningStats
+{
+private:
+    double n;
+    double mean;
+    double m2;
+
+public:
+    RunningStats();
+
+    void Add(double x);
+    void Remove(double x);
+    void Reset();
+
+    // Combine with stats collected separately, e.g. on another thread.
+    void Merge(const RunningStats &other);
+
+    double Count() const { return n; }
+    double Mean() const { return mean; }
+    double Variance() const;
+};
+
+struct QualityStats
+{
+    // Samples in the window, and the share of them that were invalid.
+    unsigned int samples;
+    double dataLoss;
+
+    // RMS of the distance between consecutive valid samples.
+    double precisionRms;
+
+    // Standard deviation of the valid gaze positions.
+    double sdX;
+    double sdY;
+    double sd;
+
+    // Time between consecutive samples, in microseconds.
+    double intervalMean;
+    double intervalSd;
+
+    static const int INTERVAL_BUCKETS = 12;
+
+    // Interval histogram, see QualityMonitor::INTERVAL_BOUNDS_US.
+    unsigned int intervals[INTERVAL_BUCKETS];
+};
+
+class QualityMonitor
+{
+private:
+    struct Sample
+    {
+        IL::Timestamp timestamp_us;
+        bool valid;
+        float x, y;
+
+        // Contributions made when the sample was added, undone on removal.
+        bool hasInterval;
+        double interval;
+        int bucket;
+        bool hasStep;
+        double step2;
+    };
+
+    IL::Timestamp window_us;
+    std::deque<Sample> window;
+
+    unsigned int invalid;
+    RunningStats x;
+    RunningStats y;
+    RunningStats steps;
+    RunningStats intervals;
+    unsigned int buckets[QualityStats::INTERVAL_BUCKETS];
+
+    void Remove(const Sample &sample);
+
+public:
+    // Upper bounds of the interval histogram buckets, the last one is open.
+    static const IL::Timestamp INTERVAL_BOUNDS_US[QualityStats::INTERVAL_BUCKETS - 1];
+
+    static const IL::Timestamp DEFAULT_WINDOW_US = 1000000;
+
+    // Histogram bucket of an interval.
+    static int Bucket(double interval_us);
+
+    QualityMonitor(IL::Timestamp window_us = DEFAULT_WINDOW_US);
+
+    void OnGazePoint(const IL::GazePointData &evt);
+    void Reset();
+
+    QualityStats Stats() const;
+};
+
+#endif // QUALITY_H
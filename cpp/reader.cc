@@ -0,0 +1,534 @@
+#include "reader.h"
+#include "codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+    MappedFile::data = nullptr;
+    MappedFile::size = 0;
+
+#ifdef _WIN32
+    MappedFile::file = INVALID_HANDLE_VALUE;
+    MappedFile::mapping = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (MappedFile::data)
+        UnmapViewOfFile(MappedFile::data);
+    if (MappedFile::mapping)
+        CloseHandle(MappedFile::mapping);
+    if (MappedFile::file != INVALID_HANDLE_VALUE)
+        CloseHandle(MappedFile::file);
+#else
+    if (MappedFile::data)
+        munmap(MappedFile::data, MappedFile::size);
+#endif
+}
+
+/**
+ * Map the file copy on write, so the pages can be handed to JS
+ * as ArrayBuffers without JS writes ever reaching the file.
+ * */
+bool MappedFile::Open(const std::string &path)
+{
+#ifdef _WIN32
+    MappedFile::file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (MappedFile::file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(MappedFile::file, &size) || size.QuadPart == 0)
+        return false;
+
+    MappedFile::mapping = CreateFileMappingA(MappedFile::file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (!MappedFile::mapping)
+        return false;
+
+    MappedFile::data = static_cast<char *>(MapViewOfFile(MappedFile::mapping, FILE_MAP_COPY, 0, 0, 0));
+    if (!MappedFile::data)
+        return false;
+
+    MappedFile::size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    MappedFile::data = static_cast<char *>(data);
+    MappedFile::size = static_cast<size_t>(st.st_size);
+#endif
+
+    return true;
+}
+
+const char *MappedFile::Data() const
+{
+    return MappedFile::data;
+}
+
+size_t MappedFile::Size() const
+{
+    return MappedFile::size;
+}
+
+RecordingReader::RecordingReader()
+{
+    RecordingReader::compressed = false;
+    RecordingReader::cachedEntry = nullptr;
+    RecordingReader::damaged = 0;
+
+    for (uint32_t i = 0; i < RECORD_TYPES; i++)
+        RecordingReader::cursor[i] = {0, 0};
+}
+
+/**
+ * Map the file and read its header and index, nothing else.
+ * */
+bool RecordingReader::Open(const std::string &path)
+{
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    if (!file->Open(path))
+        return false;
+
+    const char *data = file->Data();
+    size_t size = file->Size();
+
+    RecordingHeader header;
+    if (size < sizeof(header))
+        return false;
+
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) != 0 ||
+        (header.version != RECORDING_VERSION && header.version != RECORDING_VERSION_COMPRESSED))
+        return false;
+
+    size_t begin = sizeof(header) + static_cast<size_t>(header.streams) * sizeof(StreamDescriptor);
+    if (size < begin)
+        return false;
+
+    RecordingReader::file = file;
+    RecordingReader::compressed = header.version == RECORDING_VERSION_COMPRESSED;
+
+    for (uint32_t i = 0; i < header.streams; i++)
+    {
+        StreamDescriptor descriptor;
+        std::memcpy(&descriptor, data + sizeof(header) + i * sizeof(descriptor), sizeof(descriptor));
+
+        if (descriptor.type >= RecordingReader::sizes.size())
+            RecordingReader::sizes.resize(descriptor.type + 1, 0);
+        RecordingReader::sizes[descriptor.type] = descriptor.size;
+    }
+
+    if (!LoadIndex(begin))
+        ScanChunks(begin);
+
+    return true;
+}
+
+/**
+ * Take the block index from the footer. Returns false if there is
+ * none, or it does not fit the file.
+ * */
+bool RecordingReader::LoadIndex(size_t begin)
+{
+    const char *data = RecordingReader::file->Data();
+    size_t size = RecordingReader::file->Size();
+
+    RecordingFooter footer;
+    if (size < begin + sizeof(footer))
+        return false;
+
+    std::memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+    if (std::memcmp(footer.magic, INDEX_MAGIC, sizeof(footer.magic)) != 0)
+        return false;
+
+    size_t header = RecordingReader::compressed ? sizeof(EncodedChunkHeader) : sizeof(ChunkHeader);
+    if (footer.index < begin || footer.entries > size ||
+        footer.index + header + footer.entries * sizeof(IndexEntry) + sizeof(footer) != size)
+        return false;
+
+    const char *entries = data + footer.index + header;
+    for (uint64_t i = 0; i < footer.entries; i++)
+    {
+        IndexEntry entry;
+        std::memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+        Add(entry);
+    }
+
+    return true;
+}
+
+/**
+ * Build the index by walking the chunk headers, for files without one.
+ * Compressed blocks have to be decoded for their last timestamp.
+ * */
+void RecordingReader::ScanChunks(size_t begin)
+{
+    const char *data = RecordingReader::file->Data();
+    size_t size = RecordingReader::file->Size();
+    size_t offset = begin;
+
+    std::vector<char> decoded;
+
+    while (true)
+    {
+        IndexEntry entry = {};
+        entry.offset = offset;
+
+        if (RecordingReader::compressed)
+        {
+            EncodedChunkHeader chunk;
+            if (size - offset < sizeof(chunk))
+                break;
+            std::memcpy(&chunk, data + offset, sizeof(chunk));
+
+            if (chunk.type == INDEX_CHUNK || size - offset - sizeof(chunk) < chunk.bytes)
+                break;
+
+            uint32_t record = chunk.type < RecordingReader::sizes.size() ? RecordingReader::sizes[chunk.type] : 0;
+            if (chunk.count > 0 && record > 0 && record == RecordSize(chunk.type))
+            {
+                decoded.resize(static_cast<size_t>(record) * chunk.count);
+                if (!DecodeBlock(chunk.type, reinterpret_cast<const uint8_t *>(data + offset + sizeof(chunk)), chunk.bytes, chunk.count, decoded.data()))
+                    break;
+
+                entry.type = chunk.type;
+                entry.count = chunk.count;
+                entry.first_us = RecordTimestamp(decoded.data());
+                entry.last_us = RecordTimestamp(decoded.data() + (chunk.count - 1) * record);
+                Add(entry);
+            }
+
+            offset += sizeof(chunk) + chunk.bytes;
+        }
+        else
+        {
+            ChunkHeader chunk;
+            if (size - offset < sizeof(chunk))
+                break;
+            std::memcpy(&chunk, data + offset, sizeof(chunk));
+
+            uint32_t record = chunk.type < RecordingReader::sizes.size() ? RecordingReader::sizes[chunk.type] : 0;
+            if (chunk.type == INDEX_CHUNK || record == 0)
+                break;
+
+            // A truncated last chunk keeps the records that made it to disk.
+            size_t available = (size - offset - sizeof(chunk)) / record;
+            uint32_t count = static_cast<uint32_t>(std::min<size_t>(chunk.count, available));
+
+            if (count > 0 && record == RecordSize(chunk.type))
+            {
+                const char *records = data + offset + sizeof(chunk);
+
+                entry.type = chunk.type;
+                entry.count = count;
+                entry.first_us = RecordTimestamp(records);
+                entry.last_us = RecordTimestamp(records + (count - 1) * record);
+                Add(entry);
+            }
+
+            if (count < chunk.count)
+                break;
+
+            offset += sizeof(chunk) + static_cast<size_t>(record) * chunk.count;
+        }
+    }
+}
+
+/**
+ * Keep an index entry if it is a known stream and its chunk is
+ * really in the file.
+ * */
+bool RecordingReader::Add(const IndexEntry &entry)
+{
+    if (entry.type < 1 || entry.type > RECORD_TYPES || entry.count == 0)
+        return false;
+
+    uint32_t record = entry.type < RecordingReader::sizes.size() ? RecordingReader::sizes[entry.type] : 0;
+    if (record != RecordSize(entry.type))
+        return false;
+
+    size_t size = RecordingReader::file->Size();
+    const char *data = RecordingReader::file->Data();
+
+    if (RecordingReader::compressed)
+    {
+        EncodedChunkHeader chunk;
+        if (entry.offset > size || size - entry.offset < sizeof(chunk))
+            return false;
+        std::memcpy(&chunk, data + entry.offset, sizeof(chunk));
+
+        if (chunk.type != entry.type || chunk.count != entry.count || size - entry.offset - sizeof(chunk) < chunk.bytes)
+            return false;
+    }
+    else
+    {
+        ChunkHeader chunk;
+        if (entry.offset > size || size - entry.offset < sizeof(chunk))
+            return false;
+        std::memcpy(&chunk, data + entry.offset, sizeof(chunk));
+
+        if (chunk.type != entry.type || chunk.count < entry.count ||
+            (size - entry.offset - sizeof(chunk)) / record < entry.count)
+            return false;
+    }
+
+    RecordingReader::blocks[entry.type - 1].push_back(entry);
+    return true;
+}
+
+bool RecordingReader::Compressed() const
+{
+    return RecordingReader::compressed;
+}
+
+size_t RecordingReader::Damaged() const
+{
+    return RecordingReader::damaged;
+}
+
+IL::Timestamp RecordingReader::Start() const
+{
+    bool found = false;
+    IL::Timestamp start_us = 0;
+
+    for (const std::vector<IndexEntry> &stream : RecordingReader::blocks)
+    {
+        if (!stream.empty() && (!found || stream.front().first_us < start_us))
+        {
+            found = true;
+            start_us = stream.front().first_us;
+        }
+    }
+
+    return start_us;
+}
+
+IL::Timestamp RecordingReader::End() const
+{
+    bool found = false;
+    IL::Timestamp end_us = 0;
+
+    for (const std::vector<IndexEntry> &stream : RecordingReader::blocks)
+    {
+        if (!stream.empty() && (!found || stream.back().last_us > end_us))
+        {
+            found = true;
+            end_us = stream.back().last_us;
+        }
+    }
+
+    return end_us;
+}
+
+size_t RecordingReader::Count(uint32_t type) const
+{
+    size_t count = 0;
+    for (const IndexEntry &entry : RecordingReader::blocks[type - 1])
+        count += entry.count;
+
+    return count;
+}
+
+size_t RecordingReader::Blocks(uint32_t type) const
+{
+    return RecordingReader::blocks[type - 1].size();
+}
+
+const IndexEntry &RecordingReader::Entry(uint32_t type, size_t block) const
+{
+    return RecordingReader::blocks[type - 1][block];
+}
+
+/**
+ * All records of one block, compressed blocks are decoded into
+ * memory owned by the span. An empty span if it does not decode.
+ * */
+RecordSpan RecordingReader::ReadBlock(uint32_t type, size_t block) const
+{
+    const IndexEntry &entry = RecordingReader::blocks[type - 1][block];
+    uint32_t size = RecordSize(type);
+    const char *data = RecordingReader::file->Data() + entry.offset;
+
+    if (!RecordingReader::compressed)
+        return {data + sizeof(ChunkHeader), entry.count, size, RecordingReader::file};
+
+    EncodedChunkHeader chunk;
+    std::memcpy(&chunk, data, sizeof(chunk));
+
+    std::shared_ptr<std::vector<char>> decoded(new std::vector<char>(static_cast<size_t>(size) * entry.count));
+    if (!DecodeBlock(type, reinterpret_cast<const uint8_t *>(data + sizeof(chunk)), chunk.bytes, entry.count, decoded->data()))
+        return {nullptr, 0, size, nullptr};
+
+    return {decoded->data(), entry.count, size, decoded};
+}
+
+/**
+ * Like ReadBlock, but the last decoded block is kept
+ * since reads tend to stay in a block. A block that doesn't
+ * decode comes back empty and is counted as damaged.
+ * */
+RecordSpan RecordingReader::Block(uint32_t type, size_t block)
+{
+    const IndexEntry *entry = &RecordingReader::blocks[type - 1][block];
+
+    if (!RecordingReader::compressed || RecordingReader::cachedEntry != entry)
+    {
+        RecordSpan span = ReadBlock(type, block);
+        if (!span.records)
+        {
+            RecordingReader::damaged++;
+            return {nullptr, 0, span.size, nullptr};
+        }
+
+        if (RecordingReader::compressed)
+        {
+            RecordingReader::cachedEntry = entry;
+            RecordingReader::cached = span;
+        }
+        return span;
+    }
+
+    return RecordingReader::cached;
+}
+
+/**
+ * First record of the stream at or after timestamp_us.
+ * */
+RecordingReader::Position RecordingReader::Locate(uint32_t type, IL::Timestamp timestamp_us)
+{
+    const std::vector<IndexEntry> &stream = RecordingReader::blocks[type - 1];
+
+    auto it = std::lower_bound(stream.begin(), stream.end(), timestamp_us,
+                               [](const IndexEntry &entry, IL::Timestamp t) { return entry.last_us < t; });
+
+    size_t block = it - stream.begin();
+    if (block == stream.size())
+        return {block, 0};
+
+    RecordSpan span = Block(type, block);
+
+    uint32_t low = 0;
+    uint32_t high = span.count;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (RecordTimestamp(span.records + static_cast<size_t>(middle) * span.size) < timestamp_us)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return {block, low};
+}
+
+IL::Timestamp RecordingReader::Seek(IL::Timestamp timestamp_us)
+{
+    for (uint32_t type = 1; type <= RECORD_TYPES; type++)
+        RecordingReader::cursor[type - 1] = Locate(type, timestamp_us);
+
+    // Past a damaged block, to the next gaze point that can be read.
+    Position &gaze = RecordingReader::cursor[RECORD_GAZE_POINT - 1];
+    for (; gaze.block < RecordingReader::blocks[RECORD_GAZE_POINT - 1].size(); gaze = {gaze.block + 1, 0})
+    {
+        RecordSpan span = Block(RECORD_GAZE_POINT, gaze.block);
+        if (span.records && gaze.record < span.count)
+            return RecordTimestamp(span.records + static_cast<size_t>(gaze.record) * span.size);
+    }
+
+    return -1;
+}
+
+std::vector<RecordSpan> RecordingReader::Read(uint32_t type, size_t count)
+{
+    std::vector<RecordSpan> spans;
+
+    Position &p = RecordingReader::cursor[type - 1];
+    const std::vector<IndexEntry> &stream = RecordingReader::blocks[type - 1];
+
+    while (count > 0 && p.block < stream.size())
+    {
+        RecordSpan span = Block(type, p.block);
+        if (!span.records)
+        {
+            p = {p.block + 1, 0};
+            continue;
+        }
+
+        uint32_t n = static_cast<uint32_t>(std::min<size_t>(count, span.count - p.record));
+
+        if (n > 0)
+            spans.push_back({span.records + static_cast<size_t>(p.record) * span.size, n, span.size, span.owner});
+
+        count -= n;
+        p.record += n;
+
+        if (p.record >= span.count)
+            p = {p.block + 1, 0};
+    }
+
+    return spans;
+}
+
+std::vector<RecordSpan> RecordingReader::Range(uint32_t type, IL::Timestamp from_us, IL::Timestamp to_us)
+{
+    std::vector<RecordSpan> spans;
+
+    Position p = Locate(type, from_us);
+    const std::vector<IndexEntry> &stream = RecordingReader::blocks[type - 1];
+
+    for (; p.block < stream.size() && stream[p.block].first_us < to_us; p = {p.block + 1, 0})
+    {
+        RecordSpan span = Block(type, p.block);
+        if (!span.records)
+            continue;
+
+        uint32_t end = span.count;
+        if (stream[p.block].last_us >= to_us)
+        {
+            uint32_t low = p.record;
+            while (low < end)
+            {
+                uint32_t middle = low + (end - low) / 2;
+                if (RecordTimestamp(span.records + static_cast<size_t>(middle) * span.size) < to_us)
+                    low = middle + 1;
+                else
+                    end = middle;
+            }
+        }
+
+        if (end > p.record)
+            spans.push_back({span.records + static_cast<size_t>(p.record) * span.size, end - p.record, span.size, span.owner});
+    }
+
+    return spans;
+}
@@ -0,0 +1,127 @@
+/**
+ * Random access to recordings without loading them.
+ *
+ * The file is memory mapped and only the header and the block index in
+ * the footer are read when it is opened. Seeking is a binary search over
+ * the index, then over the timestamps inside one block. Files without
+ * an index, e.g. cut short by a crash, are indexed by walking the chunk
+ * headers once.
+ *
+ * Records of raw recordings are handed out as spans pointing straight
+ * into the mapping. Blocks of compressed recordings are decoded first,
+ * one block at a time. Either way a span keeps what it points into
+ * alive, so spans may outlive the reader.
+ */
+
+#ifndef READER_H
+#define READER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "recording.h"
+
+/**
+ * A private, copy on write mapping of a whole file.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const std::string &path);
+
+    const char *Data() const;
+    size_t Size() const;
+
+private:
+    char *data;
+    size_t size;
+
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#endif
+};
+
+/**
+ * Contiguous records of one stream.
+ */
+struct RecordSpan
+{
+    const char *records;
+    uint32_t count;
+    uint32_t size;
+
+    // Keeps the mapping or the decoded block alive.
+    std::shared_ptr<const void> owner;
+};
+
+class RecordingReader
+{
+public:
+    RecordingReader();
+
+    bool Open(const std::string &path);
+
+    bool Compressed() const;
+
+    // Blocks Seek, Read and Range found damaged and skipped, so far.
+    size_t Damaged() const;
+
+    // First and last timestamp over all streams, 0 if empty.
+    IL::Timestamp Start() const;
+    IL::Timestamp End() const;
+
+    size_t Count(uint32_t type) const;
+
+    /**
+     * Move the read position of every stream to its first record
+     * at or after timestamp_us. Returns the timestamp of the first
+     * gaze point there, or -1 past the end.
+     * */
+    IL::Timestamp Seek(IL::Timestamp timestamp_us);
+
+    // Up to count records of the stream from its read position, which moves past them.
+    std::vector<RecordSpan> Read(uint32_t type, size_t count);
+
+    // The records of the stream with from_us <= timestamp < to_us.
+    std::vector<RecordSpan> Range(uint32_t type, IL::Timestamp from_us, IL::Timestamp to_us);
+
+    // Direct block access, safe to use from several threads at once.
+    size_t Blocks(uint32_t type) const;
+    const IndexEntry &Entry(uint32_t type, size_t block) const;
+    RecordSpan ReadBlock(uint32_t type, size_t block) const;
+
+private:
+    struct Position
+    {
+        size_t block;
+        uint32_t record;
+    };
+
+    std::shared_ptr<MappedFile> file;
+    bool compressed;
+    std::vector<uint32_t> sizes;
+
+    // Blocks of each stream in time order, indexed by type - 1.
+    std::vector<IndexEntry> blocks[RECORD_TYPES];
+    Position cursor[RECORD_TYPES];
+
+    // Last decoded block of a compressed recording.
+    const IndexEntry *cachedEntry;
+    RecordSpan cached;
+
+    size_t damaged;
+
+    bool LoadIndex(size_t begin);
+    void ScanChunks(size_t begin);
+    bool Add(const IndexEntry &entry);
+
+    RecordSpan Block(uint32_t type, size_t block);
+    Position Locate(uint32_t type, IL::Timestamp timestamp_us);
+};
+
+#endif // READER_H
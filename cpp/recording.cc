@@ -0,0 +1,465 @@
+#include "recording.h"
+#include "codec.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+uint32_t RecordSize(uint32_t type)
+{
+    switch (type)
+    {
+    case RECORD_GAZE_POINT:
+        return sizeof(IL_GazePointData);
+    case RECORD_GAZE_ORIGIN:
+        return sizeof(IL_GazeOriginData);
+    case RECORD_HEAD_POSE:
+        return sizeof(IL_HeadPoseData);
+    case RECORD_PRESENCE:
+        return sizeof(IL_PresenceData);
+    case RECORD_GAZE_FOCUS:
+        return sizeof(IL_GazeFocusEvent);
+    default:
+        return 0;
+    }
+}
+
+IL::Timestamp RecordTimestamp(const void *record)
+{
+    IL::Timestamp timestamp_us;
+    std::memcpy(&timestamp_us, record, sizeof(timestamp_us));
+    return timestamp_us;
+}
+
+static const char *RecordName(uint32_t type)
+{
+    switch (type)
+    {
+    case RECORD_GAZE_POINT:
+        return "IL_GazePointData";
+    case RECORD_GAZE_ORIGIN:
+        return "IL_GazeOriginData";
+    case RECORD_HEAD_POSE:
+        return "IL_HeadPoseData";
+    case RECORD_PRESENCE:
+        return "IL_PresenceData";
+    case RECORD_GAZE_FOCUS:
+        return "IL_GazeFocusEvent";
+    default:
+        return "";
+    }
+}
+
+RecordingWriter::RecordingWriter()
+{
+    RecordingWriter::file = nullptr;
+    RecordingWriter::compressed = false;
+    RecordingWriter::offset = 0;
+}
+
+RecordingWriter::~RecordingWriter()
+{
+    if (RecordingWriter::file)
+        std::fclose(RecordingWriter::file);
+}
+
+/**
+ * Create the file and write the header and stream descriptors.
+ * */
+bool RecordingWriter::Open(const std::string &path, bool compressed)
+{
+    RecordingWriter::compressed = compressed;
+    RecordingWriter::index.clear();
+
+    RecordingWriter::file = std::fopen(path.c_str(), "wb");
+    if (!RecordingWriter::file)
+        return false;
+
+    // Chunks are already large, skip the stdio buffer.
+    std::setvbuf(RecordingWriter::file, nullptr, _IONBF, 0);
+
+    RecordingHeader header = {};
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = compressed ? RECORDING_VERSION_COMPRESSED : RECORDING_VERSION;
+    header.streams = RECORD_TYPES;
+    std::fwrite(&header, sizeof(header), 1, RecordingWriter::file);
+
+    for (uint32_t type = 1; type <= RECORD_TYPES; type++)
+    {
+        StreamDescriptor descriptor = {};
+        descriptor.type = type;
+        descriptor.size = RecordSize(type);
+        std::strncpy(descriptor.name, RecordName(type), sizeof(descriptor.name) - 1);
+        std::fwrite(&descriptor, sizeof(descriptor), 1, RecordingWriter::file);
+    }
+
+    RecordingWriter::offset = sizeof(header) + RECORD_TYPES * sizeof(StreamDescriptor);
+    return true;
+}
+
+/**
+ * Write count records of one type as a chunk, encoded if the recording
+ * is compressed.
+ * */
+void RecordingWriter::WriteChunk(uint32_t type, const char *records, uint32_t count)
+{
+    uint32_t size = RecordSize(type);
+
+    IndexEntry entry = {type, count, RecordTimestamp(records), RecordTimestamp(records + (count - 1) * size), RecordingWriter::offset};
+    RecordingWriter::index.push_back(entry);
+
+    if (RecordingWriter::compressed)
+    {
+        RecordingWriter::encoded.clear();
+        EncodeBlock(type, records, count, RecordingWriter::encoded);
+
+        EncodedChunkHeader chunk = {type, count, static_cast<uint32_t>(RecordingWriter::encoded.size())};
+        std::fwrite(&chunk, sizeof(chunk), 1, RecordingWriter::file);
+        std::fwrite(RecordingWriter::encoded.data(), 1, RecordingWriter::encoded.size(), RecordingWriter::file);
+
+        RecordingWriter::offset += sizeof(chunk) + RecordingWriter::encoded.size();
+    }
+    else
+    {
+        ChunkHeader chunk = {type, count};
+        std::fwrite(&chunk, sizeof(chunk), 1, RecordingWriter::file);
+        std::fwrite(records, size, count, RecordingWriter::file);
+
+        RecordingWriter::offset += sizeof(chunk) + static_cast<uint64_t>(size) * count;
+    }
+}
+
+/**
+ * The chunk index goes in a last chunk of its own, so readers that
+ * scan chunks stop at it, and the footer points back at it.
+ * Closes the file.
+ * */
+bool RecordingWriter::Finish()
+{
+    uint32_t entries = static_cast<uint32_t>(RecordingWriter::index.size());
+    uint32_t bytes = entries * sizeof(IndexEntry);
+
+    RecordingFooter footer = {};
+    footer.index = RecordingWriter::offset;
+    footer.entries = entries;
+    std::memcpy(footer.magic, INDEX_MAGIC, sizeof(footer.magic));
+
+    if (RecordingWriter::compressed)
+    {
+        EncodedChunkHeader chunk = {INDEX_CHUNK, entries, bytes};
+        std::fwrite(&chunk, sizeof(chunk), 1, RecordingWriter::file);
+    }
+    else
+    {
+        ChunkHeader chunk = {INDEX_CHUNK, entries};
+        std::fwrite(&chunk, sizeof(chunk), 1, RecordingWriter::file);
+    }
+
+    std::fwrite(RecordingWriter::index.data(), sizeof(IndexEntry), entries, RecordingWriter::file);
+    std::fwrite(&footer, sizeof(footer), 1, RecordingWriter::file);
+
+    bool ok = !std::ferror(RecordingWriter::file);
+    ok = std::fclose(RecordingWriter::file) == 0 && ok;
+    RecordingWriter::file = nullptr;
+    return ok;
+}
+
+Recorder::Recorder()
+    : blocks(BLOCK_COUNT)
+{
+    Recorder::closing = false;
+    Recorder::done = false;
+    Recorder::succeeded = false;
+    Recorder::dropped = 0;
+
+    // All the memory the tracker thread will ever write to is allocated here.
+    for (Block &block : Recorder::blocks)
+    {
+        block.count = 0;
+        block.data.resize(BLOCK_SIZE);
+        Recorder::spare.Push(&block);
+    }
+
+    for (uint32_t i = 0; i < RECORD_TYPES; i++)
+        Recorder::open[i] = nullptr;
+}
+
+Recorder::~Recorder()
+{
+    if (Recorder::writer.joinable())
+    {
+        Recorder::closing = true;
+        Recorder::wake.notify_one();
+        Recorder::writer.join();
+    }
+}
+
+bool Recorder::Open(const std::string &path, bool compressed)
+{
+    if (!Recorder::output.Open(path, compressed))
+        return false;
+
+    Recorder::path = path;
+    Recorder::writer = std::thread(&Recorder::Write, this);
+    return true;
+}
+
+/**
+ * Copy one record into the open block of its type.
+ * Never blocks, drops the record if the I/O thread is too far behind.
+ * */
+bool Recorder::Append(RecordType type, const void *record)
+{
+    Block *&block = Recorder::open[type - 1];
+    uint32_t size = RecordSize(type);
+
+    if (!block && !Recorder::spare.Pop(block))
+    {
+        Recorder::dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (block->count == 0)
+        block->type = type;
+
+    std::memcpy(block->data.data() + block->count * size, record, size);
+    block->count++;
+
+    if ((block->count + 1) * size > BLOCK_SIZE)
+    {
+        Submit(block);
+        block = nullptr;
+    }
+
+    return true;
+}
+
+void Recorder::Submit(Block *block)
+{
+    Recorder::full.Push(block);
+    Recorder::wake.notify_one();
+}
+
+/**
+ * Hand the partially filled blocks to the I/O thread and let it finish.
+ * */
+void Recorder::Close()
+{
+    for (uint32_t i = 0; i < RECORD_TYPES; i++)
+    {
+        if (Recorder::open[i] && Recorder::open[i]->count > 0)
+            Submit(Recorder::open[i]);
+
+        Recorder::open[i] = nullptr;
+    }
+
+    Recorder::closing = true;
+    Recorder::wake.notify_one();
+}
+
+bool Recorder::Done() const
+{
+    return Recorder::done;
+}
+
+bool Recorder::Succeeded() const
+{
+    return Recorder::succeeded;
+}
+
+uint64_t Recorder::Dropped() const
+{
+    return Recorder::dropped.load(std::memory_order_relaxed);
+}
+
+const std::string &Recorder::Path() const
+{
+    return Recorder::path;
+}
+
+/**
+ * I/O thread, writes full blocks as chunks until closed,
+ * then the index. The encoding runs here so it costs the
+ * tracker thread nothing.
+ * */
+void Recorder::Write()
+{
+    Tracing::NameThread("recorder");
+
+    while (true)
+    {
+        Block *block;
+        while (Recorder::full.Pop(block))
+        {
+            TraceSpan span("WriteChunk");
+            Recorder::output.WriteChunk(block->type, block->data.data(), block->count);
+
+            block->count = 0;
+            Recorder::spare.Push(block);
+        }
+
+        if (Recorder::closing && Recorder::full.Size() == 0)
+            break;
+
+        // The timeout covers a wake up sent between the check above and the wait.
+        std::unique_lock<std::mutex> lock(Recorder::wakeLock);
+        Recorder::wake.wait_for(lock, std::chrono::milliseconds(100));
+    }
+
+    Recorder::succeeded = Recorder::output.Finish();
+    Recorder::done = true;
+}
+
+/**
+ * Bytes of the file after the current position, from its size.
+ * */
+static size_t Remaining(std::FILE *file, size_t size)
+{
+    long position = std::ftell(file);
+    return position >= 0 && static_cast<size_t>(position) < size ? size - static_cast<size_t>(position) : 0;
+}
+
+/**
+ * Read a whole recording. Streams with an unknown type or a record
+ * size that does not match this build are skipped. Chunk sizes are
+ * checked against the size of the file before anything is allocated
+ * for them, so a damaged file can't ask for more memory than it holds.
+ * */
+bool Recording::Load(const std::string &path)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    RecordingHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) != 0 ||
+        (header.version != RECORDING_VERSION && header.version != RECORDING_VERSION_COMPRESSED))
+    {
+        std::fclose(file);
+        return false;
+    }
+
+    // Record size of every stream in the file, by type.
+    std::vector<uint32_t> sizes;
+    for (uint32_t i = 0; i < header.streams; i++)
+    {
+        StreamDescriptor descriptor;
+        if (std::fread(&descriptor, sizeof(descriptor), 1, file) != 1)
+        {
+            std::fclose(file);
+            return false;
+        }
+
+        if (descriptor.type >= sizes.size())
+            sizes.resize(descriptor.type + 1, 0);
+        sizes[descriptor.type] = descriptor.size;
+    }
+
+    size_t fileSize = 0;
+    long start = std::ftell(file);
+    if (start >= 0 && std::fseek(file, 0, SEEK_END) == 0)
+    {
+        long end = std::ftell(file);
+        fileSize = end > 0 ? static_cast<size_t>(end) : 0;
+    }
+
+    if (start < 0 || std::fseek(file, start, SEEK_SET) != 0)
+    {
+        std::fclose(file);
+        return false;
+    }
+
+    if (header.version == RECORDING_VERSION_COMPRESSED)
+    {
+        LoadCompressed(file, fileSize, sizes);
+        std::fclose(file);
+        return true;
+    }
+
+    ChunkHeader chunk;
+    while (std::fread(&chunk, sizeof(chunk), 1, file) == 1 && chunk.type != INDEX_CHUNK)
+    {
+        uint32_t size = chunk.type < sizes.size() ? sizes[chunk.type] : 0;
+        size_t bytes = static_cast<size_t>(size) * chunk.count;
+
+        bool known = chunk.type >= 1 && chunk.type <= RECORD_TYPES && size == RecordSize(chunk.type);
+        if (!known)
+        {
+            if (size == 0 || std::fseek(file, static_cast<long>(bytes), SEEK_CUR) != 0)
+                break;
+            continue;
+        }
+
+        // A truncated last chunk keeps the records that made it to disk.
+        size_t count = std::min<size_t>(chunk.count, Remaining(file, fileSize) / size);
+
+        std::vector<char> &records = Recording::records[chunk.type - 1];
+        size_t offset = records.size();
+        records.resize(offset + count * size);
+
+        size_t read = std::fread(records.data() + offset, size, count, file);
+        if (read != chunk.count)
+        {
+            records.resize(offset + read * size);
+            break;
+        }
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+/**
+ * Decode the chunks of a compressed recording, up to the index or the
+ * first chunk that is cut short or does not decode.
+ * */
+void Recording::LoadCompressed(std::FILE *file, size_t fileSize, const std::vector<uint32_t> &sizes)
+{
+    std::vector<uint8_t> encoded;
+
+    EncodedChunkHeader chunk;
+    while (std::fread(&chunk, sizeof(chunk), 1, file) == 1 && chunk.type != INDEX_CHUNK)
+    {
+        uint32_t size = chunk.type < sizes.size() ? sizes[chunk.type] : 0;
+        if (chunk.bytes > Remaining(file, fileSize))
+            break;
+
+        bool known = chunk.type >= 1 && chunk.type <= RECORD_TYPES && size == RecordSize(chunk.type);
+        if (!known)
+        {
+            if (std::fseek(file, static_cast<long>(chunk.bytes), SEEK_CUR) != 0)
+                break;
+            continue;
+        }
+
+        // Every record takes at least a byte for its timestamp.
+        if (chunk.count > chunk.bytes)
+            break;
+
+        encoded.resize(chunk.bytes);
+        if (std::fread(encoded.data(), 1, chunk.bytes, file) != chunk.bytes)
+            break;
+
+        std::vector<char> &records = Recording::records[chunk.type - 1];
+        size_t offset = records.size();
+        records.resize(offset + static_cast<size_t>(size) * chunk.count);
+
+        if (!DecodeBlock(chunk.type, encoded.data(), encoded.size(), chunk.count, records.data() + offset))
+        {
+            records.resize(offset);
+            break;
+        }
+    }
+}
+
+size_t Recording::Count(uint32_t type) const
+{
+    return Recording::records[type - 1].size() / RecordSize(type);
+}
+
+const void *Recording::Record(uint32_t type, size_t index) const
+{
+    return Recording::records[type - 1].data() + index * RecordSize(type);
+}
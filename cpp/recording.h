@@ -0,0 +1,222 @@
+/**
+ * Append-only binary recording of the tracker streams.
+ *
+ * File layout, little endian:
+ *
+ *   RecordingHeader
+ *   StreamDescriptor x header.streams
+ *   chunks, each a ChunkHeader followed by count fixed size records
+ *   index chunk, a ChunkHeader of type INDEX_CHUNK and count IndexEntry
+ *   RecordingFooter
+ *
+ * Records are the IL_* structs as delivered by the interaction library,
+ * the descriptors carry their sizes so readers can skip unknown streams.
+ * Focus records of a tracker shared by several Screens, see hub.h, carry
+ * the id the IL knows: the space of the Screen in bits 48 and up, and
+ * the id the Screen gave in the bits below, INTERACTOR_LOCAL_MASK.
+ *
+ * Compressed recordings, RECORDING_VERSION_COMPRESSED, have the same
+ * layout with an EncodedChunkHeader in front of every chunk and the
+ * records encoded column by column, see codec.h. They are typically
+ * 5 to 10 times smaller.
+ *
+ * The index and footer are written when the recording is stopped, a
+ * file cut short by a crash has neither and is read sequentially.
+ *
+ * The tracker thread appends into preallocated blocks, one open block per
+ * stream. Full blocks are handed to an I/O thread that writes each of them
+ * as a chunk with one large sequential write. When no free block is left
+ * records are dropped instead of stalling the tracker thread.
+ */
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+
+#include "ring.h"
+
+enum RecordType : uint32_t
+{
+    RECORD_GAZE_POINT = 1,
+    RECORD_GAZE_ORIGIN = 2,
+    RECORD_HEAD_POSE = 3,
+    RECORD_PRESENCE = 4,
+    RECORD_GAZE_FOCUS = 5
+};
+
+static const uint32_t RECORD_TYPES = 5;
+
+struct RecordingHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t streams;
+};
+
+struct StreamDescriptor
+{
+    uint32_t type;
+    uint32_t size;
+    char name[24];
+};
+
+struct ChunkHeader
+{
+    uint32_t type;
+    uint32_t count;
+};
+
+struct EncodedChunkHeader
+{
+    uint32_t type;
+    uint32_t count;
+    uint32_t bytes;
+};
+
+// Where each chunk starts, and the time span it covers.
+struct IndexEntry
+{
+    uint32_t type;
+    uint32_t count;
+    int64_t first_us;
+    int64_t last_us;
+    uint64_t offset;
+};
+
+struct RecordingFooter
+{
+    uint64_t index;
+    uint64_t entries;
+    char magic[8];
+};
+
+static const char RECORDING_MAGIC[8] = {'E', 'Y', 'E', 'T', 'R', 'A', 'C', 'K'};
+static const char INDEX_MAGIC[8] = {'E', 'Y', 'E', 'I', 'N', 'D', 'E', 'X'};
+static const uint32_t RECORDING_VERSION = 1;
+static const uint32_t RECORDING_VERSION_COMPRESSED = 2;
+
+// Chunk type of the index, readers that don't know it stop there.
+static const uint32_t INDEX_CHUNK = 0xffffffff;
+
+/**
+ * Size in bytes of one record of the given type, 0 if unknown.
+ */
+uint32_t RecordSize(uint32_t type);
+
+/**
+ * Every record starts with its IL_Timestamp.
+ */
+IL::Timestamp RecordTimestamp(const void *record);
+
+/**
+ * Writes a recording file: header and descriptors on Open, one chunk per
+ * WriteChunk, index and footer on Finish. Not thread-safe, it belongs to
+ * whichever thread does the I/O.
+ */
+class RecordingWriter
+{
+public:
+    RecordingWriter();
+    ~RecordingWriter();
+
+    bool Open(const std::string &path, bool compressed = false);
+    void WriteChunk(uint32_t type, const char *records, uint32_t count);
+
+    // Write the index and close the file, false if any write failed.
+    bool Finish();
+
+private:
+    std::FILE *file;
+    bool compressed;
+    uint64_t offset;
+    std::vector<uint8_t> encoded;
+    std::vector<IndexEntry> index;
+};
+
+class Recorder
+{
+public:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+    static const size_t BLOCK_COUNT = 32;
+
+    Recorder();
+    ~Recorder();
+
+    // Create the file, write the header and start the I/O thread.
+    bool Open(const std::string &path, bool compressed = false);
+
+    // Tracker thread only, false if the record was dropped for want of a block.
+    bool Append(RecordType type, const void *record);
+    void Close();
+
+    // True once the I/O thread wrote everything and closed the file.
+    bool Done() const;
+
+    // Once done, whether every write succeeded.
+    bool Succeeded() const;
+
+    // Records that found no free block.
+    uint64_t Dropped() const;
+
+    const std::string &Path() const;
+
+private:
+    struct Block
+    {
+        uint32_t type;
+        uint32_t count;
+        std::vector<char> data;
+    };
+
+    // Used by the I/O thread once opened.
+    RecordingWriter output;
+    std::string path;
+    std::vector<Block> blocks;
+
+    // Open block per record type, indexed by type - 1.
+    Block *open[RECORD_TYPES];
+
+    // Blocks travel tracker -> I/O thread through full, and back through spare.
+    SpscRing<Block *, BLOCK_COUNT> full;
+    SpscRing<Block *, BLOCK_COUNT> spare;
+
+    std::thread writer;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::atomic<bool> closing;
+    std::atomic<bool> done;
+    std::atomic<bool> succeeded;
+    std::atomic<uint64_t> dropped;
+
+    void Submit(Block *block);
+    void Write();
+};
+
+/**
+ * A recording loaded into memory, with the records of each stream
+ * stored contiguously in file order.
+ */
+class Recording
+{
+private:
+    std::vector<char> records[RECORD_TYPES];
+
+    void LoadCompressed(std::FILE *file, size_t size, const std::vector<uint32_t> &sizes);
+
+public:
+    bool Load(const std::string &path);
+
+    size_t Count(uint32_t type) const;
+    const void *Record(uint32_t type, size_t index) const;
+};
+
+#endif // RECORDING_H
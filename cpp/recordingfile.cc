@@ -0,0 +1,383 @@
+#include "recordingfile.h"
+
+/**
+ * Binds the Recording object to v8.
+ * */
+void RecordingFile::Init(v8::Local<v8::Object> exports)
+{
+    v8::Isolate *isolate = exports->GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    v8::Local<v8::FunctionTemplate> tpl = v8::FunctionTemplate::New(isolate, RecordingFile::New);
+    tpl->SetClassName(v8::String::NewFromUtf8(isolate, "Recording").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetStart", RecordingFile::GetStart);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetEnd", RecordingFile::GetEnd);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetCount", RecordingFile::GetCount);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "IsCompressed", RecordingFile::IsCompressed);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetDamaged", RecordingFile::GetDamaged);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "Seek", RecordingFile::Seek);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "Read", RecordingFile::Read);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "ReadRange", RecordingFile::ReadRange);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "ReplayLayouts", RecordingFile::ReplayLayouts);
+
+    v8::Local<v8::Function> construct = tpl->GetFunction(context).ToLocalChecked();
+
+    v8::Local<v8::String> object_name = v8::String::NewFromUtf8(isolate, "Recording").ToLocalChecked();
+    exports->Set(context, object_name, construct).FromJust();
+}
+
+/**
+ * JS constructor, let recording = new Recording('session.etrk');
+ * Throws if the file is not a recording.
+ * */
+void RecordingFile::New(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    if (!args.IsConstructCall())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "Please init Recording with the 'new' keyword");
+        return;
+    }
+
+    if (!args[0]->IsString())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a path");
+        return;
+    }
+
+    v8::String::Utf8Value path(isolate, args[0]);
+
+    RecordingFile *r = new RecordingFile();
+    if (!r->reader.Open(*path))
+    {
+        delete r;
+
+        std::string message = std::string("Could not open recording ") + *path;
+        isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+        return;
+    }
+
+    r->Wrap(args.This());
+    args.GetReturnValue().Set(args.This());
+}
+
+/**
+ * Stream numbers are the RecordType values, 1 gaze point to 5 focus.
+ * */
+bool RecordingFile::Stream(v8::Isolate *isolate, v8::Local<v8::Value> value, uint32_t &type)
+{
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    if (!value->IsNumber())
+        return false;
+
+    int64_t stream = value->IntegerValue(ctx).FromMaybe(0);
+    if (stream < 1 || stream > RECORD_TYPES)
+        return false;
+
+    type = static_cast<uint32_t>(stream);
+    return true;
+}
+
+/**
+ * One ArrayBuffer per span, backed by the span's memory. The buffer
+ * holds a reference to the span's owner until V8 collects it.
+ * */
+v8::Local<v8::Array> RecordingFile::Buffers(v8::Isolate *isolate, const std::vector<RecordSpan> &spans)
+{
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+    v8::Local<v8::Array> buffers = v8::Array::New(isolate, static_cast<int>(spans.size()));
+
+    for (uint32_t i = 0; i < spans.size(); i++)
+    {
+        const RecordSpan &span = spans[i];
+
+        std::shared_ptr<const void> *owner = new std::shared_ptr<const void>(span.owner);
+        std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(
+            const_cast<char *>(span.records), static_cast<size_t>(span.count) * span.size,
+            [](void *data, size_t length, void *owner)
+            {
+                delete static_cast<std::shared_ptr<const void> *>(owner);
+            },
+            owner);
+
+        buffers->Set(ctx, i, v8::ArrayBuffer::New(isolate, std::move(store))).FromJust();
+    }
+
+    return buffers;
+}
+
+void RecordingFile::GetStart(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), static_cast<double>(r->reader.Start())));
+}
+
+void RecordingFile::GetEnd(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), static_cast<double>(r->reader.End())));
+}
+
+/**
+ * Number of records of a stream, from the index.
+ * */
+void RecordingFile::GetCount(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    uint32_t type;
+    if (!Stream(isolate, args[0], type))
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a stream number");
+        return;
+    }
+
+    args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(r->reader.Count(type))));
+}
+
+void RecordingFile::IsCompressed(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Boolean::New(args.GetIsolate(), r->reader.Compressed()));
+}
+
+/**
+ * Number of blocks that could not be decoded and were skipped so far.
+ * */
+void RecordingFile::GetDamaged(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), static_cast<double>(r->reader.Damaged())));
+}
+
+void RecordingFile::ReportDamaged(const RecordingFile *r, size_t before)
+{
+    size_t damaged = r->reader.Damaged();
+    if (damaged > before)
+        Logging::Write(IL_LoggingLevel_Error, "skipped %zu damaged blocks of the recording", damaged - before);
+}
+
+/**
+ * Move every stream to its first record at or after the timestamp.
+ * Returns the timestamp of the gaze point there, -1 past the end.
+ *
+ * params
+ * timestamp   number, microseconds
+ * */
+void RecordingFile::Seek(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    if (!args[0]->IsNumber())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a timestamp");
+        return;
+    }
+
+    IL::Timestamp timestamp_us = args[0]->IntegerValue(ctx).FromMaybe(0);
+
+    size_t damaged = r->reader.Damaged();
+    args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(r->reader.Seek(timestamp_us))));
+    ReportDamaged(r, damaged);
+}
+
+/**
+ * Read the next records of a stream and move past them.
+ *
+ * params
+ * stream   number
+ * count    number, at most this many records
+ * */
+void RecordingFile::Read(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    uint32_t type;
+    if (!Stream(isolate, args[0], type) || !args[1]->IsNumber())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "arguments must be a stream number and a count");
+        return;
+    }
+
+    int64_t count = args[1]->IntegerValue(ctx).FromMaybe(0);
+
+    size_t damaged = r->reader.Damaged();
+    args.GetReturnValue().Set(Buffers(isolate, r->reader.Read(type, count > 0 ? static_cast<size_t>(count) : 0)));
+    ReportDamaged(r, damaged);
+}
+
+/**
+ * Read the records of a stream with from <= timestamp < to.
+ * Doesn't move the read position.
+ *
+ * params
+ * stream   number
+ * from     number, microseconds
+ * to       number, microseconds
+ * */
+void RecordingFile::ReadRange(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    uint32_t type;
+    if (!Stream(isolate, args[0], type) || !args[1]->IsNumber() || !args[2]->IsNumber())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "arguments must be a stream number and two timestamps");
+        return;
+    }
+
+    IL::Timestamp from_us = args[1]->IntegerValue(ctx).FromMaybe(0);
+    IL::Timestamp to_us = args[2]->IntegerValue(ctx).FromMaybe(0);
+
+    size_t damaged = r->reader.Damaged();
+    args.GetReturnValue().Set(Buffers(isolate, r->reader.Range(type, from_us, to_us)));
+    ReportDamaged(r, damaged);
+}
+
+/**
+ * { samples, misses, timeline, interactors } where the timeline is a
+ * Float64Array of [id, start, end] per focus span and interactors are
+ * { id, samples, entries, dwell, firstFocus } in the order of the layout.
+ * */
+v8::Local<v8::Object> RecordingFile::Result(v8::Isolate *isolate, const LayoutReplay &result)
+{
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    auto set = [&](v8::Local<v8::Object> object, const char *name, v8::Local<v8::Value> value)
+    {
+        object->Set(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked(), value).FromJust();
+    };
+
+    v8::Local<v8::Object> object = v8::Object::New(isolate);
+    set(object, "samples", v8::Number::New(isolate, static_cast<double>(result.samples)));
+    set(object, "misses", v8::Number::New(isolate, static_cast<double>(result.misses)));
+
+    size_t spans = result.timeline.size();
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, spans * 3 * sizeof(double));
+    double *timeline = static_cast<double *>(buffer->Data());
+
+    for (size_t i = 0; i < spans; i++)
+    {
+        timeline[i * 3] = static_cast<double>(result.timeline[i].id);
+        timeline[i * 3 + 1] = static_cast<double>(result.timeline[i].start_us);
+        timeline[i * 3 + 2] = static_cast<double>(result.timeline[i].end_us);
+    }
+
+    set(object, "timeline", v8::Float64Array::New(buffer, 0, spans * 3));
+
+    v8::Local<v8::Array> interactors = v8::Array::New(isolate, static_cast<int>(result.interactors.size()));
+    for (uint32_t i = 0; i < result.interactors.size(); i++)
+    {
+        const InteractorHits &hits = result.interactors[i];
+
+        v8::Local<v8::Object> interactor = v8::Object::New(isolate);
+        set(interactor, "id", v8::Number::New(isolate, static_cast<double>(hits.id)));
+        set(interactor, "samples", v8::Number::New(isolate, static_cast<double>(hits.samples)));
+        set(interactor, "entries", v8::Number::New(isolate, static_cast<double>(hits.entries)));
+        set(interactor, "dwell", v8::Number::New(isolate, static_cast<double>(hits.dwell_us)));
+        set(interactor, "firstFocus", v8::Number::New(isolate, static_cast<double>(hits.first_us)));
+
+        interactors->Set(ctx, i, interactor).FromJust();
+    }
+
+    set(object, "interactors", interactors);
+
+    return object;
+}
+
+/**
+ * Replay the recorded gaze against several layouts at once and call
+ * back with one result per layout, see Result for its shape.
+ * The replay runs in the background, spread over all cores.
+ *
+ * params
+ * layouts    array of arrays of { id, x, y, width, height }
+ * callback   function (results)
+ * */
+void RecordingFile::ReplayLayouts(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    RecordingFile *r = ObjectWrap::Unwrap<RecordingFile>(args.Holder());
+
+    if (!args[0]->IsArray() || !args[1]->IsFunction())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "arguments must be an array of layouts and a callback");
+        return;
+    }
+
+    std::unique_ptr<Replay> replay(new Replay());
+
+    v8::Local<v8::Array> layouts = args[0].As<v8::Array>();
+    replay->layouts.resize(layouts->Length());
+
+    for (uint32_t i = 0; i < layouts->Length(); i++)
+    {
+        if (!ReadLayout(isolate, layouts->Get(ctx, i).ToLocalChecked(), replay->layouts[i]))
+        {
+            Logging::Write(IL_LoggingLevel_Error, "layout %u is not an array of { id, x, y, width, height }", i);
+            return;
+        }
+    }
+
+    replay->request.data = replay.get();
+    replay->file = r;
+    replay->callback.Reset(isolate, args[1].As<v8::Function>());
+
+    // Keep the recording alive until the replay is done.
+    r->Ref();
+
+    uv_queue_work(node::GetCurrentEventLoop(isolate), &replay->request, RecordingFile::RunReplay, RecordingFile::FinishReplay);
+    replay.release();
+}
+
+void RecordingFile::RunReplay(uv_work_t *request)
+{
+    Replay *replay = static_cast<Replay *>(request->data);
+
+    WorkPool pool;
+    ::ReplayLayouts(replay->file->reader, replay->layouts, pool, replay->results);
+}
+
+void RecordingFile::FinishReplay(uv_work_t *request, int status)
+{
+    std::unique_ptr<Replay> replay(static_cast<Replay *>(request->data));
+    v8::Isolate *isolate = v8::Isolate::GetCurrent();
+
+    v8::HandleScope handle_scope(isolate);
+
+    RecordingFile *r = replay->file;
+    v8::Local<v8::Object> holder = r->handle();
+    v8::Local<v8::Context> ctx = holder->GetCreationContextChecked();
+    v8::Context::Scope context_scope(ctx);
+
+    v8::Local<v8::Array> results = v8::Array::New(isolate, static_cast<int>(replay->results.size()));
+    for (uint32_t i = 0; i < replay->results.size(); i++)
+        results->Set(ctx, i, Result(isolate, replay->results[i])).FromJust();
+
+    const unsigned int argc = 1;
+    v8::Local<v8::Value> argv[argc] = {results};
+
+    r->Unref();
+    node::MakeCallback(isolate, holder, replay->callback.Get(isolate), argc, argv, {0, 0});
+}
@@ -0,0 +1,71 @@
+/**
+ * JS binding of RecordingReader, for reviewing recordings without
+ * loading them, e.g.
+ *
+ *   let recording = new Screen.Recording('session.etrk');
+ *   recording.Seek(timestamp);
+ *   let buffers = recording.Read(1, 1000);
+ *
+ * Records come back as ArrayBuffers holding the IL_* structs, one
+ * buffer per block, to be viewed with typed arrays. For raw recordings
+ * they are views of the mapped file, no copy is made.
+ *
+ * ReplayLayouts runs a what-if replay, see whatif.h, on the libuv
+ * thread pool and calls back on the JS thread when it is done.
+ */
+
+#ifndef RECORDINGFILE_H
+#define RECORDINGFILE_H
+
+#include <memory>
+#include <node.h>
+#include <v8.h>
+#include <uv.h>
+#include <node_object_wrap.h>
+
+#include "jsutil.h"
+#include "logging.h"
+#include "reader.h"
+#include "whatif.h"
+
+class RecordingFile : public node::ObjectWrap
+{
+private:
+    RecordingReader reader;
+
+    static v8::Local<v8::Array> Buffers(v8::Isolate *isolate, const std::vector<RecordSpan> &spans);
+    static bool Stream(v8::Isolate *isolate, v8::Local<v8::Value> value, uint32_t &type);
+    static void ReportDamaged(const RecordingFile *r, size_t before);
+
+    static void New(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void GetStart(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetEnd(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetCount(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void IsCompressed(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetDamaged(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void Seek(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void Read(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void ReadRange(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    struct Replay
+    {
+        uv_work_t request;
+        RecordingFile *file;
+        std::vector<std::vector<Interactor>> layouts;
+        std::vector<LayoutReplay> results;
+        v8::Global<v8::Function> callback;
+    };
+
+    static v8::Local<v8::Object> Result(v8::Isolate *isolate, const LayoutReplay &result);
+
+    static void ReplayLayouts(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void RunReplay(uv_work_t *request);
+    static void FinishReplay(uv_work_t *request, int status);
+
+public:
+    static void Init(v8::Local<v8::Object> exports);
+};
+
+#endif // RECORDINGFILE_H
@@ -0,0 +1,151 @@
+#include "replay.h"
+
+#include <thread>
+
+// Streams that are fed back to the interaction library.
+static const uint32_t REPLAYED[] = {RECORD_GAZE_POINT, RECORD_GAZE_ORIGIN, RECORD_HEAD_POSE, RECORD_PRESENCE};
+
+ReplayAdapter::ReplayAdapter(float width, float height, double speed)
+    : Adapter(width, height)
+{
+    ReplayAdapter::speed = speed;
+    ReplayAdapter::started = false;
+    ReplayAdapter::first_us = 0;
+
+    for (uint32_t i = 0; i < RECORD_TYPES; i++)
+        ReplayAdapter::cursor[i] = 0;
+}
+
+bool ReplayAdapter::Open(const std::string &path)
+{
+    if (!ReplayAdapter::recording.Load(path))
+        return false;
+
+    if (ReplayAdapter::recording.Count(RECORD_GAZE_POINT))
+        ReplayAdapter::provided.push_back(IL_StreamInputType_GazePointData);
+    if (ReplayAdapter::recording.Count(RECORD_GAZE_ORIGIN))
+        ReplayAdapter::provided.push_back(IL_StreamInputType_GazeOriginData);
+    if (ReplayAdapter::recording.Count(RECORD_PRESENCE))
+        ReplayAdapter::provided.push_back(IL_StreamInputType_PresenceData);
+    if (ReplayAdapter::recording.Count(RECORD_HEAD_POSE))
+        ReplayAdapter::provided.push_back(IL_StreamInputType_HeadPoseData);
+
+    uint32_t type;
+    Next(type, ReplayAdapter::first_us);
+
+    return true;
+}
+
+/**
+ * The record with the lowest timestamp across the replayed streams.
+ * Returns false at the end of the recording.
+ * */
+bool ReplayAdapter::Next(uint32_t &type, IL::Timestamp &timestamp_us) const
+{
+    bool found = false;
+
+    for (uint32_t t : REPLAYED)
+    {
+        size_t i = ReplayAdapter::cursor[t - 1];
+        if (i >= ReplayAdapter::recording.Count(t))
+            continue;
+
+        IL::Timestamp ts = RecordTimestamp(ReplayAdapter::recording.Record(t, i));
+        if (!found || ts < timestamp_us)
+        {
+            found = true;
+            type = t;
+            timestamp_us = ts;
+        }
+    }
+
+    return found;
+}
+
+std::chrono::steady_clock::time_point ReplayAdapter::Due(IL::Timestamp timestamp_us) const
+{
+    double elapsed_us = (timestamp_us - ReplayAdapter::first_us) / ReplayAdapter::speed;
+
+    return ReplayAdapter::start + std::chrono::microseconds(static_cast<int64_t>(elapsed_us));
+}
+
+/**
+ * The device stays connected until the recording runs out.
+ * */
+bool ReplayAdapter::WaitForConnection()
+{
+    uint32_t type;
+    IL::Timestamp timestamp_us;
+
+    return Next(type, timestamp_us);
+}
+
+bool ReplayAdapter::WaitForData()
+{
+    uint32_t type;
+    IL::Timestamp timestamp_us;
+
+    if (!Next(type, timestamp_us))
+        return false;
+
+    if (!ReplayAdapter::started)
+    {
+        ReplayAdapter::started = true;
+        ReplayAdapter::start = std::chrono::steady_clock::now();
+    }
+
+    if (ReplayAdapter::speed > 0.0)
+        std::this_thread::sleep_until(Due(timestamp_us));
+
+    return true;
+}
+
+/**
+ * Paced replay posts everything that is due. As fast as possible
+ * posts one tracker frame, i.e. all records sharing the next timestamp.
+ * */
+void ReplayAdapter::Update()
+{
+    uint32_t type;
+    IL::Timestamp timestamp_us;
+
+    if (!Next(type, timestamp_us))
+        return;
+
+    if (ReplayAdapter::speed > 0.0)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        while (Next(type, timestamp_us) && Due(timestamp_us) <= now)
+            Post(type);
+    }
+    else
+    {
+        IL::Timestamp frame_us = timestamp_us;
+
+        while (Next(type, timestamp_us) && timestamp_us == frame_us)
+            Post(type);
+    }
+}
+
+void ReplayAdapter::Post(uint32_t type)
+{
+    size_t &i = ReplayAdapter::cursor[type - 1];
+    const void *record = ReplayAdapter::recording.Record(type, i++);
+
+    switch (type)
+    {
+    case RECORD_GAZE_POINT:
+        PostGazePoint(*static_cast<const IL_GazePointData *>(record));
+        break;
+    case RECORD_GAZE_ORIGIN:
+        PostGazeOrigin(*static_cast<const IL_GazeOriginData *>(record));
+        break;
+    case RECORD_HEAD_POSE:
+        PostHeadPose(*static_cast<const IL_HeadPoseData *>(record));
+        break;
+    case RECORD_PRESENCE:
+        PostPresence(*static_cast<const IL_PresenceData *>(record));
+        break;
+    }
+}
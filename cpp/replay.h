@@ -0,0 +1,50 @@
+/**
+ * Adapter that replays a recording made with Screen.StartRecording,
+ * at real time, at a scaled speed or as fast as possible.
+ *
+ * Gaze point, gaze origin, head pose and presence records are posted
+ * in timestamp order with their original timestamps, so the pipeline
+ * sees the same data on every run. Focus events are not replayed, the
+ * interaction library computes them again from the gaze data.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <chrono>
+#include <string>
+
+#include "adapter.h"
+#include "recording.h"
+
+class ReplayAdapter : public Adapter
+{
+public:
+    // speed 1 is real time, 2 twice as fast, 0 as fast as possible.
+    ReplayAdapter(float width, float height, double speed);
+
+    bool Open(const std::string &path);
+
+protected:
+    bool WaitForConnection() override;
+    bool WaitForData() override;
+    void Update() override;
+
+private:
+    Recording recording;
+    double speed;
+
+    // Next record to post, per stream.
+    size_t cursor[RECORD_TYPES];
+
+    // Wall clock time the first record is due at.
+    bool started;
+    IL::Timestamp first_us;
+    std::chrono::steady_clock::time_point start;
+
+    bool Next(uint32_t &type, IL::Timestamp &timestamp_us) const;
+    std::chrono::steady_clock::time_point Due(IL::Timestamp timestamp_us) const;
+    void Post(uint32_t type);
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,141 @@
+/**
+ * Bounded lock-free queues.
+ * SpscRing hands events from the tracker thread to the JS thread
+ * without taking a lock on either side, MpscRing collects items
+ * from any number of threads for one consumer.
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t N>
+class SpscRing
+{
+    static_assert((N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+private:
+    std::array<T, N> items;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+public:
+    /**
+     * Producer side. Returns false, and drops the item,
+     * if the consumer has fallen a full ring behind.
+     * */
+    bool Push(const T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N)
+            return false;
+
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side. Returns false if the ring is empty.
+     * */
+    bool Pop(T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t Capacity() { return N; }
+};
+
+/**
+ * Bounded multi-producer/single-consumer queue. Every slot carries a
+ * sequence number telling producers and the consumer whose turn it is,
+ * producers claim a slot with a CAS on the head.
+ */
+template <typename T, size_t N>
+class MpscRing
+{
+    static_assert((N & (N - 1)) == 0, "MpscRing capacity must be a power of two");
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    std::array<Slot, N> slots;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+public:
+    MpscRing()
+    {
+        for (size_t i = 0; i < N; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * Any thread. Returns false, and drops the item, if the ring is full.
+     * */
+    bool Push(const T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot &slot = slots[h & (N - 1)];
+            std::ptrdiff_t turn = static_cast<std::ptrdiff_t>(slot.sequence.load(std::memory_order_acquire) - h);
+
+            if (turn == 0)
+            {
+                if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed))
+                {
+                    slot.item = item;
+                    slot.sequence.store(h + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (turn < 0)
+            {
+                return false;
+            }
+            else
+            {
+                h = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Consumer side. Returns false if the ring is empty, or the
+     * oldest claimed slot is still being written.
+     * */
+    bool Pop(T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        Slot &slot = slots[t & (N - 1)];
+
+        if (slot.sequence.load(std::memory_order_acquire) != t + 1)
+            return false;
+
+        item = slot.item;
+        slot.sequence.store(t + N, std::memory_order_release);
+        tail.store(t + 1, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+#endif // RING_H
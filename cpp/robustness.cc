@@ -0,0 +1,378 @@
+#include "robustness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+// Independent generator streams, wide enough for AVX2.
+static const size_t LANES = 8;
+
+// Fixations per task.
+static const uint64_t BATCH = 4096;
+
+// Noise beyond this many standard deviations is hit tested against the whole layout.
+static const float REACH = 6.0f;
+
+static const float TWO_PI = 6.28318530717958647692f;
+static const float LN2 = 0.69314718055994530942f;
+
+/**
+ * LANES xoshiro128+ generators, stored lane by lane so each step is one
+ * loop the compiler turns into vector instructions.
+ */
+struct Generator
+{
+    uint32_t s0[LANES];
+    uint32_t s1[LANES];
+    uint32_t s2[LANES];
+    uint32_t s3[LANES];
+};
+
+static uint64_t SplitMix(uint64_t &state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static void Seed(Generator &generator, uint64_t seed, uint64_t stream)
+{
+    uint64_t state = seed ^ SplitMix(stream);
+
+    for (size_t lane = 0; lane < LANES; lane++)
+    {
+        uint64_t a = SplitMix(state);
+        uint64_t b = SplitMix(state);
+
+        generator.s0[lane] = static_cast<uint32_t>(a);
+        generator.s1[lane] = static_cast<uint32_t>(a >> 32);
+        generator.s2[lane] = static_cast<uint32_t>(b);
+        generator.s3[lane] = static_cast<uint32_t>(b >> 32) | 1;
+    }
+}
+
+// LANES uniform floats in (0, 1].
+static void Uniforms(Generator &g, float *out)
+{
+    for (size_t lane = 0; lane < LANES; lane++)
+    {
+        uint32_t result = g.s0[lane] + g.s3[lane];
+        uint32_t t = g.s1[lane] << 9;
+
+        g.s2[lane] ^= g.s0[lane];
+        g.s3[lane] ^= g.s1[lane];
+        g.s1[lane] ^= g.s2[lane];
+        g.s0[lane] ^= g.s3[lane];
+        g.s2[lane] ^= t;
+        g.s3[lane] = (g.s3[lane] << 11) | (g.s3[lane] >> 21);
+
+        out[lane] = static_cast<float>((result >> 8) + 1) * (1.0f / 16777216.0f);
+    }
+}
+
+/**
+ * Natural log of x > 0, to about 1e-7, from the exponent bits and an
+ * odd series around 1 that needs no table.
+ * */
+static inline float Log(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    // Split x into 2^exponent * m with m in [1/sqrt(2), sqrt(2)),
+    // where the series converges fast, using integer steps only.
+    uint32_t offset = bits - 0x3f3504f3;
+    int32_t exponent = static_cast<int32_t>(offset) >> 23;
+    bits = (offset & 0x007fffff) + 0x3f3504f3;
+
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    float s = (m - 1.0f) / (m + 1.0f);
+    float s2 = s * s;
+    float series = 1.0f + s2 * (1.0f / 3.0f + s2 * (1.0f / 5.0f + s2 * (1.0f / 7.0f + s2 * (1.0f / 9.0f))));
+
+    return static_cast<float>(exponent) * LN2 + 2.0f * s * series;
+}
+
+/**
+ * sin(2 pi q) for q in [-0.5, 0.5], folded onto a quarter turn and
+ * evaluated by its Taylor series.
+ * */
+static inline float SinTurns(float q)
+{
+    float m = std::fabs(q);
+    float folded = 0.5f - m;
+    m = m < folded ? m : folded;
+    q = std::copysign(m, q);
+
+    float x = q * TWO_PI;
+    float x2 = x * x;
+
+    return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f + x2 * (-1.0f / 39916800.0f))))));
+}
+
+/**
+ * Fill out with count standard normal numbers, count a multiple of
+ * 2 * LANES, by Box-Muller on uniforms drawn into the two halves.
+ * */
+static void Gaussians(Generator &generator, float *out, size_t count)
+{
+    for (size_t i = 0; i < count; i += LANES)
+        Uniforms(generator, out + i);
+
+    size_t half = count / 2;
+    float *u1 = out;
+    float *u2 = out + half;
+
+    for (size_t i = 0; i < half; i++)
+    {
+        float r = std::sqrt(-2.0f * Log(u1[i]));
+
+        // The angle is taken from a half turn off, the sign doesn't
+        // matter, and cos(2 pi a) = sin(2 pi (1/4 - |a|)).
+        float a = u2[i] - 0.5f;
+        float b = 0.25f - std::fabs(a);
+
+        u1[i] = r * SinTurns(a);
+        u2[i] = r * SinTurns(b);
+    }
+}
+
+/**
+ * Counters shared by the tasks, indexed like the layout.
+ */
+struct Totals
+{
+    std::unique_ptr<std::atomic<uint64_t>[]> trials;
+    std::unique_ptr<std::atomic<uint64_t>[]> activations;
+    std::unique_ptr<std::atomic<uint64_t>[]> misses;
+    std::unique_ptr<std::atomic<uint64_t>[]> falseActivations;
+    std::unique_ptr<std::atomic<uint64_t>[]> stolen;
+
+    explicit Totals(size_t count)
+        : trials(new std::atomic<uint64_t>[count]()),
+          activations(new std::atomic<uint64_t>[count]()),
+          misses(new std::atomic<uint64_t>[count]()),
+          falseActivations(new std::atomic<uint64_t>[count]()),
+          stolen(new std::atomic<uint64_t>[count]())
+    {
+    }
+};
+
+/**
+ * The interactors a target's fixations can reach, in the order the hit
+ * test lets them win: lowest z first, later interactors after earlier.
+ */
+struct Reach
+{
+    float left, top, right, bottom;
+
+    std::vector<int32_t> index;
+    std::vector<float> x0, y0, x1, y1;
+};
+
+static void FindReach(const std::vector<Interactor> &layout, const std::vector<int32_t> &order,
+                      float x, float y, float radius, Reach &reach)
+{
+    reach.left = x - radius;
+    reach.right = x + radius;
+    reach.top = y - radius;
+    reach.bottom = y + radius;
+
+    for (int32_t i : order)
+    {
+        const IL::Rectangle &r = layout[i].bounds;
+        if (r.x > reach.right || r.x + r.w < reach.left || r.y > reach.bottom || r.y + r.h < reach.top)
+            continue;
+
+        reach.index.push_back(i);
+        reach.x0.push_back(r.x);
+        reach.y0.push_back(r.y);
+        reach.x1.push_back(r.x + r.w);
+        reach.y1.push_back(r.y + r.h);
+    }
+}
+
+/**
+ * Simulate count fixations aimed at one target.
+ * */
+static void SimulateBatch(const std::vector<Interactor> &layout, const NoiseModel &model, const Reach &reach,
+                          int32_t target, uint64_t batch, uint64_t count, Totals &totals)
+{
+    const IL::Rectangle &bounds = layout[target].bounds;
+    float aimX = bounds.x + bounds.w * 0.5f + model.biasX;
+    float aimY = bounds.y + bounds.h * 0.5f + model.biasY;
+
+    size_t samples = model.samples;
+    size_t points = static_cast<size_t>(count) * samples;
+
+    Generator generator;
+    Seed(generator, model.seed, (static_cast<uint64_t>(target) << 32) ^ batch);
+
+    // Offsets of the fixations, then of their gaze points, x and y halves.
+    size_t fixationNoise = (2 * count + 2 * LANES - 1) / (2 * LANES) * (2 * LANES);
+    size_t pointNoise = (2 * points + 2 * LANES - 1) / (2 * LANES) * (2 * LANES);
+
+    std::vector<float> noise(fixationNoise + pointNoise);
+    Gaussians(generator, noise.data(), noise.size());
+
+    const float *fx = noise.data();
+    const float *fy = fx + count;
+    const float *px = noise.data() + fixationNoise;
+    const float *py = px + points;
+
+    std::vector<float> xs(points);
+    std::vector<float> ys(points);
+
+    for (size_t f = 0; f < count; f++)
+    {
+        float x = aimX + model.accuracy * fx[f];
+        float y = aimY + model.accuracy * fy[f];
+
+        for (size_t s = 0; s < samples; s++)
+        {
+            xs[f * samples + s] = x + model.precision * px[f * samples + s];
+            ys[f * samples + s] = y + model.precision * py[f * samples + s];
+        }
+    }
+
+    // Hit test one interactor at a time over every point, later winners overwrite.
+    std::vector<int32_t> hits(points, -1);
+    int32_t *hit = hits.data();
+    const float *x = xs.data();
+    const float *y = ys.data();
+
+    for (size_t c = 0; c < reach.index.size(); c++)
+    {
+        float x0 = reach.x0[c], y0 = reach.y0[c], x1 = reach.x1[c], y1 = reach.y1[c];
+        int32_t index = reach.index[c];
+
+        for (size_t i = 0; i < points; i++)
+        {
+            bool inside = (x[i] >= x0) & (x[i] < x1) & (y[i] >= y0) & (y[i] < y1);
+            hit[i] = inside ? index : hit[i];
+        }
+    }
+
+    // Points the reach doesn't cover, far out in the tails.
+    for (size_t i = 0; i < points; i++)
+    {
+        if (x[i] >= reach.left && x[i] <= reach.right && y[i] >= reach.top && y[i] <= reach.bottom)
+            continue;
+
+        const Interactor *top = HitTest(layout, x[i], y[i]);
+        hit[i] = top ? static_cast<int32_t>(top - layout.data()) : -1;
+    }
+
+    // The interactor most gaze points of a fixation hit, if it got enough.
+    uint32_t needed = static_cast<uint32_t>(std::ceil(model.threshold * samples));
+    if (needed == 0)
+        needed = 1;
+
+    uint64_t activations = 0, misses = 0, falseActivations = 0;
+    std::vector<int32_t> thieves;
+
+    for (size_t f = 0; f < count; f++)
+    {
+        const int32_t *fixation = hit + f * samples;
+
+        int32_t best = -1;
+        uint32_t bestCount = 0;
+
+        for (size_t s = 0; s < samples; s++)
+        {
+            if (fixation[s] < 0 || fixation[s] == best)
+                continue;
+
+            uint32_t n = 0;
+            for (size_t t = s; t < samples; t++)
+                n += fixation[t] == fixation[s] ? 1 : 0;
+
+            if (n > bestCount)
+            {
+                best = fixation[s];
+                bestCount = n;
+            }
+        }
+
+        if (bestCount < needed)
+            misses++;
+        else if (best == target)
+            activations++;
+        else
+        {
+            falseActivations++;
+            thieves.push_back(best);
+        }
+    }
+
+    totals.trials[target].fetch_add(count, std::memory_order_relaxed);
+    totals.activations[target].fetch_add(activations, std::memory_order_relaxed);
+    totals.misses[target].fetch_add(misses, std::memory_order_relaxed);
+    totals.falseActivations[target].fetch_add(falseActivations, std::memory_order_relaxed);
+
+    std::sort(thieves.begin(), thieves.end());
+    for (size_t i = 0; i < thieves.size();)
+    {
+        size_t j = i;
+        while (j < thieves.size() && thieves[j] == thieves[i])
+            j++;
+
+        totals.stolen[thieves[i]].fetch_add(j - i, std::memory_order_relaxed);
+        i = j;
+    }
+}
+
+void EstimateRobustness(const std::vector<Interactor> &layout, const NoiseModel &model,
+                        WorkPool &pool, std::vector<TargetRobustness> &results)
+{
+    results.clear();
+    if (layout.empty() || model.samples == 0)
+        return;
+
+    // The order the hit test picks the top interactor in, see HitTest.
+    std::vector<int32_t> order(layout.size());
+    for (size_t i = 0; i < layout.size(); i++)
+        order[i] = static_cast<int32_t>(i);
+
+    std::stable_sort(order.begin(), order.end(), [&](int32_t a, int32_t b)
+                     { return layout[a].z < layout[b].z; });
+
+    float radius = REACH * (std::fabs(model.accuracy) + std::fabs(model.precision));
+
+    std::vector<Reach> reaches(layout.size());
+    Totals totals(layout.size());
+
+    for (size_t i = 0; i < layout.size(); i++)
+    {
+        const IL::Rectangle &bounds = layout[i].bounds;
+        FindReach(layout, order, bounds.x + bounds.w * 0.5f + model.biasX, bounds.y + bounds.h * 0.5f + model.biasY,
+                  radius, reaches[i]);
+
+        for (uint64_t first = 0; first < model.trials; first += BATCH)
+        {
+            uint64_t count = std::min(BATCH, model.trials - first);
+            int32_t target = static_cast<int32_t>(i);
+            uint64_t batch = first / BATCH;
+
+            pool.Submit([&, target, batch, count]()
+                        { SimulateBatch(layout, model, reaches[target], target, batch, count, totals); });
+        }
+    }
+
+    pool.Wait();
+
+    for (size_t i = 0; i < layout.size(); i++)
+    {
+        results.push_back({layout[i].id,
+                           totals.trials[i].load(),
+                           totals.activations[i].load(),
+                           totals.misses[i].load(),
+                           totals.falseActivations[i].load(),
+                           totals.stolen[i].load()});
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * Monte Carlo estimate of how reliably a layout can be operated by gaze.
+ *
+ * For every interactor, many fixations aimed at its centre are simulated
+ * under a noise model: each fixation lands off the aim by an accuracy
+ * error, and its gaze points scatter around that by the precision. The
+ * interactor hit by most of a fixation's gaze points is activated if it
+ * got at least the threshold share of them. Counting what gets activated
+ * shows targets that are too small (misses) or overlap or crowd their
+ * neighbours (false activations) before anyone tests the layout.
+ *
+ * The random numbers come from independent xoshiro128+ streams laid out
+ * side by side, and Gaussians from Box-Muller with polynomial log and
+ * sine, so the generator runs as plain loops over lanes that compilers
+ * vectorize. Gaze points are hit tested a whole batch per interactor,
+ * only against the interactors the noise can reach. Batches run in
+ * parallel on a WorkPool, each with its own seed, so the estimate is
+ * the same for any number of threads.
+ */
+
+#ifndef ROBUSTNESS_H
+#define ROBUSTNESS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "hittest.h"
+#include "pool.h"
+
+struct NoiseModel
+{
+    // Standard deviation of the fixation's offset from the aim, per axis, in display units.
+    float accuracy;
+
+    // Standard deviation of the gaze points around the fixation, per axis.
+    float precision;
+
+    // Systematic offset of every fixation.
+    float biasX;
+    float biasY;
+
+    // Gaze points per fixation.
+    uint32_t samples;
+
+    // Share of the gaze points an interactor needs to be activated.
+    float threshold;
+
+    // Fixations per interactor.
+    uint64_t trials;
+
+    uint64_t seed;
+};
+
+static const NoiseModel DEFAULT_NOISE_MODEL = {20.0f, 10.0f, 0.0f, 0.0f, 10, 0.5f, 100000, 1};
+
+// Each task holds a batch of fixations times samples gaze points,
+// and every interactor takes trials / batch tasks.
+static const uint32_t MAX_NOISE_SAMPLES = 1000;
+static const uint64_t MAX_NOISE_TRIALS = 100000000;
+
+struct TargetRobustness
+{
+    IL::InteractorId id;
+
+    // Fixations aimed at the interactor, by outcome.
+    uint64_t trials;
+    uint64_t activations;
+    uint64_t misses;
+    uint64_t falseActivations;
+
+    // Times it was activated by a fixation aimed at another interactor.
+    uint64_t stolen;
+};
+
+/**
+ * Simulate the fixations of every interactor of the layout on the pool
+ * and wait for them. Results are in the order of the layout.
+ * */
+void EstimateRobustness(const std::vector<Interactor> &layout, const NoiseModel &model,
+                        WorkPool &pool, std::vector<TargetRobustness> &results);
+
+#endif // ROBUSTNESS_H
@@ -1,20 +1,179 @@
 
 #include "screen.h"
 
-Screen::Screen(float w, float h)
+Screen::Screen(float w, float h, std::unique_ptr<Adapter> adapter, bool shared)
 {
     Screen::height = h;
     Screen::width = w;
     Screen::offset = 0.0f;
+    Screen::isolate = nullptr;
+    Screen::listening = false;
 
-    // Init the tobii interaction library
-    Screen::tobii = IL::UniqueInteractionLibPtr(IL::CreateInteractionLib(IL::FieldOfUse::Interactive));
+    // Init the tracker, which owns the tobii interaction library,
+    // or join the one of the process.
+    uint32_t space = 0;
+    if (shared)
+    {
+        Screen::tracker = TrackerHub::Acquire(Screen::width, Screen::height, std::move(adapter));
+        space = TrackerHub::NextSpace();
+    }
+    else
+    {
+        Screen::tracker = std::make_shared<Tracker>(Screen::width, Screen::height, std::move(adapter));
+    }
+
+    Screen::client = std::make_shared<TrackerClient>(Screen::Notify, this, space);
+}
+
+/**
+ * A listening Screen holds a reference to itself and is never collected,
+ * so the client goes away before the tracker ever had it. The rectangles
+ * of a shared Screen are removed from the tracker it leaves behind.
+ * */
+Screen::~Screen()
+{
+    Screen::tracker->Detach(Screen::client.get());
+}
+
+/**
+ * Start the tracker thread the first time a listener is registered.
+ * The Screen holds a reference to itself and the async handle keeps
+ * the event loop alive for as long as events may arrive.
+ * */
+void Screen::StartListening(v8::Isolate *isolate, unsigned streams)
+{
+    Screen::tracker->Enable(streams);
+    Screen::client->streams |= streams;
+
+    if (Screen::listening)
+        return;
+
+    Screen::listening = true;
+    Screen::isolate = isolate;
+    Screen::context.Reset(isolate, isolate->GetCurrentContext());
+
+    uv_async_init(node::GetCurrentEventLoop(isolate), &async, Screen::Dispatch);
+    Screen::async.data = this;
+    Ref();
+
+    Screen::tracker->Attach(Screen::client);
+}
+
+/**
+ * Called on the tracker thread when new events are queued.
+ * */
+void Screen::Notify(void *context)
+{
+    Screen *s = static_cast<Screen *>(context);
+
+    uv_async_send(&s->async);
+}
+
+void Screen::Call(const v8::Global<v8::Function> &callback, int argc, v8::Local<v8::Value> argv[])
+{
+    v8::Local<v8::Context> ctx = Screen::context.Get(Screen::isolate);
 
-    Screen::tobii->CoordinateTransformAddOrUpdateDisplayArea(Screen::width, Screen::height);
-    Screen::tobii->CoordinateTransformSetOriginOffset(Screen::offset, Screen::offset);
+    node::MakeCallback(Screen::isolate, ctx->Global(), callback.Get(Screen::isolate), argc, argv, {0, 0});
 }
 
-Screen::~Screen() {}
+/**
+ * Drain the tracker queues on the JS thread and call the listeners.
+ * */
+void Screen::Dispatch(uv_async_t *handle)
+{
+    Screen *s = static_cast<Screen *>(handle->data);
+    v8::Isolate *isolate = s->isolate;
+
+    v8::HandleScope handle_scope(isolate);
+    v8::Context::Scope context_scope(s->context.Get(isolate));
+
+    TraceSpan span("Dispatch");
+
+    IL::GazeFocusEvent focus;
+    while (s->client->focusEvents.Pop(focus))
+    {
+        v8::HandleScope scope(isolate);
+        int64_t dequeued_us = LatencyClock();
+        FOCUS_PROBE3(dequeue, static_cast<int>(LATENCY_GAZE_FOCUS), focus.timestamp_us, dequeued_us);
+        const unsigned int argc = 3;
+
+        v8::Local<v8::Value> argv[argc] = {
+            v8::Integer::New(isolate, focus.id),
+            v8::Boolean::New(isolate, focus.hasFocus),
+            v8::Integer::New(isolate, focus.timestamp_us)};
+
+        {
+            TraceSpan call("JS focus");
+            s->Call(s->focusCallback, argc, argv);
+        }
+        int64_t returned_us = LatencyClock();
+        FOCUS_PROBE4(dispatch, static_cast<int>(LATENCY_GAZE_FOCUS), focus.timestamp_us, dequeued_us, returned_us);
+        s->tracker->latency[LATENCY_GAZE_FOCUS][STAGE_DEQUEUE_TO_RETURN].Record(returned_us - dequeued_us);
+        s->tracker->counters.Add(COUNTER_DELIVERED_GAZE_FOCUS);
+    }
+
+    IL::GazePointData point;
+    while (s->client->gazePoints.Pop(point))
+    {
+        v8::HandleScope scope(isolate);
+        int64_t dequeued_us = LatencyClock();
+        FOCUS_PROBE3(dequeue, static_cast<int>(LATENCY_GAZE_POINT), point.timestamp_us, dequeued_us);
+        const unsigned int argc = 4;
+
+        v8::Local<v8::Value> argv[argc] = {
+            v8::Integer::New(isolate, point.x),
+            v8::Integer::New(isolate, point.y),
+            v8::Integer::New(isolate, point.validity),
+            v8::Integer::New(isolate, point.timestamp_us)};
+
+        {
+            TraceSpan call("JS gazePoint");
+            s->Call(s->gazePointCallback, argc, argv);
+        }
+        int64_t returned_us = LatencyClock();
+        FOCUS_PROBE4(dispatch, static_cast<int>(LATENCY_GAZE_POINT), point.timestamp_us, dequeued_us, returned_us);
+        s->tracker->latency[LATENCY_GAZE_POINT][STAGE_DEQUEUE_TO_RETURN].Record(returned_us - dequeued_us);
+        s->tracker->counters.Add(COUNTER_DELIVERED_GAZE_POINT);
+    }
+
+    BlinkEvent blink;
+    while (s->client->blinkEvents.Pop(blink))
+    {
+        v8::HandleScope scope(isolate);
+        int64_t dequeued_us = LatencyClock();
+        FOCUS_PROBE3(dequeue, static_cast<int>(LATENCY_BLINK), blink.end_us, dequeued_us);
+        const unsigned int argc = 4;
+
+        v8::Local<v8::Value> argv[argc] = {
+            v8::Integer::New(isolate, static_cast<int>(blink.type)),
+            v8::Number::New(isolate, static_cast<double>(blink.start_us)),
+            v8::Number::New(isolate, static_cast<double>(blink.end_us)),
+            v8::Number::New(isolate, static_cast<double>(blink.duration_us))};
+
+        {
+            TraceSpan call("JS blink");
+            s->Call(s->blinkCallback, argc, argv);
+        }
+        int64_t returned_us = LatencyClock();
+        FOCUS_PROBE4(dispatch, static_cast<int>(LATENCY_BLINK), blink.end_us, dequeued_us, returned_us);
+        s->tracker->latency[LATENCY_BLINK][STAGE_DEQUEUE_TO_RETURN].Record(returned_us - dequeued_us);
+        s->tracker->counters.Add(COUNTER_DELIVERED_BLINK);
+    }
+
+    bool ok;
+    while (s->client->dumpResults.Pop(ok))
+    {
+        v8::HandleScope scope(isolate);
+        const unsigned int argc = 1;
+
+        v8::Local<v8::Value> argv[argc] = {v8::Boolean::New(isolate, ok)};
+
+        // Reset first, the callback may start the next dump.
+        v8::Global<v8::Function> callback(std::move(s->dumpCallback));
+        if (!callback.IsEmpty())
+            s->Call(callback, argc, argv);
+    }
+}
 
 /**
  * Binds the Screen object to v8, so it can be created
@@ -42,8 +201,23 @@ void Screen::Init(v8::Local<v8::Object> exports)
     NODE_SET_PROTOTYPE_METHOD(tpl, "SetWidth", Screen::SetWidth);
     NODE_SET_PROTOTYPE_METHOD(tpl, "AddRectangle", Screen::AddRectangle);
     NODE_SET_PROTOTYPE_METHOD(tpl, "AddRectangles", Screen::AddRectangles);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "AttachInteractorTable", Screen::AttachInteractorTable);
     NODE_SET_PROTOTYPE_METHOD(tpl, "Listen", Screen::Listen);
     NODE_SET_PROTOTYPE_METHOD(tpl, "ListenGazePoint", Screen::ListenGazePoint);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "ListenBlinks", Screen::ListenBlinks);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetPresence", Screen::GetPresence);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetQuality", Screen::GetQuality);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "StartRecording", Screen::StartRecording);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "StopRecording", Screen::StopRecording);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "Dump", Screen::Dump);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetHistory", Screen::GetHistory);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetHistoryStats", Screen::GetHistoryStats);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetStored", Screen::GetStored);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetStoreSize", Screen::GetStoreSize);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetLatencyStats", Screen::GetLatencyStats);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "ResetLatencyStats", Screen::ResetLatencyStats);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetCounters", Screen::GetCounters);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "GetCounterNames", Screen::GetCounterNames);
 
 
     v8::Local<v8::Function> construct = tpl->GetFunction(context).ToLocalChecked();
@@ -53,9 +227,146 @@ void Screen::Init(v8::Local<v8::Object> exports)
     exports->Set(context, object_name, construct).FromJust();
 }
 
+/**
+ * Build the data source requested in the constructor options.
+ * Returns false, with a pending exception, if it can't be opened.
+ *
+ * options
+ * replay      string, path of a recording to replay instead of the tracker
+ * speed       number, replay speed, 1 is real time, 0 as fast as possible
+ * synthetic   true or { rate, noise, dropout, duration, seed } to generate gaze,
+ *             see synthetic.h for the meaning and SyntheticAdapter::DEFAULTS
+ *
+ * shared, flightRecorder, history, store, broadcast and server are read by
+ * the constructor itself.
+ * */
+static bool NewAdapter(v8::Isolate *isolate, v8::Local<v8::Object> options, float w, float h, std::unique_ptr<Adapter> &adapter)
+{
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    v8::Local<v8::Value> synthetic = options->Get(ctx, v8::String::NewFromUtf8(isolate, "synthetic").ToLocalChecked()).ToLocalChecked();
+    if (synthetic->IsTrue() || synthetic->IsObject())
+    {
+        SyntheticOptions settings = SyntheticAdapter::DEFAULTS;
+
+        if (synthetic->IsObject())
+        {
+            v8::Local<v8::Object> o = synthetic.As<v8::Object>();
+            settings.rate = Option(isolate, o, "rate", settings.rate);
+            settings.noise = static_cast<float>(Option(isolate, o, "noise", settings.noise));
+            settings.dropout = Option(isolate, o, "dropout", settings.dropout);
+            settings.duration = Option(isolate, o, "duration", settings.duration);
+            settings.seed = static_cast<unsigned>(Option(isolate, o, "seed", settings.seed));
+        }
+
+        adapter.reset(new SyntheticAdapter(w, h, settings));
+        return true;
+    }
+
+    v8::Local<v8::Value> replay = options->Get(ctx, v8::String::NewFromUtf8(isolate, "replay").ToLocalChecked()).ToLocalChecked();
+    if (!replay->IsString())
+        return true;
+
+    double speed = Option(isolate, options, "speed", 1.0);
+
+    v8::String::Utf8Value path(isolate, replay);
+
+    std::unique_ptr<ReplayAdapter> source(new ReplayAdapter(w, h, speed));
+    if (!source->Open(*path))
+    {
+        std::string message = std::string("Could not open recording ") + *path;
+        isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+        return false;
+    }
+
+    adapter = std::move(source);
+    return true;
+}
+
+/**
+ * Read a constructor option giving the length of an in-memory window,
+ * as seconds or { seconds, rate }, rate in samples per second.
+ * False if the option is missing or empty.
+ * */
+static bool WindowOption(v8::Isolate *isolate, v8::Local<v8::Value> options, const char *name, double &seconds, double &rate)
+{
+    if (!options->IsObject())
+        return false;
+
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+    v8::Local<v8::Value> window = options.As<v8::Object>()->Get(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked()).ToLocalChecked();
+
+    seconds = 0.0;
+    rate = FlightRecorder::DEFAULT_RATE;
+
+    if (window->IsNumber())
+    {
+        seconds = window.As<v8::Number>()->Value();
+    }
+    else if (window->IsObject())
+    {
+        seconds = Option(isolate, window.As<v8::Object>(), "seconds", 10.0);
+        rate = Option(isolate, window.As<v8::Object>(), "rate", rate);
+    }
+
+    return seconds > 0.0 && rate > 0.0;
+}
+
+/**
+ * Read the quality constructor option, true to compute the data quality
+ * for GetQuality.
+ * */
+static bool QualityOption(v8::Isolate *isolate, v8::Local<v8::Value> options)
+{
+    if (!options->IsObject())
+        return false;
+
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+    return options.As<v8::Object>()->Get(ctx, v8::String::NewFromUtf8(isolate, "quality").ToLocalChecked()).ToLocalChecked()->IsTrue();
+}
+
+/**
+ * Read the broadcast constructor option, as the name of the segment or
+ * { name, seconds, rate }, seconds of every stream the ring holds, one
+ * by default. False if the option is missing or has no name.
+ * */
+static bool BroadcastOption(v8::Isolate *isolate, v8::Local<v8::Value> options, std::string &name, double &seconds, double &rate)
+{
+    if (!options->IsObject())
+        return false;
+
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+    v8::Local<v8::Value> broadcast = options.As<v8::Object>()->Get(ctx, v8::String::NewFromUtf8(isolate, "broadcast").ToLocalChecked()).ToLocalChecked();
+
+    seconds = 1.0;
+    rate = FlightRecorder::DEFAULT_RATE;
+
+    v8::Local<v8::Value> value = broadcast;
+    if (broadcast->IsObject())
+    {
+        v8::Local<v8::Object> o = broadcast.As<v8::Object>();
+        value = o->Get(ctx, v8::String::NewFromUtf8(isolate, "name").ToLocalChecked()).ToLocalChecked();
+        seconds = Option(isolate, o, "seconds", seconds);
+        rate = Option(isolate, o, "rate", rate);
+    }
+
+    if (!value->IsString())
+        return false;
+
+    v8::String::Utf8Value utf8(isolate, value);
+    name = *utf8;
+    return !name.empty() && seconds > 0.0 && rate > 0.0;
+}
+
 /**
  * JS constructor for creating a new Screen object as
  * let screen = new Screen(1920.0, 1080.0);
+ *
+ * An optional third argument selects another data source, e.g.
+ * let screen = new Screen(1920.0, 1080.0, { replay: 'session.etrk' });
+ *
+ * With shared: true the Screen joins the tracker of the process, see hub.h.
+ * The options of the tracker itself only apply until it is running.
  * */
 void Screen::New(const v8::FunctionCallbackInfo<v8::Value> &args)
 {
@@ -66,7 +377,7 @@ void Screen::New(const v8::FunctionCallbackInfo<v8::Value> &args)
     // i.e. let myScreen = new Screen(1920, 1080)
     if (!args.IsConstructCall())
     {
-        std::cout << "Please init Screen with the 'new' keyword" << std::endl;
+        Logging::Write(IL_LoggingLevel_Error, "Please init Screen with the 'new' keyword");
         return;
     }
 
@@ -80,9 +391,101 @@ void Screen::New(const v8::FunctionCallbackInfo<v8::Value> &args)
     if (!args[1]->IsUndefined())
         h = args[1]->NumberValue(context).FromMaybe(0.0f);
 
+    // Get the data source, the tracker by default
+    std::unique_ptr<Adapter> adapter;
+    if (args[2]->IsObject() && !NewAdapter(isolate, args[2].As<v8::Object>(), w, h, adapter))
+        return;
+
+    bool shared = args[2]->IsObject() &&
+                  args[2].As<v8::Object>()->Get(context, v8::String::NewFromUtf8(isolate, "shared").ToLocalChecked()).ToLocalChecked()->IsTrue();
+
     // Return the Screen instance
-    Screen *s = new Screen(w, h);
+    Screen *s = new Screen(w, h, std::move(adapter), shared);
     s->Wrap(args.This());
+
+    // The tracker thread of a shared tracker may be using what the
+    // options below would replace.
+    if (shared && s->tracker->Running())
+    {
+        for (const char *name : {"flightRecorder", "history", "store", "broadcast", "server"})
+        {
+            v8::Local<v8::Value> option = args[2].As<v8::Object>()->Get(context, v8::String::NewFromUtf8(isolate, name).ToLocalChecked()).ToLocalChecked();
+            if (!option->IsUndefined())
+                Logging::Write(IL_LoggingLevel_Warn, "shared tracker already running, ignoring %s", name);
+        }
+
+        // Only a stream of the running tracker.
+        if (QualityOption(isolate, args[2]))
+            s->StartListening(isolate, STREAM_QUALITY);
+
+        args.GetReturnValue().Set(args.This());
+        return;
+    }
+
+    double seconds;
+    double rate;
+
+    // Listening starts the tracker thread, so it waits until everything
+    // the options below hand to the tracker is in place.
+    unsigned streams = 0;
+
+    // Keep the last seconds of every stream for Dump.
+    if (WindowOption(isolate, args[2], "flightRecorder", seconds, rate))
+    {
+        s->tracker->EnableFlightRecorder(seconds, rate);
+        streams |= STREAM_FLIGHT_RECORDER;
+    }
+
+    // Keep the recent gaze points for GetHistory.
+    if (WindowOption(isolate, args[2], "history", seconds, rate))
+    {
+        s->tracker->EnableHistory(seconds, rate);
+        streams |= STREAM_HISTORY;
+    }
+
+    // Keep the whole session of gaze points and gaze origins for GetStored.
+    if (args[2]->IsObject())
+    {
+        v8::Local<v8::Value> store = args[2].As<v8::Object>()->Get(context, v8::String::NewFromUtf8(isolate, "store").ToLocalChecked()).ToLocalChecked();
+        if (store->IsTrue())
+        {
+            s->tracker->EnableStore();
+            streams |= STREAM_STORE;
+        }
+    }
+
+    // Publish every stream to shared memory for other processes.
+    std::string broadcast;
+    if (BroadcastOption(isolate, args[2], broadcast, seconds, rate))
+    {
+        if (s->tracker->EnableBroadcast(broadcast, seconds, rate))
+            streams |= STREAM_BROADCAST;
+        else
+            Logging::Write(IL_LoggingLevel_Error, "Could not create broadcast %s", broadcast.c_str());
+    }
+
+    // Serve gaze, focus and presence on a Unix domain socket.
+    if (args[2]->IsObject())
+    {
+        v8::Local<v8::Value> server = args[2].As<v8::Object>()->Get(context, v8::String::NewFromUtf8(isolate, "server").ToLocalChecked()).ToLocalChecked();
+        if (server->IsString())
+        {
+            v8::String::Utf8Value path(isolate, server);
+
+            if (s->tracker->EnableServer(*path))
+                streams |= STREAM_SERVER;
+            else
+                Logging::Write(IL_LoggingLevel_Error, "Could not serve on %s", *path);
+        }
+    }
+
+    // Compute the data quality for GetQuality.
+    if (QualityOption(isolate, args[2]))
+        streams |= STREAM_QUALITY;
+
+    if (streams)
+        s->StartListening(isolate, streams);
+
     args.GetReturnValue().Set(args.This());
 }
 
@@ -193,15 +596,11 @@ void Screen::AddRectangle(const v8::FunctionCallbackInfo<v8::Value> &args)
         h = args[4]->NumberValue(ctx).FromMaybe(0);
 
     // Cast the prams to a IL::Rectangle
-    IL::InteractorId rect_id = id;
+    IL::InteractorId rect_id = s->client->Global(id);
     IL::Rectangle rect = {x, y, w, h};
 
     // Push the rectangle to the update queue
-    s->tobii->BeginInteractorUpdates();
-
-    s->tobii->AddOrUpdateInteractor(rect_id, rect, 0.0f);
-
-    s->tobii->CommitInteractorUpdates();
+    s->tracker->AddOrUpdateInteractors({{rect_id, rect, 0.0f}});
 }
 
 /**
@@ -217,7 +616,7 @@ void Screen::AddRectangles(const v8::FunctionCallbackInfo<v8::Value> &args)
     // The arg needs to be an array of objects for this function to work.
     if (!args[0]->IsArray())
     {
-        std::cout << "Argument is not an array" << std::endl;
+        Logging::Write(IL_LoggingLevel_Error, "Argument is not an array");
         return;
     }
 
@@ -236,7 +635,8 @@ void Screen::AddRectangles(const v8::FunctionCallbackInfo<v8::Value> &args)
     int id;
     float x, y, w, h;
 
-    s->tobii->BeginInteractorUpdates();
+    std::vector<Interactor> interactors;
+    interactors.reserve(length);
 
     for (unsigned int i = 0; i < length; i++)
     {
@@ -269,102 +669,541 @@ void Screen::AddRectangles(const v8::FunctionCallbackInfo<v8::Value> &args)
 
         rect = {x, y, w, h};
 
-        s->tobii->AddOrUpdateInteractor(id, rect, 0.0f);
+        interactors.push_back({s->client->Global(static_cast<IL::InteractorId>(id)), rect, 0.0f});
     }
 
-    s->tobii->CommitInteractorUpdates();
+    s->tracker->AddOrUpdateInteractors(interactors);
 }
 
+/**
+ * Follow the layout another process publishes in an interactor table,
+ * see interactortable.h. The tracker commits what changed at its next
+ * update. Returns false if there is no table by that name yet.
+ *
+ * params
+ * name   string
+ * */
+void Screen::AttachInteractorTable(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    if (!args[0]->IsString())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a table name");
+        return;
+    }
+
+    v8::String::Utf8Value name(isolate, args[0]);
+
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, s->tracker->AttachInteractorTable(*name, s->client->space)));
+}
+
+/**
+ * Call back with (id, hasFocus, timestamp) whenever
+ * a rectangle gains or loses the gaze focus.
+ * */
 void Screen::Listen(const v8::FunctionCallbackInfo<v8::Value> &args)
 {
     v8::Isolate *isolate = args.GetIsolate();
-    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
 
     Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
 
     // The arg has to be a function for this to work.
     if (!args[0]->IsFunction())
     {
-        std::cout << "argument must be a function" << std::endl;
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a function");
         return;
     }
 
-    // For passing the isolate and context to the Gaze callback.
-    v8::Local<v8::Function> callback = v8::Local<v8::Function>::Cast(args[0]);
-    struct V8Scope
+    s->focusCallback.Reset(isolate, v8::Local<v8::Function>::Cast(args[0]));
+
+    Logging::Write(IL_LoggingLevel_Info, "Starting interaction library update loop.");
+
+    s->StartListening(isolate, STREAM_GAZE_FOCUS);
+}
+
+/**
+ * Call back with (x, y, validity, timestamp) for every valid gaze point.
+ * */
+void Screen::ListenGazePoint(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    // The arg has to be a function for this to work.
+    if (!args[0]->IsFunction())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a function");
+        return;
+    }
+
+    s->gazePointCallback.Reset(isolate, v8::Local<v8::Function>::Cast(args[0]));
+
+    Logging::Write(IL_LoggingLevel_Info, "Starting interaction library gaze point data loop.");
+
+    s->StartListening(isolate, STREAM_GAZE_POINT);
+}
+
+/**
+ * Call back with (type, start, end, duration) when a run of invalid
+ * samples ends. Times are in microseconds.
+ *
+ * type
+ * 0    blink, both eyes lost for a short while
+ * 1    tracking loss, both eyes lost for longer than a blink
+ * 2    left eye lost while the right eye was tracked
+ * 3    right eye lost while the left eye was tracked
+ * */
+void Screen::ListenBlinks(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    // The arg has to be a function for this to work.
+    if (!args[0]->IsFunction())
     {
-        v8::Isolate *isolate;
-        v8::Local<v8::Context> ctx;
-        v8::Local<v8::Function> cb;
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a function");
+        return;
+    }
+
+    s->blinkCallback.Reset(isolate, v8::Local<v8::Function>::Cast(args[0]));
+
+    s->StartListening(isolate, STREAM_BLINK);
+}
+
+/**
+ * Return the last presence reported by the tracker as an integer,
+ * 0 = unknown, 1 = away, 2 = present.
+ * */
+void Screen::GetPresence(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    v8::Local<v8::Integer> presence = v8::Integer::New(isolate, static_cast<int>(s->tracker->GetPresence()));
+
+    args.GetReturnValue().Set(presence);
+}
+
+/**
+ * Return the data quality of the gaze point stream over the last second,
+ * as last published by the tracker thread. Collected with the quality
+ * option of the constructor, an empty window without it or while the
+ * tracker isn't running.
+ *
+ * samples          samples in the window
+ * dataLoss         share of invalid samples, 0 to 1
+ * precisionRms     RMS sample to sample distance of valid samples
+ * sdX, sdY, sd     standard deviation of valid gaze positions
+ * intervalMean     mean time between samples, microseconds
+ * intervalSd       standard deviation of the time between samples
+ * intervals        histogram of the time between samples
+ * intervalBounds   upper bound of each histogram bucket, the last one is open
+ * */
+void Screen::GetQuality(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    QualityStats stats = s->tracker->GetQuality();
+
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+
+    auto set = [&](const char *name, v8::Local<v8::Value> value) {
+        result->Set(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked(), value).FromJust();
     };
-    V8Scope scope = {isolate, ctx, callback};
 
-    s->tobii->SubscribeGazeFocusEvents([](IL::GazeFocusEvent evt, void *gcontext) {
-        V8Scope &scope = *static_cast<V8Scope *>(gcontext);
-        const unsigned int argc = 3;
+    set("samples", v8::Integer::NewFromUnsigned(isolate, stats.samples));
+    set("dataLoss", v8::Number::New(isolate, stats.dataLoss));
+    set("precisionRms", v8::Number::New(isolate, stats.precisionRms));
+    set("sdX", v8::Number::New(isolate, stats.sdX));
+    set("sdY", v8::Number::New(isolate, stats.sdY));
+    set("sd", v8::Number::New(isolate, stats.sd));
+    set("intervalMean", v8::Number::New(isolate, stats.intervalMean));
+    set("intervalSd", v8::Number::New(isolate, stats.intervalSd));
+
+    v8::Local<v8::Array> intervals = v8::Array::New(isolate, QualityStats::INTERVAL_BUCKETS);
+    v8::Local<v8::Array> bounds = v8::Array::New(isolate, QualityStats::INTERVAL_BUCKETS - 1);
+    for (int i = 0; i < QualityStats::INTERVAL_BUCKETS; i++)
+    {
+        intervals->Set(ctx, i, v8::Integer::NewFromUnsigned(isolate, stats.intervals[i])).FromJust();
 
-        v8::Local<v8::Value> argv[argc] = {
-            v8::Integer::New(scope.isolate, evt.id),
-            v8::Boolean::New(scope.isolate, evt.hasFocus),
-            v8::Integer::New(scope.isolate, evt.timestamp_us)};
+        if (i < QualityStats::INTERVAL_BUCKETS - 1)
+            bounds->Set(ctx, i, v8::Number::New(isolate, static_cast<double>(QualityMonitor::INTERVAL_BOUNDS_US[i]))).FromJust();
+    }
+    set("intervals", intervals);
+    set("intervalBounds", bounds);
+
+    args.GetReturnValue().Set(result);
+}
 
-        scope.cb->Call(scope.ctx, Null(scope.isolate), argc, argv).ToLocalChecked();
-    },
-                                       &scope);
+/**
+ * Record gaze point, gaze origin, head pose, presence and focus
+ * events to a binary file, see recording.h for the layout.
+ * Returns false if the file could not be created.
+ *
+ * params
+ * path     string
+ * options  optional, { compressed: true } for the columnar encoding
+ * */
+void Screen::StartRecording(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    if (!args[0]->IsString())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a path");
+        return;
+    }
 
-    std::cout << "Starting interaction library update loop.\n";
+    v8::String::Utf8Value path(isolate, args[0]);
 
-    while (true)
+    bool compressed = false;
+    if (args[1]->IsObject())
     {
-        s->tobii->WaitAndUpdate();
+        v8::Local<v8::Value> value = args[1].As<v8::Object>()->Get(ctx, v8::String::NewFromUtf8(isolate, "compressed").ToLocalChecked()).ToLocalChecked();
+        compressed = value->BooleanValue(isolate);
     }
+
+    bool ok = s->tracker->StartRecording(*path, compressed);
+    if (ok)
+        s->StartListening(isolate, STREAM_RECORDING);
+
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, ok));
 }
 
-void Screen::ListenGazePoint(const v8::FunctionCallbackInfo<v8::Value> &args)
+/**
+ * Stop recording. The rest of the file is written in the background.
+ * */
+void Screen::StopRecording(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    s->tracker->StopRecording();
+}
+
+/**
+ * Write the flight recorder window before now and the secondsAfter after
+ * it to a recording file in the background. Returns false if the Screen
+ * has no flight recorder, a dump is already running or the file could
+ * not be created.
+ *
+ * params
+ * path          string
+ * secondsAfter  number, at most the length of the window
+ * options       optional, { compressed: true } for the columnar encoding
+ * callback      optional, called with true once the file is written,
+ *               false if writing failed
+ * */
+void Screen::Dump(const v8::FunctionCallbackInfo<v8::Value> &args)
 {
     v8::Isolate *isolate = args.GetIsolate();
     v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
 
     Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
 
-    // The arg has to be a function for this to work.
-    if (!args[0]->IsFunction())
+    if (!args[0]->IsString())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a path");
+        return;
+    }
+
+    v8::String::Utf8Value path(isolate, args[0]);
+
+    double after = 0.0;
+    if (!args[1]->IsUndefined())
+        after = args[1]->NumberValue(ctx).FromMaybe(0.0);
+
+    bool compressed = false;
+    int callbackIndex = 2;
+    if (args[2]->IsObject() && !args[2]->IsFunction())
     {
-        std::cout << "argument must be a function" << std::endl;
+        v8::Local<v8::Value> value = args[2].As<v8::Object>()->Get(ctx, v8::String::NewFromUtf8(isolate, "compressed").ToLocalChecked()).ToLocalChecked();
+        compressed = value->BooleanValue(isolate);
+        callbackIndex = 3;
+    }
+
+    bool ok = s->tracker->Dump(*path, after, compressed);
+    if (ok && args[callbackIndex]->IsFunction())
+        s->dumpCallback.Reset(isolate, args[callbackIndex].As<v8::Function>());
+
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, ok));
+}
+
+/**
+ * Start of a history query, in microseconds. Negative values count back
+ * from the newest sample, so -200000 is the last 200 ms.
+ * */
+static IL::Timestamp Since(v8::Isolate *isolate, v8::Local<v8::Value> value, const GazeHistory *history)
+{
+    if (value->IsUndefined())
+        return INT64_MIN;
+
+    double since = value->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+    if (since < 0.0)
+        return history->Latest() + static_cast<IL::Timestamp>(since);
+
+    return static_cast<IL::Timestamp>(since);
+}
+
+/**
+ * Valid gaze points at or after a timestamp, as one Float64Array of
+ * [timestamp, x, y] per sample, oldest first.
+ *
+ * params
+ * since    optional number, see Since, the whole window if left out
+ * */
+void Screen::GetHistory(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    const GazeHistory *history = s->tracker->History();
+    if (!history)
+    {
+        Logging::Write(IL_LoggingLevel_Error, "history is not enabled, see the history option");
         return;
     }
 
-    // For passing the isolate and context to the Gaze callback.
-    v8::Local<v8::Function> callback = v8::Local<v8::Function>::Cast(args[0]);
-    struct V8Scope
+    IL::Timestamp since_us = Since(isolate, args[0], history);
+
+    // Retry in the rare case the tracker thread overwrote the oldest samples while copying.
+    uint64_t first;
+    uint64_t last;
+    v8::Local<v8::ArrayBuffer> buffer;
+    do
     {
-        v8::Isolate *isolate;
-        v8::Local<v8::Context> ctx;
-        v8::Local<v8::Function> cb;
+        history->Find(since_us, first, last);
+        buffer = v8::ArrayBuffer::New(isolate, (last - first) * GazeHistory::FIELDS * sizeof(double));
+    } while (!history->Copy(first, last, static_cast<double *>(buffer->Data())));
+
+    args.GetReturnValue().Set(v8::Float64Array::New(buffer, 0, (last - first) * GazeHistory::FIELDS));
+}
+
+/**
+ * Mean and bounding box of the valid gaze points at or after a timestamp.
+ *
+ * params
+ * since    optional number, as for GetHistory
+ * */
+void Screen::GetHistoryStats(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    const GazeHistory *history = s->tracker->History();
+    if (!history)
+    {
+        Logging::Write(IL_LoggingLevel_Error, "history is not enabled, see the history option");
+        return;
+    }
+
+    IL::Timestamp since_us = Since(isolate, args[0], history);
+
+    uint64_t first;
+    uint64_t last;
+    HistoryStats stats;
+    do
+    {
+        history->Find(since_us, first, last);
+    } while (!history->Stats(first, last, stats));
+
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    auto set = [&](const char *name, v8::Local<v8::Value> value) {
+        result->Set(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked(), value).FromJust();
     };
-    V8Scope scope = {isolate, ctx, callback};
 
-    s->tobii->SubscribeGazePointData([](IL::GazePointData evt, void *gcontext) {
-        if (evt.validity == IL::Validity::Invalid)
-            return;
+    set("count", v8::Integer::NewFromUnsigned(isolate, stats.count));
+    set("from", v8::Number::New(isolate, static_cast<double>(stats.from_us)));
+    set("to", v8::Number::New(isolate, static_cast<double>(stats.to_us)));
+    set("meanX", v8::Number::New(isolate, stats.meanX));
+    set("meanY", v8::Number::New(isolate, stats.meanY));
+    set("minX", v8::Number::New(isolate, stats.minX));
+    set("minY", v8::Number::New(isolate, stats.minY));
+    set("maxX", v8::Number::New(isolate, stats.maxX));
+    set("maxY", v8::Number::New(isolate, stats.maxY));
+
+    args.GetReturnValue().Set(result);
+}
 
-        V8Scope &scope = *static_cast<V8Scope *>(gcontext);
-        const unsigned int argc = 4;
+/**
+ * Samples kept by the store option with from <= timestamp < to, as one
+ * Float64Array with the fields of the stream's IL struct per sample:
+ * gaze points as [timestamp, validity, x, y], gaze origins as
+ * [timestamp, leftValidity, lx, ly, lz, rightValidity, rx, ry, rz].
+ *
+ * params
+ * stream   1 gaze point or 2 gaze origin, as in recordings
+ * from     optional number, microseconds
+ * to       optional number, microseconds
+ * */
+void Screen::GetStored(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
 
-        v8::Local<v8::Value> argv[argc] = {
-            v8::Integer::New(scope.isolate, evt.x),
-            v8::Integer::New(scope.isolate, evt.y),
-            v8::Integer::New(scope.isolate, evt.validity),
-            v8::Integer::New(scope.isolate, evt.timestamp_us)};
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    uint32_t stream = args[0]->Uint32Value(ctx).FromMaybe(0);
+    if (stream != RECORD_GAZE_POINT && stream != RECORD_GAZE_ORIGIN)
+    {
+        Logging::Write(IL_LoggingLevel_Error, "stream must be 1 (gaze point) or 2 (gaze origin)");
+        return;
+    }
 
-        scope.cb->Call(scope.ctx, Null(scope.isolate), argc, argv).ToLocalChecked();
-    },
-                                       &scope);
+    IL::Timestamp from_us = INT64_MIN;
+    if (!args[1]->IsUndefined())
+        from_us = static_cast<IL::Timestamp>(args[1]->NumberValue(ctx).FromMaybe(0.0));
 
-    std::cout << "Starting interaction library gaze point data loop.\n";
+    IL::Timestamp to_us = INT64_MAX;
+    if (!args[2]->IsUndefined())
+        to_us = static_cast<IL::Timestamp>(args[2]->NumberValue(ctx).FromMaybe(0.0));
+
+    std::vector<double> *values = new std::vector<double>();
+    s->tracker->ReadStore(stream, from_us, to_us, *values);
+
+    // The buffer takes over the decoded values.
+    size_t length = values->size();
+    std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(
+        values->data(), length * sizeof(double),
+        [](void *data, size_t length, void *values)
+        {
+            delete static_cast<std::vector<double> *>(values);
+        },
+        values);
+
+    args.GetReturnValue().Set(v8::Float64Array::New(v8::ArrayBuffer::New(isolate, std::move(store)), 0, length));
+}
+
+/**
+ * Samples kept by the store option, the memory they take, and what
+ * they would take as IL structs.
+ * */
+void Screen::GetStoreSize(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    size_t points;
+    size_t origins;
+    size_t bytes;
+    s->tracker->StoreSize(points, origins, bytes);
+
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    auto set = [&](const char *name, double value) {
+        result->Set(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked(), v8::Number::New(isolate, value)).FromJust();
+    };
 
-    while (true)
+    set("gazePoints", static_cast<double>(points));
+    set("gazeOrigins", static_cast<double>(origins));
+    set("bytes", static_cast<double>(bytes));
+    set("rawBytes", static_cast<double>(points * sizeof(IL_GazePointData) + origins * sizeof(IL_GazeOriginData)));
+
+    args.GetReturnValue().Set(result);
+}
+
+/**
+ * Delivery latency of each stream, per stage, in microseconds:
+ * { gazePoint: { trackerToCallback: { count, p50, p99, p999, max }, ... }, ... }
+ * See latency.h for what the stages measure.
+ * */
+void Screen::GetLatencyStats(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    const char *streams[LATENCY_STREAMS] = {"focus", "gazePoint", "blink"};
+    const char *stages[LATENCY_STAGES] = {"trackerToCallback", "callbackToQueue", "dequeueToReturn"};
+
+    auto set = [&](v8::Local<v8::Object> object, const char *name, v8::Local<v8::Value> value) {
+        object->Set(ctx, v8::String::NewFromUtf8(isolate, name).ToLocalChecked(), value).FromJust();
+    };
+
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    for (int stream = 0; stream < LATENCY_STREAMS; stream++)
     {
-        s->tobii->WaitAndUpdate();
+        v8::Local<v8::Object> perStage = v8::Object::New(isolate);
+        for (int stage = 0; stage < LATENCY_STAGES; stage++)
+        {
+            LatencySummary summary = s->tracker->latency[stream][stage].Summarize();
+
+            v8::Local<v8::Object> o = v8::Object::New(isolate);
+            set(o, "count", v8::Number::New(isolate, static_cast<double>(summary.count)));
+            set(o, "p50", v8::Number::New(isolate, static_cast<double>(summary.p50)));
+            set(o, "p99", v8::Number::New(isolate, static_cast<double>(summary.p99)));
+            set(o, "p999", v8::Number::New(isolate, static_cast<double>(summary.p999)));
+            set(o, "max", v8::Number::New(isolate, static_cast<double>(summary.max)));
+            set(perStage, stages[stage], o);
+        }
+        set(result, streams[stream], perStage);
     }
-}
\ No newline at end of file
+
+    args.GetReturnValue().Set(result);
+}
+
+/**
+ * Start the latency histograms over, e.g. after warming up.
+ * */
+void Screen::ResetLatencyStats(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    for (int stream = 0; stream < LATENCY_STREAMS; stream++)
+    {
+        for (int stage = 0; stage < LATENCY_STAGES; stage++)
+            s->tracker->latency[stream][stage].Reset();
+    }
+}
+
+/**
+ * Every pipeline counter in one Float64Array, in the order of
+ * GetCounterNames. See counters.h for what they count.
+ * */
+void Screen::GetCounters(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Screen *s = ObjectWrap::Unwrap<Screen>(args.Holder());
+
+    uint64_t values[COUNTERS];
+    s->tracker->ReadCounters(values);
+
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, COUNTERS * sizeof(double));
+    double *out = static_cast<double *>(buffer->Data());
+    for (int i = 0; i < COUNTERS; i++)
+        out[i] = static_cast<double>(values[i]);
+
+    args.GetReturnValue().Set(v8::Float64Array::New(buffer, 0, COUNTERS));
+}
+
+/**
+ * Names of the values returned by GetCounters, e.g. "dropped.gazePoint".
+ * */
+void Screen::GetCounterNames(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+    v8::Local<v8::Context> ctx = isolate->GetCurrentContext();
+
+    v8::Local<v8::Array> names = v8::Array::New(isolate, COUNTERS);
+    for (int i = 0; i < COUNTERS; i++)
+        names->Set(ctx, i, v8::String::NewFromUtf8(isolate, PipelineCounters::Name(i)).ToLocalChecked()).FromJust();
+
+    args.GetReturnValue().Set(names);
+}
@@ -6,7 +6,7 @@
 #define SCREEN_H
 
 #include <vector>
-#include <iostream>
+#include <memory>
 #include <node.h>
 #include <v8.h>
 #include <uv.h>
@@ -16,6 +16,13 @@
 #include <interaction_lib/InteractionLib.h>
 #include <interaction_lib/misc/InteractionLibPtr.h>
 
+#include "hub.h"
+#include "jsutil.h"
+#include "logging.h"
+#include "replay.h"
+#include "synthetic.h"
+#include "tracker.h"
+
 class Screen : public node::ObjectWrap
 {
 private:
@@ -23,11 +30,30 @@ private:
     float width;
     float offset;
     std::vector<IL::Rectangle> rectangles;
-    IL::UniqueInteractionLibPtr tobii;
+    std::shared_ptr<Tracker> tracker;
+
+    // Queues of this Screen, the tracker may be shared, see hub.h.
+    std::shared_ptr<TrackerClient> client;
+
+    // JS side of the event delivery from the tracker thread.
+    v8::Isolate *isolate;
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Function> focusCallback;
+    v8::Global<v8::Function> gazePointCallback;
+    v8::Global<v8::Function> blinkCallback;
+    v8::Global<v8::Function> dumpCallback;
+    uv_async_t async;
+    bool listening;
 
-    Screen(float h, float w);
+    Screen(float h, float w, std::unique_ptr<Adapter> adapter, bool shared);
     ~Screen();
 
+    void StartListening(v8::Isolate *isolate, unsigned streams);
+    void Call(const v8::Global<v8::Function> &callback, int argc, v8::Local<v8::Value> argv[]);
+
+    static void Notify(void *context);
+    static void Dispatch(uv_async_t *handle);
+
     static void New(const v8::FunctionCallbackInfo<v8::Value> &args);
 
     static void GetHeight(const v8::FunctionCallbackInfo<v8::Value> &args);
@@ -38,9 +64,30 @@ private:
 
     static void AddRectangle(const v8::FunctionCallbackInfo<v8::Value> &args);
     static void AddRectangles(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void AttachInteractorTable(const v8::FunctionCallbackInfo<v8::Value> &args);
 
     static void Listen(const v8::FunctionCallbackInfo<v8::Value> &args);
     static void ListenGazePoint(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void ListenBlinks(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void GetPresence(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetQuality(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void StartRecording(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void StopRecording(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void Dump(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void GetHistory(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetHistoryStats(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void GetStored(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetStoreSize(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void GetLatencyStats(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void ResetLatencyStats(const v8::FunctionCallbackInfo<v8::Value> &args);
+
+    static void GetCounters(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void GetCounterNames(const v8::FunctionCallbackInfo<v8::Value> &args);
 
 
 public:
@@ -0,0 +1,308 @@
+#include "server.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "logging.h"
+
+// How often the server thread hands the posted frames to the clients,
+// the longest a frame waits and the most frames one send carries.
+static const int FLUSH_INTERVAL_MS = 2;
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+GazeServer::GazeServer(PipelineCounters &counters)
+    : counters(counters), listener(-1), running(false)
+{
+}
+
+GazeServer::~GazeServer()
+{
+    Stop();
+}
+
+#ifdef _WIN32
+
+bool GazeServer::Start(const std::string &path)
+{
+    Logging::Write(IL_LoggingLevel_Error, "the gaze server needs Unix domain sockets, use the broadcast on Windows");
+    return false;
+}
+
+void GazeServer::Stop()
+{
+}
+
+void GazeServer::Post(const ServerFrame &frame)
+{
+}
+
+#else
+
+bool GazeServer::Start(const std::string &path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    // Replace a socket left behind, but nothing else that lives there.
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        unlink(path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 16) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    GazeServer::path = path;
+    GazeServer::listener = fd;
+    GazeServer::running = true;
+    GazeServer::thread = std::thread(&GazeServer::Run, this);
+    return true;
+}
+
+void GazeServer::Stop()
+{
+    if (!GazeServer::running.exchange(false))
+        return;
+
+    GazeServer::thread.join();
+
+    for (std::unique_ptr<Client> &client : GazeServer::clients)
+        close(client->fd);
+    GazeServer::clients.clear();
+
+    close(GazeServer::listener);
+    unlink(GazeServer::path.c_str());
+    GazeServer::listener = -1;
+    GazeServer::counters.Set(COUNTER_SERVER_CLIENTS, 0);
+}
+
+void GazeServer::Post(const ServerFrame &frame)
+{
+    if (!GazeServer::incoming.Push(frame))
+        GazeServer::counters.Add(COUNTER_SERVER_OVERFLOW);
+}
+
+void GazeServer::Run()
+{
+    std::vector<pollfd> fds;
+
+    while (GazeServer::running.load(std::memory_order_relaxed))
+    {
+        fds.clear();
+        fds.push_back({GazeServer::listener, POLLIN, 0});
+        for (std::unique_ptr<Client> &client : GazeServer::clients)
+            fds.push_back({client->fd, static_cast<short>(POLLIN | (client->count ? POLLOUT : 0)), 0});
+
+        poll(fds.data(), fds.size(), FLUSH_INTERVAL_MS);
+
+        // Requests first, a new subscription applies to the frames below.
+        for (size_t i = 0; i < GazeServer::clients.size(); i++)
+        {
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))
+                Receive(*GazeServer::clients[i]);
+        }
+
+        if (fds[0].revents & POLLIN)
+            Accept();
+
+        ServerFrame frame;
+        while (GazeServer::incoming.Pop(frame))
+        {
+            for (std::unique_ptr<Client> &client : GazeServer::clients)
+            {
+                if (!client->closing && (client->mask & (1u << frame.type)))
+                    Enqueue(*client, frame);
+            }
+        }
+
+        for (std::unique_ptr<Client> &client : GazeServer::clients)
+        {
+            if (!client->closing && client->count)
+                Flush(*client);
+        }
+
+        for (size_t i = 0; i < GazeServer::clients.size();)
+        {
+            if (GazeServer::clients[i]->closing)
+            {
+                close(GazeServer::clients[i]->fd);
+                GazeServer::clients.erase(GazeServer::clients.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        GazeServer::counters.Set(COUNTER_SERVER_CLIENTS, GazeServer::clients.size());
+    }
+}
+
+void GazeServer::Accept()
+{
+    while (true)
+    {
+        int fd = accept(GazeServer::listener, nullptr, nullptr);
+        if (fd < 0)
+            return;
+
+        if (GazeServer::clients.size() >= MAX_CLIENTS)
+        {
+            Logging::Write(IL_LoggingLevel_Warn, "gaze server full, refused a client");
+            close(fd);
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+        std::unique_ptr<Client> client(new Client());
+        client->fd = fd;
+        client->mask = (1u << FRAME_GAZE_POINT) | (1u << FRAME_GAZE_FOCUS) | (1u << FRAME_PRESENCE);
+        client->policy = DROP_OLDEST;
+        client->sequence = 0;
+        client->closing = false;
+        client->frames.resize(CLIENT_FRAMES);
+        client->head = 0;
+        client->count = 0;
+        client->offset = 0;
+        client->requested = 0;
+
+        GazeServer::clients.push_back(std::move(client));
+    }
+}
+
+/**
+ * Read subscriptions, the last complete one wins. A client that hung up
+ * or sent a policy we don't know is closed.
+ * */
+void GazeServer::Receive(Client &client)
+{
+    while (true)
+    {
+        ssize_t n = recv(client.fd, client.request + client.requested, sizeof(client.request) - client.requested, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            client.closing = true;
+            return;
+        }
+
+        if (n < 0)
+            return;
+
+        client.requested += static_cast<size_t>(n);
+        if (client.requested < sizeof(client.request))
+            continue;
+
+        ServerSubscription subscription;
+        std::memcpy(&subscription, client.request, sizeof(subscription));
+        client.requested = 0;
+
+        if (subscription.policy > DROP_CLIENT)
+        {
+            client.closing = true;
+            return;
+        }
+
+        client.mask = subscription.mask;
+        client.policy = subscription.policy;
+    }
+}
+
+void GazeServer::Enqueue(Client &client, ServerFrame frame)
+{
+    frame.sequence = client.sequence++;
+
+    if (client.count == CLIENT_FRAMES)
+    {
+        GazeServer::counters.Add(COUNTER_SERVER_DROPPED);
+
+        if (client.policy == DROP_NEWEST)
+            return;
+
+        if (client.policy == DROP_CLIENT)
+        {
+            client.closing = true;
+            return;
+        }
+
+        // Drop the oldest frame not on its way yet. A partly sent one
+        // has to be finished, it moves into the slot of the next.
+        size_t next = (client.head + 1) % CLIENT_FRAMES;
+        if (client.offset)
+            client.frames[next] = client.frames[client.head];
+        client.head = next;
+        client.count--;
+    }
+
+    client.frames[(client.head + client.count) % CLIENT_FRAMES] = frame;
+    client.count++;
+}
+
+/**
+ * Send what is queued in one go, as much as the socket takes.
+ * */
+void GazeServer::Flush(Client &client)
+{
+    char *first = reinterpret_cast<char *>(&client.frames[client.head]);
+    size_t contiguous = std::min(client.count, CLIENT_FRAMES - client.head);
+
+    iovec parts[2];
+    parts[0].iov_base = first + client.offset;
+    parts[0].iov_len = contiguous * sizeof(ServerFrame) - client.offset;
+    parts[1].iov_base = client.frames.data();
+    parts[1].iov_len = (client.count - contiguous) * sizeof(ServerFrame);
+
+    msghdr message = {};
+    message.msg_iov = parts;
+    message.msg_iovlen = parts[1].iov_len ? 2 : 1;
+
+    ssize_t n = sendmsg(client.fd, &message, MSG_NOSIGNAL);
+    if (n < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            client.closing = true;
+        return;
+    }
+
+    size_t sent = client.offset + static_cast<size_t>(n);
+    size_t frames = sent / sizeof(ServerFrame);
+
+    client.head = (client.head + frames) % CLIENT_FRAMES;
+    client.count -= frames;
+    client.offset = sent % sizeof(ServerFrame);
+
+    GazeServer::counters.Add(COUNTER_SERVER_SENT, frames);
+}
+
+#endif
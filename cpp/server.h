@@ -0,0 +1,138 @@
+/**
+ * Gaze server on a Unix domain socket, for consumers that can't map the
+ * broadcast segment, e.g. other languages or sandboxed processes.
+ *
+ * The tracker thread posts frames into a ring and moves on. The server
+ * thread drains the ring every FLUSH_INTERVAL, appends each frame to the
+ * queue of every client subscribed to its type, and writes each queue
+ * with one non-blocking send. A client that reads too slowly fills its
+ * own queue and loses frames by its drop policy, nobody else waits.
+ *
+ * Everything on the socket is in host byte order. Clients receive a
+ * stream of 32 byte ServerFrames and may send an 8 byte
+ * ServerSubscription at any time to change what they get:
+ *
+ *   struct ServerSubscription sub = { 1 << FRAME_GAZE_POINT, DROP_OLDEST };
+ *   write(fd, &sub, sizeof(sub));
+ *
+ * Until then a client gets every frame type and drops its oldest.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "counters.h"
+#include "ring.h"
+
+enum FrameType : uint32_t
+{
+    // x, y in display coordinates, value the IL::Validity.
+    FRAME_GAZE_POINT = 1,
+
+    // value the interactor id, x 1 when it gained focus, 0 when it lost it.
+    // For a tracker shared by several Screens, see hub.h, the id is the
+    // space of the Screen << 48 | the id the Screen gave it.
+    FRAME_GAZE_FOCUS = 2,
+
+    // value the IL::Presence.
+    FRAME_PRESENCE = 3
+};
+
+enum DropPolicy : uint32_t
+{
+    // Keep what is queued and drop new frames until there is room.
+    DROP_NEWEST = 0,
+
+    // Make room by dropping the oldest queued frames.
+    DROP_OLDEST = 1,
+
+    // Close the connection.
+    DROP_CLIENT = 2
+};
+
+struct ServerFrame
+{
+    uint32_t type;
+
+    // Frames offered to this client so far, a gap means frames were dropped.
+    uint32_t sequence;
+
+    int64_t timestamp_us;
+    float x;
+    float y;
+    uint64_t value;
+};
+
+static_assert(sizeof(ServerFrame) == 32, "ServerFrame is a fixed wire format");
+
+struct ServerSubscription
+{
+    // Bit 1 << type for each FrameType wanted.
+    uint32_t mask;
+    uint32_t policy;
+};
+
+class GazeServer
+{
+public:
+    static const size_t MAX_CLIENTS = 64;
+
+    // Frames queued per client before its drop policy kicks in.
+    static const size_t CLIENT_FRAMES = 4096;
+
+    explicit GazeServer(PipelineCounters &counters);
+    ~GazeServer();
+
+    // Listen on the path and start the server thread. A socket left at the
+    // path by an earlier run is replaced. False if it can't listen there.
+    bool Start(const std::string &path);
+    void Stop();
+
+    // Tracker thread only, never blocks.
+    void Post(const ServerFrame &frame);
+
+private:
+    struct Client
+    {
+        int fd;
+        uint32_t mask;
+        uint32_t policy;
+        uint32_t sequence;
+        bool closing;
+
+        // Ring of queued frames, offset bytes of the first already sent.
+        std::vector<ServerFrame> frames;
+        size_t head;
+        size_t count;
+        size_t offset;
+
+        // Partial subscription read so far.
+        char request[sizeof(ServerSubscription)];
+        size_t requested;
+    };
+
+    PipelineCounters &counters;
+    SpscRing<ServerFrame, 8192> incoming;
+
+    std::string path;
+    int listener;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::vector<std::unique_ptr<Client>> clients;
+
+    void Run();
+    void Accept();
+    void Receive(Client &client);
+    void Enqueue(Client &client, ServerFrame frame);
+    void Flush(Client &client);
+};
+
+#endif // SERVER_H
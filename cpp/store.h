@@ -0,0 +1,291 @@
+/**
+ * Compact in-memory storage for long gaze point and gaze origin streams.
+ *
+ * Samples are kept in blocks of BLOCK_SAMPLES, column by column:
+ * timestamps as 32-bit microsecond deltas from the block's base,
+ * coordinates as int16 fixed point and validity as bitsets. A gaze point
+ * takes a bit over 8 bytes instead of the 24 of IL_GazePointData, a gaze
+ * origin a bit over 16 instead of 40. Iterators decode one sample at a
+ * time from the columns, a few integer operations per field.
+ *
+ * Blocks are appended as the store grows and never move, so decoded
+ * samples come out in the order they were added. Samples are only ever
+ * added at the end, so a Snapshot of the blocks taken under the lock of
+ * the writer can be decoded without it.
+ */
+
+#ifndef STORE_H
+#define STORE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+
+static const uint32_t BLOCK_SAMPLES = 4096;
+
+// How far a timestamp may go back and still be stored in the current block.
+static const IL::Timestamp REWIND_US = 1000000;
+
+/**
+ * Round to the nearest step, clamped to the int16 range.
+ * Non-finite values are stored as 0.
+ */
+inline int16_t Quantize(float value, float steps)
+{
+    if (!std::isfinite(value))
+        return 0;
+
+    float scaled = std::round(value * steps);
+    return static_cast<int16_t>(std::min(std::max(scaled, -32768.0f), 32767.0f));
+}
+
+/**
+ * Screen coordinates in quarter display units, covering +-8192.
+ */
+struct GazePointColumns
+{
+    typedef IL_GazePointData Record;
+
+    static constexpr float STEPS = 4.0f;
+
+    uint64_t valid[BLOCK_SAMPLES / 64];
+    int16_t x[BLOCK_SAMPLES];
+    int16_t y[BLOCK_SAMPLES];
+
+    void Encode(uint32_t i, const Record &record)
+    {
+        uint64_t bit = uint64_t(record.validity == IL_Validity_Valid) << (i % 64);
+        valid[i / 64] = (valid[i / 64] & ~(uint64_t(1) << (i % 64))) | bit;
+        x[i] = Quantize(record.x, STEPS);
+        y[i] = Quantize(record.y, STEPS);
+    }
+
+    void Decode(uint32_t i, Record &record) const
+    {
+        record.validity = static_cast<IL_Validity>((valid[i / 64] >> (i % 64)) & 1);
+        record.x = x[i] * (1.0f / STEPS);
+        record.y = y[i] * (1.0f / STEPS);
+    }
+};
+
+/**
+ * Eye positions in tenths of a millimetre, covering +-3.2 m.
+ */
+struct GazeOriginColumns
+{
+    typedef IL_GazeOriginData Record;
+
+    static constexpr float STEPS = 10.0f;
+
+    uint64_t leftValid[BLOCK_SAMPLES / 64];
+    uint64_t rightValid[BLOCK_SAMPLES / 64];
+    int16_t left[3][BLOCK_SAMPLES];
+    int16_t right[3][BLOCK_SAMPLES];
+
+    void Encode(uint32_t i, const Record &record)
+    {
+        uint64_t mask = ~(uint64_t(1) << (i % 64));
+        leftValid[i / 64] = (leftValid[i / 64] & mask) | (uint64_t(record.leftValidity == IL_Validity_Valid) << (i % 64));
+        rightValid[i / 64] = (rightValid[i / 64] & mask) | (uint64_t(record.rightValidity == IL_Validity_Valid) << (i % 64));
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            left[axis][i] = Quantize(record.left_xyz[axis], STEPS);
+            right[axis][i] = Quantize(record.right_xyz[axis], STEPS);
+        }
+    }
+
+    void Decode(uint32_t i, Record &record) const
+    {
+        record.leftValidity = static_cast<IL_Validity>((leftValid[i / 64] >> (i % 64)) & 1);
+        record.rightValidity = static_cast<IL_Validity>((rightValid[i / 64] >> (i % 64)) & 1);
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            record.left_xyz[axis] = left[axis][i] * (1.0f / STEPS);
+            record.right_xyz[axis] = right[axis][i] * (1.0f / STEPS);
+        }
+    }
+};
+
+template <typename Columns>
+class SampleStore
+{
+public:
+    typedef typename Columns::Record Record;
+
+private:
+    struct Block
+    {
+        IL::Timestamp base_us;
+        uint32_t count;
+        uint32_t delta_us[BLOCK_SAMPLES];
+        Columns columns;
+
+        IL::Timestamp Timestamp(uint32_t i) const { return base_us + delta_us[i]; }
+    };
+
+    // A block and the samples of it a snapshot sees.
+    struct Slice
+    {
+        const Block *block;
+        uint32_t count;
+    };
+
+    std::vector<std::unique_ptr<Block>> blocks;
+    size_t size;
+
+public:
+    SampleStore()
+    {
+        SampleStore::size = 0;
+    }
+
+    /**
+     * Forward iterator decoding one sample per step.
+     */
+    class Iterator
+    {
+    private:
+        const Slice *slice;
+        uint32_t index;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Record value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Record *pointer;
+        typedef Record reference;
+
+        Iterator(const Slice *slice, uint32_t index) : slice(slice), index(index) {}
+
+        Record operator*() const
+        {
+            const Block &b = *slice->block;
+
+            Record record = {};
+            record.timestamp_us = b.Timestamp(index);
+            b.columns.Decode(index, record);
+            return record;
+        }
+
+        IL::Timestamp Timestamp() const { return slice->block->Timestamp(index); }
+
+        Iterator &operator++()
+        {
+            if (++index == slice->count)
+            {
+                ++slice;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator &other) const { return slice == other.slice && index == other.index; }
+        bool operator!=(const Iterator &other) const { return !(*this == other); }
+    };
+
+    /**
+     * The samples from a timestamp on, as far as they were added when it
+     * was taken, the first one at or after from_us.
+     */
+    class Snapshot
+    {
+    private:
+        std::vector<Slice> slices;
+        uint32_t first;
+
+        friend class SampleStore;
+
+    public:
+        Snapshot() : first(0) {}
+
+        Iterator begin() const { return Iterator(Snapshot::slices.data(), Snapshot::first); }
+        Iterator end() const { return Iterator(Snapshot::slices.data() + Snapshot::slices.size(), 0); }
+    };
+
+    /**
+     * Start a new block when the current one is full or the timestamp
+     * does not fit its delta. The base of a block is REWIND_US before its
+     * first sample, so timestamps that jitter back a little stay in it.
+     * */
+    void Add(const Record &record)
+    {
+        Block *block = SampleStore::blocks.empty() ? nullptr : SampleStore::blocks.back().get();
+
+        IL::Timestamp delta_us = block ? record.timestamp_us - block->base_us : -1;
+        if (!block || block->count == BLOCK_SAMPLES || delta_us < 0 || delta_us > UINT32_MAX)
+        {
+            block = new Block();
+            block->base_us = record.timestamp_us - REWIND_US;
+            block->count = 0;
+            SampleStore::blocks.emplace_back(block);
+            delta_us = REWIND_US;
+        }
+
+        block->delta_us[block->count] = static_cast<uint32_t>(delta_us);
+        block->columns.Encode(block->count, record);
+        block->count++;
+        SampleStore::size++;
+    }
+
+    void Clear()
+    {
+        SampleStore::blocks.clear();
+        SampleStore::size = 0;
+    }
+
+    size_t Size() const { return SampleStore::size; }
+
+    // Memory held by the samples.
+    size_t Bytes() const { return SampleStore::blocks.size() * sizeof(Block); }
+
+    /**
+     * The samples from the first at or after from_us, assuming timestamps
+     * only go up, to the last of the block holding to_us. Copies a pointer
+     * per block, so it is cheap to take under a lock.
+     * */
+    Snapshot Take(IL::Timestamp from_us, IL::Timestamp to_us) const
+    {
+        Snapshot snapshot;
+
+        const std::unique_ptr<Block> *first = SampleStore::blocks.data();
+        const std::unique_ptr<Block> *last = first + SampleStore::blocks.size();
+
+        // The first block whose last sample is not too early.
+        const std::unique_ptr<Block> *block = std::partition_point(first, last, [&](const std::unique_ptr<Block> &b) {
+            return b->Timestamp(b->count - 1) < from_us;
+        });
+
+        if (block == last)
+            return snapshot;
+
+        if (from_us > (*block)->base_us)
+        {
+            const uint32_t *delta = (*block)->delta_us;
+            IL::Timestamp offset_us = from_us - (*block)->base_us;
+            snapshot.first = static_cast<uint32_t>(std::lower_bound(delta, delta + (*block)->count, offset_us) - delta);
+        }
+
+        for (; block != last && (*block)->base_us < to_us; ++block)
+            snapshot.slices.push_back({block->get(), (*block)->count});
+
+        return snapshot;
+    }
+};
+
+typedef SampleStore<GazePointColumns> GazePointStore;
+typedef SampleStore<GazeOriginColumns> GazeOriginStore;
+
+#endif // STORE_H
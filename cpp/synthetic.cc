@@ -0,0 +1,230 @@
+#include "synthetic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+const SyntheticOptions SyntheticAdapter::DEFAULTS = {1000.0, 5.0f, 0.0, 0.0, 1};
+
+// Durations of the scripted movements.
+static const double FIXATION_MIN_US = 150000.0;
+static const double FIXATION_MAX_US = 400000.0;
+static const double SACCADE_MIN_US = 20000.0;
+static const double SACCADE_US_PER_SCREEN = 80000.0;
+static const double PURSUIT_MIN_US = 400000.0;
+static const double PURSUIT_MAX_US = 1200000.0;
+
+// Share of movements after a fixation that are pursuits, not saccades.
+static const double PURSUIT_SHARE = 0.2;
+
+// Mean length of a dropout burst, long enough to look like a blink.
+static const double DROPOUT_BURST_US = 100000.0;
+
+SyntheticAdapter::SyntheticAdapter(float width, float height, const SyntheticOptions &options)
+    : Adapter(width, height), random(options.seed), noise(0.0f, options.noise > 0.0f ? options.noise : 1.0f), uniform(0.0, 1.0)
+{
+    SyntheticAdapter::width = width;
+    SyntheticAdapter::height = height;
+    SyntheticAdapter::options = options;
+    SyntheticAdapter::options.rate = std::min(std::max(options.rate, MIN_RATE), MAX_RATE);
+    SyntheticAdapter::options.dropout = std::min(std::max(options.dropout, 0.0), 0.99);
+
+    SyntheticAdapter::period_us = 1000000.0 / SyntheticAdapter::options.rate;
+    SyntheticAdapter::started = false;
+    SyntheticAdapter::sample = 0;
+    SyntheticAdapter::origin_us = 0;
+
+    // Chance per valid sample to start a burst, so that the expected
+    // fraction of lost samples matches the requested dropout.
+    double dropout = SyntheticAdapter::options.dropout;
+    double burst = std::max(1.0, DROPOUT_BURST_US / SyntheticAdapter::period_us);
+    SyntheticAdapter::dropoutStart = dropout / ((1.0 - dropout) * burst);
+    SyntheticAdapter::dropping = 0;
+
+    // Start with a fixation in the middle of the display.
+    SyntheticAdapter::segment = {Movement::Fixation, 0, 0, width / 2, height / 2, width / 2, height / 2};
+    SyntheticAdapter::fixating = false;
+
+    SyntheticAdapter::provided.push_back(IL_StreamInputType_GazePointData);
+    SyntheticAdapter::provided.push_back(IL_StreamInputType_PresenceData);
+}
+
+IL::Timestamp SyntheticAdapter::Timestamp(uint64_t sample) const
+{
+    return SyntheticAdapter::origin_us + static_cast<IL::Timestamp>(sample * SyntheticAdapter::period_us);
+}
+
+std::chrono::steady_clock::time_point SyntheticAdapter::Due(uint64_t sample) const
+{
+    return SyntheticAdapter::start + std::chrono::microseconds(static_cast<int64_t>(sample * SyntheticAdapter::period_us));
+}
+
+bool SyntheticAdapter::Finished() const
+{
+    return SyntheticAdapter::options.duration > 0.0 &&
+           SyntheticAdapter::sample * SyntheticAdapter::period_us >= SyntheticAdapter::options.duration * 1000000.0;
+}
+
+/**
+ * The device stays connected until the duration runs out.
+ * */
+bool SyntheticAdapter::WaitForConnection()
+{
+    return !Finished();
+}
+
+bool SyntheticAdapter::WaitForData()
+{
+    if (Finished())
+        return false;
+
+    if (!SyntheticAdapter::started)
+    {
+        SyntheticAdapter::started = true;
+        SyntheticAdapter::start = std::chrono::steady_clock::now();
+        SyntheticAdapter::origin_us = std::chrono::duration_cast<std::chrono::microseconds>(SyntheticAdapter::start.time_since_epoch()).count();
+        SyntheticAdapter::segment.end_us = SyntheticAdapter::origin_us;
+    }
+
+    std::this_thread::sleep_until(Due(SyntheticAdapter::sample));
+    return true;
+}
+
+/**
+ * Post every sample that is due, a batch if the caller fell behind.
+ * */
+void SyntheticAdapter::Update()
+{
+    if (SyntheticAdapter::sample == 0)
+        PostPresence({SyntheticAdapter::origin_us, IL_Presence_Present});
+
+    auto now = std::chrono::steady_clock::now();
+
+    while (!Finished() && Due(SyntheticAdapter::sample) <= now)
+        Post(SyntheticAdapter::sample++);
+}
+
+/**
+ * Script the movement that follows the current one. Fixations
+ * alternate with saccades or pursuits to a random point.
+ * */
+void SyntheticAdapter::NextSegment(IL::Timestamp start_us)
+{
+    Segment &s = SyntheticAdapter::segment;
+
+    float x = s.x1;
+    float y = s.y1;
+    s.x0 = x;
+    s.y0 = y;
+    s.start_us = start_us;
+
+    if (!SyntheticAdapter::fixating)
+    {
+        SyntheticAdapter::fixating = true;
+
+        double duration_us = FIXATION_MIN_US + uniform(random) * (FIXATION_MAX_US - FIXATION_MIN_US);
+        s.movement = Movement::Fixation;
+        s.end_us = start_us + static_cast<IL::Timestamp>(duration_us);
+        return;
+    }
+
+    SyntheticAdapter::fixating = false;
+
+    s.x1 = static_cast<float>(uniform(random) * SyntheticAdapter::width);
+    s.y1 = static_cast<float>(uniform(random) * SyntheticAdapter::height);
+
+    double duration_us;
+    if (uniform(random) < PURSUIT_SHARE)
+    {
+        s.movement = Movement::Pursuit;
+        duration_us = PURSUIT_MIN_US + uniform(random) * (PURSUIT_MAX_US - PURSUIT_MIN_US);
+    }
+    else
+    {
+        // Longer saccades take longer, as the main sequence says.
+        float dx = (s.x1 - x) / SyntheticAdapter::width;
+        float dy = (s.y1 - y) / SyntheticAdapter::height;
+        s.movement = Movement::Saccade;
+        duration_us = SACCADE_MIN_US + std::sqrt(dx * dx + dy * dy) * SACCADE_US_PER_SCREEN;
+    }
+
+    s.end_us = start_us + static_cast<IL::Timestamp>(duration_us);
+}
+
+/**
+ * Noise free position at the given time within the current segment.
+ * */
+void SyntheticAdapter::Position(IL::Timestamp timestamp_us, float &x, float &y) const
+{
+    const Segment &s = SyntheticAdapter::segment;
+
+    float t = 1.0f;
+    if (s.end_us > s.start_us)
+        t = static_cast<float>(timestamp_us - s.start_us) / static_cast<float>(s.end_us - s.start_us);
+    t = std::min(std::max(t, 0.0f), 1.0f);
+
+    switch (s.movement)
+    {
+    case Movement::Fixation:
+        t = 0.0f;
+        break;
+    case Movement::Saccade:
+        // Accelerate, then brake.
+        t = t * t * (3.0f - 2.0f * t);
+        break;
+    case Movement::Pursuit:
+        break;
+    }
+
+    x = s.x0 + (s.x1 - s.x0) * t;
+    y = s.y0 + (s.y1 - s.y0) * t;
+}
+
+void SyntheticAdapter::Generate(size_t count, std::vector<IL_GazePointData> &samples)
+{
+    samples.reserve(samples.size() + count);
+
+    for (size_t i = 0; i < count; i++)
+        samples.push_back(Next(SyntheticAdapter::sample++));
+}
+
+IL_GazePointData SyntheticAdapter::Next(uint64_t sample)
+{
+    IL::Timestamp timestamp_us = Timestamp(sample);
+
+    while (timestamp_us >= SyntheticAdapter::segment.end_us)
+        NextSegment(SyntheticAdapter::segment.end_us);
+
+    IL_GazePointData data = {};
+    data.timestamp_us = timestamp_us;
+
+    if (SyntheticAdapter::dropping == 0 && uniform(random) < SyntheticAdapter::dropoutStart)
+    {
+        double burst_us = DROPOUT_BURST_US * (0.5 + uniform(random));
+        SyntheticAdapter::dropping = std::max<uint64_t>(1, static_cast<uint64_t>(burst_us / SyntheticAdapter::period_us));
+    }
+
+    if (SyntheticAdapter::dropping > 0)
+    {
+        SyntheticAdapter::dropping--;
+        data.validity = IL_Validity_Invalid;
+    }
+    else
+    {
+        Position(timestamp_us, data.x, data.y);
+        data.validity = IL_Validity_Valid;
+
+        if (SyntheticAdapter::options.noise > 0.0f)
+        {
+            data.x += noise(random);
+            data.y += noise(random);
+        }
+    }
+
+    return data;
+}
+
+void SyntheticAdapter::Post(uint64_t sample)
+{
+    PostGazePoint(Next(sample));
+}
@@ -0,0 +1,106 @@
+/**
+ * Adapter that generates gaze instead of reading it from a device,
+ * for stress and throughput testing.
+ *
+ * The trajectory is a random script of fixations, saccades and smooth
+ * pursuits over the display area, with gaussian noise on top and bursts
+ * of invalid samples for dropout. The same seed gives the same script.
+ * Samples are posted at a fixed rate with ideal timestamps, from 30 Hz
+ * up to 10 kHz, batched per update when the tracker thread is slower
+ * than the rate.
+ */
+
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "adapter.h"
+
+struct SyntheticOptions
+{
+    // Samples per second, clamped to [MIN_RATE, MAX_RATE].
+    double rate;
+
+    // Standard deviation of the noise, in display units.
+    float noise;
+
+    // Fraction of samples lost to dropout, 0 to 1.
+    double dropout;
+
+    // Seconds to run before disconnecting, 0 runs forever.
+    double duration;
+
+    unsigned seed;
+};
+
+class SyntheticAdapter : public Adapter
+{
+public:
+    static constexpr double MIN_RATE = 30.0;
+    static constexpr double MAX_RATE = 10000.0;
+    static const SyntheticOptions DEFAULTS;
+
+    SyntheticAdapter(float width, float height, const SyntheticOptions &options);
+
+    // Script the next count samples without posting them, for benchmarks.
+    void Generate(size_t count, std::vector<IL_GazePointData> &samples);
+
+protected:
+    bool WaitForConnection() override;
+    bool WaitForData() override;
+    void Update() override;
+
+private:
+    enum class Movement
+    {
+        Fixation,
+        Saccade,
+        Pursuit
+    };
+
+    // One scripted movement, from one point to another.
+    struct Segment
+    {
+        Movement movement;
+        IL::Timestamp start_us;
+        IL::Timestamp end_us;
+        float x0, y0;
+        float x1, y1;
+    };
+
+    float width;
+    float height;
+    SyntheticOptions options;
+
+    std::mt19937 random;
+    std::normal_distribution<float> noise;
+    std::uniform_real_distribution<double> uniform;
+
+    Segment segment;
+    bool fixating;
+
+    // Samples left in the current dropout burst.
+    uint64_t dropping;
+    double dropoutStart;
+
+    // Sample clock, timestamps are ideal multiples of the period.
+    bool started;
+    uint64_t sample;
+    double period_us;
+    IL::Timestamp origin_us;
+    std::chrono::steady_clock::time_point start;
+
+    IL::Timestamp Timestamp(uint64_t sample) const;
+    std::chrono::steady_clock::time_point Due(uint64_t sample) const;
+    bool Finished() const;
+
+    void NextSegment(IL::Timestamp start_us);
+    void Position(IL::Timestamp timestamp_us, float &x, float &y) const;
+    IL_GazePointData Next(uint64_t sample);
+    void Post(uint64_t sample);
+};
+
+#endif // SYNTHETIC_H
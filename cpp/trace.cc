@@ -0,0 +1,236 @@
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct TraceRecord
+{
+    const char *name;
+    int64_t start_ns;
+    int64_t end_ns;
+};
+
+struct TraceBuffer
+{
+    const char *thread;
+    uint32_t tid;
+
+    // Session the spans belong to, a thread starts over when it sees a new one.
+    std::atomic<uint32_t> generation;
+    std::atomic<size_t> count;
+    std::atomic<uint64_t> dropped;
+    std::unique_ptr<TraceRecord[]> spans;
+
+    // Set under the lock once the owning thread exited.
+    bool exited;
+};
+
+// Hands a thread's buffer back when the thread exits.
+struct TraceOwner
+{
+    TraceBuffer *buffer = nullptr;
+
+    // Session the thread was last refused a buffer in, plus one.
+    uint32_t refused = 0;
+
+    ~TraceOwner();
+};
+
+// Buffers are only added, under the lock, and never freed. Those of
+// exited threads are handed to new threads once their spans are no
+// longer part of the last session.
+static std::mutex registryLock;
+static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+// Writes in progress, only changed under the lock.
+static std::atomic<unsigned> writing(0);
+
+static std::atomic<uint32_t> generation(0);
+static std::atomic<int64_t> origin_ns(0);
+
+// Spans of threads that found every buffer taken.
+static std::atomic<uint64_t> unbuffered(0);
+
+static thread_local TraceOwner local;
+static thread_local const char *threadName = nullptr;
+
+TraceOwner::~TraceOwner()
+{
+    if (!TraceOwner::buffer)
+        return;
+
+    std::lock_guard<std::mutex> guard(registryLock);
+    TraceOwner::buffer->exited = true;
+}
+
+std::atomic<bool> Tracing::enabled(false);
+
+int64_t Tracing::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Refused while the last session is being written, whose buffers
+ * the threads would otherwise start to overwrite.
+ * */
+bool Tracing::Start()
+{
+    std::lock_guard<std::mutex> guard(registryLock);
+
+    if (writing.load(std::memory_order_relaxed))
+        return false;
+
+    origin_ns = Now();
+    generation++;
+    unbuffered = 0;
+    Tracing::enabled = true;
+    return true;
+}
+
+void Tracing::Stop()
+{
+    Tracing::enabled = false;
+}
+
+void Tracing::NameThread(const char *name)
+{
+    threadName = name;
+
+    if (local.buffer)
+        local.buffer->thread = name;
+}
+
+/**
+ * Take the buffer of an exited thread whose spans are from an earlier
+ * session, or a new one while there are fewer than MAX_BUFFERS. Null if
+ * neither, then the thread asks again in the next session.
+ * */
+static TraceBuffer *Acquire()
+{
+    uint32_t current = generation.load(std::memory_order_relaxed);
+    if (local.refused == current + 1)
+        return nullptr;
+
+    std::lock_guard<std::mutex> guard(registryLock);
+
+    for (const std::unique_ptr<TraceBuffer> &buffer : buffers)
+    {
+        if (buffer->exited && buffer->generation.load(std::memory_order_relaxed) != current)
+        {
+            buffer->exited = false;
+            buffer->thread = threadName;
+            return buffer.get();
+        }
+    }
+
+    if (buffers.size() == Tracing::MAX_BUFFERS)
+    {
+        local.refused = current + 1;
+        return nullptr;
+    }
+
+    std::unique_ptr<TraceBuffer> buffer(new TraceBuffer());
+    buffer->thread = threadName;
+    buffer->tid = static_cast<uint32_t>(buffers.size() + 1);
+    buffer->generation = 0;
+    buffer->count = 0;
+    buffer->dropped = 0;
+    buffer->exited = false;
+    buffer->spans.reset(new TraceRecord[Tracing::BUFFER_SPANS]);
+
+    buffers.push_back(std::move(buffer));
+    return buffers.back().get();
+}
+
+void Tracing::Add(const char *name, int64_t start_ns, int64_t end_ns)
+{
+    if (!local.buffer)
+        local.buffer = Acquire();
+
+    TraceBuffer *buffer = local.buffer;
+    if (!buffer)
+    {
+        unbuffered.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Reset before publishing the new generation, so a reader that sees it never sees old spans.
+    uint32_t current = generation.load(std::memory_order_relaxed);
+    if (buffer->generation.load(std::memory_order_relaxed) != current)
+    {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->generation.store(current, std::memory_order_release);
+    }
+
+    size_t i = buffer->count.load(std::memory_order_relaxed);
+    if (i == BUFFER_SPANS)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->spans[i] = {name, start_ns, end_ns};
+    buffer->count.store(i + 1, std::memory_order_release);
+}
+
+/**
+ * Complete events ("X") with microsecond timestamps from the start of
+ * the session, and the thread names as metadata events. Threads may
+ * keep tracing meanwhile, the spans they add are left out.
+ * */
+bool Tracing::Write(const std::string &path)
+{
+    std::vector<TraceBuffer *> session;
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+
+        writing.fetch_add(1, std::memory_order_relaxed);
+        for (const std::unique_ptr<TraceBuffer> &buffer : buffers)
+        {
+            if (buffer->generation.load(std::memory_order_acquire) == generation)
+                session.push_back(buffer.get());
+        }
+    }
+
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    if (file)
+    {
+        int64_t origin = origin_ns;
+        uint64_t dropped = unbuffered.load(std::memory_order_relaxed);
+
+        std::fprintf(file, "{\"traceEvents\":[\n");
+
+        bool first = true;
+        for (TraceBuffer *buffer : session)
+        {
+            std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                         first ? "" : ",\n", buffer->tid, buffer->thread ? buffer->thread : "thread");
+            first = false;
+
+            size_t count = buffer->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++)
+            {
+                const TraceRecord &span = buffer->spans[i];
+                std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"focus\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                             span.name, buffer->tid, (span.start_ns - origin) / 1000.0, (span.end_ns - span.start_ns) / 1000.0);
+            }
+
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+
+        std::fprintf(file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":%llu}}\n", static_cast<unsigned long long>(dropped));
+    }
+
+    bool ok = file && !std::ferror(file);
+    if (file)
+        ok = std::fclose(file) == 0 && ok;
+
+    std::lock_guard<std::mutex> guard(registryLock);
+    writing.fetch_sub(1, std::memory_order_relaxed);
+    return ok;
+}
@@ -0,0 +1,77 @@
+/**
+ * Span instrumentation of the native pipeline, exported as Chrome
+ * trace-event JSON for chrome://tracing or Perfetto.
+ *
+ * A TraceSpan times the scope it lives in. While tracing is off that is
+ * one relaxed atomic load. While on, the span is appended to a buffer
+ * owned by its thread: the thread is the only writer and publishes how
+ * many spans it wrote, so nothing is locked on the hot path. A thread's
+ * buffer is taken the first time it traces and kept after the thread
+ * exits, so spans of finished threads can still be exported. Once they
+ * belong to an earlier session the buffer goes to the next new thread.
+ * Spans that don't fit, or of threads past MAX_BUFFERS, are counted and
+ * dropped.
+ *
+ * Span names must be string literals, only the pointer is kept.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class Tracing
+{
+public:
+    // Spans kept per thread and tracing session.
+    static const size_t BUFFER_SPANS = 1 << 16;
+
+    // Buffers of 1.5 MB each, at most one per thread tracing at once.
+    static const size_t MAX_BUFFERS = 64;
+
+    static bool Enabled() { return Tracing::enabled.load(std::memory_order_relaxed); }
+
+    // Forget the spans of the previous session and start recording,
+    // false while it is being written.
+    static bool Start();
+    static void Stop();
+
+    // Write the spans of the last session, false if the file can't be written.
+    static bool Write(const std::string &path);
+
+    // Name the calling thread in the trace, name must be a literal.
+    static void NameThread(const char *name);
+
+    static int64_t Now();
+    static void Add(const char *name, int64_t start_ns, int64_t end_ns);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+    {
+        TraceSpan::name = name;
+        TraceSpan::start_ns = Tracing::Enabled() ? Tracing::Now() : 0;
+    }
+
+    ~TraceSpan()
+    {
+        if (TraceSpan::start_ns)
+            Tracing::Add(TraceSpan::name, TraceSpan::start_ns, Tracing::Now());
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name;
+    int64_t start_ns;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,78 @@
+#include "tracer.h"
+
+void Tracer::Init(v8::Local<v8::Object> exports)
+{
+    NODE_SET_METHOD(exports, "StartTracing", Tracer::StartTracing);
+    NODE_SET_METHOD(exports, "StopTracing", Tracer::StopTracing);
+}
+
+/**
+ * Start a new tracing session. Returns false while the
+ * last one is still being written.
+ * */
+void Tracer::StartTracing(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Tracing::NameThread("js");
+
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, Tracing::Start()));
+}
+
+/**
+ * Stop tracing and write the session as Chrome trace-event JSON.
+ *
+ * params
+ * path       string
+ * callback   optional, called with true once the file is written
+ * */
+void Tracer::StopTracing(const v8::FunctionCallbackInfo<v8::Value> &args)
+{
+    v8::Isolate *isolate = args.GetIsolate();
+
+    Tracing::Stop();
+
+    if (!args[0]->IsString())
+    {
+        Logging::Write(IL_LoggingLevel_Error, "argument must be a path");
+        return;
+    }
+
+    std::unique_ptr<Export> trace(new Export());
+    trace->path = *v8::String::Utf8Value(isolate, args[0]);
+    trace->ok = false;
+    trace->request.data = trace.get();
+    trace->context.Reset(isolate, isolate->GetCurrentContext());
+
+    if (args[1]->IsFunction())
+        trace->callback.Reset(isolate, args[1].As<v8::Function>());
+
+    uv_queue_work(node::GetCurrentEventLoop(isolate), &trace->request, Tracer::Run, Tracer::Finish);
+    trace.release();
+}
+
+void Tracer::Run(uv_work_t *request)
+{
+    Export *trace = static_cast<Export *>(request->data);
+
+    trace->ok = Tracing::Write(trace->path);
+}
+
+void Tracer::Finish(uv_work_t *request, int status)
+{
+    std::unique_ptr<Export> trace(static_cast<Export *>(request->data));
+    v8::Isolate *isolate = v8::Isolate::GetCurrent();
+
+    if (trace->callback.IsEmpty())
+        return;
+
+    v8::HandleScope handle_scope(isolate);
+
+    v8::Local<v8::Context> ctx = trace->context.Get(isolate);
+    v8::Context::Scope context_scope(ctx);
+
+    const unsigned int argc = 1;
+    v8::Local<v8::Value> argv[argc] = {v8::Boolean::New(isolate, trace->ok)};
+
+    node::MakeCallback(isolate, ctx->Global(), trace->callback.Get(isolate), argc, argv, {0, 0});
+}
@@ -0,0 +1,44 @@
+/**
+ * JS binding of the span instrumentation, see trace.h:
+ *
+ *   Screen.StartTracing();
+ *   ...
+ *   Screen.StopTracing('trace.json', (ok) => { ... });
+ *
+ * The JSON is written on the libuv thread pool.
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <memory>
+#include <string>
+#include <node.h>
+#include <v8.h>
+#include <uv.h>
+
+#include "logging.h"
+#include "trace.h"
+
+class Tracer
+{
+private:
+    struct Export
+    {
+        uv_work_t request;
+        std::string path;
+        bool ok;
+        v8::Global<v8::Function> callback;
+        v8::Global<v8::Context> context;
+    };
+
+    static void StartTracing(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void StopTracing(const v8::FunctionCallbackInfo<v8::Value> &args);
+    static void Run(uv_work_t *request);
+    static void Finish(uv_work_t *request, int status);
+
+public:
+    static void Init(v8::Local<v8::Object> exports);
+};
+
+#endif // TRACER_H
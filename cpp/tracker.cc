@@ -0,0 +1,903 @@
+#include "tracker.h"
+
+#include "broadcast.h"
+#include "interactortable.h"
+#include "server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// connectionIntervalMs handed to WaitAndUpdate while the user is present or away.
+static const unsigned long ACTIVE_CONNECTION_INTERVAL_MS = 1000;
+static const unsigned long IDLE_CONNECTION_INTERVAL_MS = 5000;
+
+// Pause between updates while the user is away. The IL needs at least
+// 10 updates per second to keep the device connection alive.
+static const std::chrono::milliseconds IDLE_UPDATE_INTERVAL(100);
+
+Tracker::Tracker(float width, float height, std::unique_ptr<Adapter> adapter)
+    : adapter(std::move(adapter)), blinks(Tracker::OnBlinkEvent, this)
+{
+    Tracker::running = false;
+    Tracker::clientsChanged = false;
+    Tracker::streams = 0;
+    Tracker::subscribed = 0;
+    Tracker::presence = IL::Presence::Unknown;
+    Tracker::power = PowerState::Active;
+    Tracker::qualityChanged = false;
+    Tracker::qualityStats = Tracker::quality.Stats();
+    Tracker::stopRecording = false;
+    Tracker::storing = false;
+    Tracker::tableReads = 0;
+
+    // Init the tobii interaction library
+    if (Tracker::adapter)
+        Tracker::tobii = IL::UniqueInteractionLibPtr(IL::CreateInteractionLib(IL::FieldOfUse::Interactive, Logging::ILLogger(), Tracker::adapter->Functions()));
+    else
+        Tracker::tobii = IL::UniqueInteractionLibPtr(IL::CreateInteractionLib(IL::FieldOfUse::Interactive, Logging::ILLogger()));
+
+    Tracker::tobii->CoordinateTransformAddOrUpdateDisplayArea(width, height);
+    Tracker::tobii->CoordinateTransformSetOriginOffset(0.0f, 0.0f);
+
+    // Presence drives the power state of the update loop.
+    Tracker::tobii->SubscribePresenceData(Tracker::OnPresenceData, this);
+}
+
+Tracker::~Tracker()
+{
+    Stop();
+
+    if (Tracker::recorder)
+        Tracker::recorder->Close();
+}
+
+void Tracker::Attach(const std::shared_ptr<TrackerClient> &client)
+{
+    {
+        std::lock_guard<std::mutex> guard(Tracker::clientLock);
+        Tracker::attached.push_back(client);
+        Tracker::clientsChanged = true;
+    }
+
+    if (Tracker::running)
+        return;
+
+    Tracker::running = true;
+    Tracker::thread = std::thread(&Tracker::Run, this);
+}
+
+/**
+ * The tracker thread keeps its reference until the next update, events
+ * may still be queued for the client until then.
+ * */
+void Tracker::Detach(const TrackerClient *client)
+{
+    // Even a client that never listened may have added interactors.
+    if (client->space)
+    {
+        std::lock_guard<std::mutex> guard(Tracker::interactorLock);
+        Tracker::pendingDetached.push_back(client->space);
+    }
+
+    std::lock_guard<std::mutex> guard(Tracker::clientLock);
+
+    for (auto it = Tracker::attached.begin(); it != Tracker::attached.end(); it++)
+    {
+        if (it->get() == client)
+        {
+            Tracker::attached.erase(it);
+            Tracker::clientsChanged = true;
+            return;
+        }
+    }
+}
+
+void Tracker::Stop()
+{
+    if (!Tracker::running)
+        return;
+
+    Tracker::running = false;
+    Tracker::thread.join();
+}
+
+/**
+ * Ask for more streams to be delivered. Takes effect on the next update.
+ * */
+void Tracker::Enable(unsigned streams)
+{
+    Tracker::streams |= streams;
+}
+
+/**
+ * Queue interactors to be added or updated in one transaction on the next update.
+ * */
+void Tracker::AddOrUpdateInteractors(const std::vector<Interactor> &interactors)
+{
+    std::lock_guard<std::mutex> guard(Tracker::interactorLock);
+
+    Tracker::pendingInteractors.insert(Tracker::pendingInteractors.end(), interactors.begin(), interactors.end());
+}
+
+bool Tracker::AttachInteractorTable(const std::string &name, uint32_t space)
+{
+    std::unique_ptr<InteractorTableReader> table(new InteractorTableReader());
+    if (!table->Open(name))
+        return false;
+
+    std::lock_guard<std::mutex> guard(Tracker::interactorLock);
+    Tracker::pendingTables.emplace_back(space, std::move(table));
+    return true;
+}
+
+IL::Presence Tracker::GetPresence() const
+{
+    return Tracker::presence;
+}
+
+PowerState Tracker::GetPowerState() const
+{
+    return Tracker::power;
+}
+
+/**
+ * Latest data quality metrics, safe to call from any thread.
+ * */
+QualityStats Tracker::GetQuality()
+{
+    std::lock_guard<std::mutex> guard(Tracker::qualityLock);
+
+    return Tracker::qualityStats;
+}
+
+void Tracker::ReadCounters(uint64_t values[COUNTERS])
+{
+    size_t focus = 0;
+    size_t points = 0;
+    size_t blinks = 0;
+    {
+        std::lock_guard<std::mutex> guard(Tracker::clientLock);
+        for (const std::shared_ptr<TrackerClient> &client : Tracker::attached)
+        {
+            focus += client->focusEvents.Size();
+            points += client->gazePoints.Size();
+            blinks += client->blinkEvents.Size();
+        }
+    }
+
+    Tracker::counters.Set(COUNTER_DEPTH_GAZE_FOCUS, focus);
+    Tracker::counters.Set(COUNTER_DEPTH_GAZE_POINT, points);
+    Tracker::counters.Set(COUNTER_DEPTH_BLINK, blinks);
+
+    Tracker::counters.Read(values);
+}
+
+/**
+ * Open the file right away so errors can be reported,
+ * recording starts with the next update.
+ * */
+bool Tracker::StartRecording(const std::string &path, bool compressed)
+{
+    std::unique_ptr<Recorder> recorder(new Recorder());
+    if (!recorder->Open(path, compressed))
+        return false;
+
+    std::lock_guard<std::mutex> guard(Tracker::recordingLock);
+    Tracker::pendingRecorder = std::move(recorder);
+    return true;
+}
+
+/**
+ * Stop recording with the next update. The file is complete
+ * once the I/O thread has flushed the remaining blocks.
+ * */
+void Tracker::StopRecording()
+{
+    std::lock_guard<std::mutex> guard(Tracker::recordingLock);
+    Tracker::pendingRecorder.reset();
+    Tracker::stopRecording = true;
+}
+
+/**
+ * Allocates the buffers, recording starts when the tracker does.
+ * */
+void Tracker::EnableFlightRecorder(double seconds, double rate)
+{
+    Tracker::flight = std::unique_ptr<FlightRecorder>(new FlightRecorder(Tracker::counters, seconds, rate));
+    Enable(STREAM_FLIGHT_RECORDER);
+}
+
+/**
+ * Write the flight recorder window around now to a file in the background,
+ * the outcome arrives through dumpResults.
+ * */
+bool Tracker::Dump(const std::string &path, double secondsAfter, bool compressed)
+{
+    if (!Tracker::flight)
+        return false;
+
+    return Tracker::flight->Dump(path, secondsAfter, compressed);
+}
+
+bool Tracker::EnableBroadcast(const std::string &name, double seconds, double rate)
+{
+    std::unique_ptr<BroadcastWriter> broadcast(new BroadcastWriter(Tracker::counters));
+    if (!broadcast->Open(name, static_cast<uint32_t>(std::max(1.0, std::ceil(seconds * rate)))))
+        return false;
+
+    Tracker::broadcast = std::move(broadcast);
+    Enable(STREAM_BROADCAST);
+    return true;
+}
+
+bool Tracker::EnableServer(const std::string &path)
+{
+    std::unique_ptr<GazeServer> server(new GazeServer(Tracker::counters));
+    if (!server->Start(path))
+        return false;
+
+    Tracker::server = std::move(server);
+    Enable(STREAM_SERVER);
+    return true;
+}
+
+void Tracker::EnableHistory(double seconds, double rate)
+{
+    uint32_t capacity = static_cast<uint32_t>(std::max(1.0, std::ceil(seconds * rate)));
+
+    Tracker::history = std::unique_ptr<GazeHistory>(new GazeHistory(capacity));
+    Enable(STREAM_HISTORY);
+}
+
+/**
+ * Safe to read from any thread, null unless enabled.
+ * */
+const GazeHistory *Tracker::History() const
+{
+    return Tracker::history.get();
+}
+
+/**
+ * Before Start only. Blocks are allocated as the store grows,
+ * one for every few thousand samples.
+ * */
+void Tracker::EnableStore()
+{
+    Tracker::storing = true;
+    Enable(STREAM_STORE);
+}
+
+/**
+ * Only the blocks of the range are looked up under the lock, the tracker
+ * thread keeps adding samples while they are decoded.
+ * */
+void Tracker::ReadStore(uint32_t type, IL::Timestamp from_us, IL::Timestamp to_us, std::vector<double> &values)
+{
+    GazePointStore::Snapshot points;
+    GazeOriginStore::Snapshot origins;
+    {
+        std::lock_guard<std::mutex> guard(Tracker::storeLock);
+
+        if (type == RECORD_GAZE_POINT)
+            points = Tracker::storedPoints.Take(from_us, to_us);
+        else if (type == RECORD_GAZE_ORIGIN)
+            origins = Tracker::storedOrigins.Take(from_us, to_us);
+    }
+
+    if (type == RECORD_GAZE_POINT)
+    {
+        for (auto it = points.begin(); it != points.end() && it.Timestamp() < to_us; ++it)
+        {
+            IL::GazePointData p = *it;
+            values.insert(values.end(), {static_cast<double>(p.timestamp_us), static_cast<double>(p.validity), p.x, p.y});
+        }
+    }
+    else if (type == RECORD_GAZE_ORIGIN)
+    {
+        for (auto it = origins.begin(); it != origins.end() && it.Timestamp() < to_us; ++it)
+        {
+            IL::GazeOriginData o = *it;
+            values.insert(values.end(), {static_cast<double>(o.timestamp_us),
+                                         static_cast<double>(o.leftValidity), o.left_xyz[0], o.left_xyz[1], o.left_xyz[2],
+                                         static_cast<double>(o.rightValidity), o.right_xyz[0], o.right_xyz[1], o.right_xyz[2]});
+        }
+    }
+}
+
+void Tracker::StoreSize(size_t &points, size_t &origins, size_t &bytes)
+{
+    std::lock_guard<std::mutex> guard(Tracker::storeLock);
+
+    points = Tracker::storedPoints.Size();
+    origins = Tracker::storedOrigins.Size();
+    bytes = Tracker::storedPoints.Bytes() + Tracker::storedOrigins.Bytes();
+}
+
+void Tracker::Run()
+{
+    Tracing::NameThread("tracker");
+
+    while (Tracker::running)
+    {
+        Update();
+    }
+}
+
+/**
+ * One iteration of the update loop.
+ * While idle, updates are spaced out and the IL waits longer
+ * between connection attempts.
+ * */
+void Tracker::Update()
+{
+    TraceSpan span("Update");
+
+    SyncClients();
+    ApplyInteractorUpdates();
+    ApplyRecording();
+    SyncSubscriptions();
+
+    if (Tracker::power == PowerState::Idle)
+    {
+        std::this_thread::sleep_for(IDLE_UPDATE_INTERVAL);
+
+        TraceSpan wait("WaitAndUpdate");
+        Tracker::counters.Update(Tracker::tobii->WaitAndUpdate(IDLE_CONNECTION_INTERVAL_MS));
+    }
+    else
+    {
+        TraceSpan wait("WaitAndUpdate");
+        Tracker::counters.Update(Tracker::tobii->WaitAndUpdate(ACTIVE_CONNECTION_INTERVAL_MS));
+    }
+
+    PublishQuality();
+    UpdateFlightRecorder();
+
+    NotifyClients();
+}
+
+/**
+ * Pick up the clients attached or detached since the last update.
+ * */
+void Tracker::SyncClients()
+{
+    std::lock_guard<std::mutex> guard(Tracker::clientLock);
+
+    if (!Tracker::clientsChanged)
+        return;
+
+    Tracker::clients = Tracker::attached;
+    Tracker::clientsChanged = false;
+}
+
+void Tracker::NotifyClients()
+{
+    for (const std::shared_ptr<TrackerClient> &client : Tracker::clients)
+    {
+        if (client->pending)
+        {
+            client->pending = false;
+            client->notify(client->context);
+        }
+    }
+}
+
+void Tracker::ApplyInteractorUpdates()
+{
+    TraceSpan span("ApplyInteractorUpdates");
+
+    std::vector<Interactor> interactors;
+    std::vector<std::pair<uint32_t, std::unique_ptr<InteractorTableReader>>> attaching;
+    std::vector<uint32_t> detached;
+    {
+        std::lock_guard<std::mutex> guard(Tracker::interactorLock);
+        interactors.swap(Tracker::pendingInteractors);
+        attaching.swap(Tracker::pendingTables);
+        detached.swap(Tracker::pendingDetached);
+    }
+
+    std::vector<IL::InteractorId> removed;
+
+    // Spaces are never reused, what was queued for a detached one can go too.
+    for (uint32_t space : detached)
+    {
+        RemoveSpace(space, removed);
+
+        auto queued = [space](const Interactor &interactor) { return (interactor.id >> INTERACTOR_SPACE_SHIFT) == space; };
+        interactors.erase(std::remove_if(interactors.begin(), interactors.end(), queued), interactors.end());
+
+        auto table = [space](const std::pair<uint32_t, std::unique_ptr<InteractorTableReader>> &t) { return t.first == space; };
+        attaching.erase(std::remove_if(attaching.begin(), attaching.end(), table), attaching.end());
+    }
+
+    for (const Interactor &interactor : interactors)
+        Tracker::addedInteractors.insert(interactor.id);
+
+    // Read a new table in full, whatever its generation. What the last
+    // one of its space committed goes, by the ids it was committed under.
+    for (auto &next : attaching)
+    {
+        AttachedTable &table = Tracker::tables[next.first];
+        for (const auto &entry : table.interactors)
+            removed.push_back(GlobalInteractorId(next.first, entry.first));
+
+        table.interactors.clear();
+        table.layout.clear();
+        table.reader = std::move(next.second);
+        table.generation = UINT64_MAX;
+    }
+
+    for (auto &table : Tracker::tables)
+    {
+        if (table.second.reader)
+            ReadInteractorTable(table.first, table.second, interactors, removed);
+    }
+
+    if (interactors.empty() && removed.empty())
+        return;
+
+    int64_t begin_us = LatencyClock();
+    Tracker::tobii->BeginInteractorUpdates();
+
+    // Removals first, a new table may bring back an id of the old one.
+    for (IL::InteractorId id : removed)
+        Tracker::tobii->RemoveInteractor(id);
+
+    for (const Interactor &interactor : interactors)
+        Tracker::tobii->AddOrUpdateInteractor(interactor.id, interactor.bounds, interactor.z);
+
+    Tracker::tobii->CommitInteractorUpdates();
+    FOCUS_PROBE3(commit, interactors.size() + removed.size(), begin_us, LatencyClock());
+}
+
+/**
+ * Everything a client of a shared tracker added, itself or through its table.
+ * */
+void Tracker::RemoveSpace(uint32_t space, std::vector<IL::InteractorId> &removed)
+{
+    size_t before = removed.size();
+
+    for (auto id = Tracker::addedInteractors.begin(); id != Tracker::addedInteractors.end();)
+    {
+        if ((*id >> INTERACTOR_SPACE_SHIFT) == space)
+        {
+            removed.push_back(*id);
+            id = Tracker::addedInteractors.erase(id);
+        }
+        else
+        {
+            id++;
+        }
+    }
+
+    auto table = Tracker::tables.find(space);
+    if (table != Tracker::tables.end())
+    {
+        for (const auto &entry : table->second.interactors)
+            removed.push_back(GlobalInteractorId(space, entry.first));
+        Tracker::tables.erase(table);
+    }
+
+    Logging::Write(IL_LoggingLevel_Debug, "interactor space %u detached: %zu removed", space, removed.size() - before);
+}
+
+/**
+ * When the table has a new generation, add what is new or moved to
+ * changed and what is gone to removed. A torn read is retried at the
+ * next update. The interactors of a table whose writer went away stay.
+ * */
+void Tracker::ReadInteractorTable(uint32_t space, AttachedTable &table, std::vector<Interactor> &changed, std::vector<IL::InteractorId> &removed)
+{
+    TraceSpan span("ReadInteractorTable");
+
+    if (table.reader->Generation() == table.generation)
+    {
+        if (table.reader->Closed())
+        {
+            Logging::Write(IL_LoggingLevel_Info, "interactor table closed by its writer");
+            table.reader.reset();
+        }
+        return;
+    }
+
+    uint64_t generation;
+    if (!table.reader->Read(table.layout, generation))
+        return;
+
+    table.generation = generation;
+    uint64_t read = ++Tracker::tableReads;
+    size_t pending = changed.size();
+    size_t unread = removed.size();
+
+    for (const Interactor &interactor : table.layout)
+    {
+        auto found = table.interactors.find(interactor.id);
+        if (found == table.interactors.end())
+        {
+            table.interactors.emplace(interactor.id, TableEntry{interactor, read});
+            changed.push_back(interactor);
+            continue;
+        }
+
+        const Interactor &last = found->second.interactor;
+        if (last.bounds.x != interactor.bounds.x || last.bounds.y != interactor.bounds.y ||
+            last.bounds.w != interactor.bounds.w || last.bounds.h != interactor.bounds.h || last.z != interactor.z)
+        {
+            changed.push_back(interactor);
+            found->second.interactor = interactor;
+        }
+
+        found->second.read = read;
+    }
+
+    for (auto entry = table.interactors.begin(); entry != table.interactors.end();)
+    {
+        if (entry->second.read != read)
+        {
+            removed.push_back(entry->first);
+            entry = table.interactors.erase(entry);
+        }
+        else
+        {
+            entry++;
+        }
+    }
+
+    // The table speaks the local ids of the client that attached it.
+    for (size_t i = pending; i < changed.size(); i++)
+        changed[i].id = GlobalInteractorId(space, changed[i].id);
+    for (size_t i = unread; i < removed.size(); i++)
+        removed[i] = GlobalInteractorId(space, removed[i]);
+
+    Logging::Write(IL_LoggingLevel_Debug, "interactor table generation %llu: %zu changed, %zu removed",
+                   static_cast<unsigned long long>(generation), changed.size() - pending, removed.size() - unread);
+}
+
+void Tracker::ApplyRecording()
+{
+    TraceSpan span("ApplyRecording");
+
+    std::unique_ptr<Recorder> next;
+    bool stop;
+    {
+        std::lock_guard<std::mutex> guard(Tracker::recordingLock);
+        next = std::move(Tracker::pendingRecorder);
+        stop = Tracker::stopRecording;
+        Tracker::stopRecording = false;
+    }
+
+    if ((stop || next) && Tracker::recorder)
+    {
+        Tracker::recorder->Close();
+        Tracker::closingRecorders.push_back(std::move(Tracker::recorder));
+    }
+
+    if (next)
+        Tracker::recorder = std::move(next);
+
+    // Joining a finished I/O thread does not block. How it went is only
+    // known then, a failed or lossy recording must not pass for a good one.
+    auto done = [](const std::unique_ptr<Recorder> &r)
+    {
+        if (!r->Done())
+            return false;
+
+        if (!r->Succeeded())
+            Logging::Write(IL_LoggingLevel_Error, "could not write recording %s", r->Path().c_str());
+        if (r->Dropped())
+            Logging::Write(IL_LoggingLevel_Warn, "recording %s dropped %llu records, the disk fell behind",
+                           r->Path().c_str(), static_cast<unsigned long long>(r->Dropped()));
+        return true;
+    };
+    Tracker::closingRecorders.erase(
+        std::remove_if(Tracker::closingRecorders.begin(), Tracker::closingRecorders.end(), done),
+        Tracker::closingRecorders.end());
+}
+
+void Tracker::UpdateFlightRecorder()
+{
+    TraceSpan span("UpdateFlightRecorder");
+
+    bool ok;
+    if (Tracker::flight && Tracker::flight->Update(ok))
+    {
+        // Every owner sees it, the one that asked for the dump calls back.
+        for (const std::shared_ptr<TrackerClient> &client : Tracker::clients)
+        {
+            client->dumpResults.Push(ok);
+            client->pending = true;
+        }
+    }
+}
+
+/**
+ * Subscribe to the IL streams needed by the enabled outputs.
+ * Blink detection needs both gaze point and gaze origin data,
+ * recording and the flight recorder need everything.
+ * */
+void Tracker::SyncSubscriptions()
+{
+    TraceSpan span("SyncSubscriptions");
+
+    unsigned wanted = Tracker::streams;
+    unsigned added = wanted & ~Tracker::subscribed;
+
+    auto needs = [&](unsigned consumers) {
+        return (added & consumers) && !(Tracker::subscribed & consumers);
+    };
+
+    if (needs(STREAM_GAZE_FOCUS | STREAM_SERVER | RECORDING_CONSUMERS))
+        Tracker::tobii->SubscribeGazeFocusEvents(Tracker::OnGazeFocusEvent, this);
+
+    if (needs(GAZE_POINT_CONSUMERS))
+        Tracker::tobii->SubscribeGazePointData(Tracker::OnGazePointData, this);
+
+    if (needs(GAZE_ORIGIN_CONSUMERS))
+        Tracker::tobii->SubscribeGazeOriginData(Tracker::OnGazeOriginData, this);
+
+    if (needs(RECORDING_CONSUMERS))
+        Tracker::tobii->SubscribeHeadPoseData(Tracker::OnHeadPoseData, this);
+
+    Tracker::subscribed = wanted;
+}
+
+void Tracker::PublishQuality()
+{
+    TraceSpan span("PublishQuality");
+
+    if (!Tracker::qualityChanged)
+        return;
+
+    Tracker::qualityChanged = false;
+
+    QualityStats stats = Tracker::quality.Stats();
+
+    std::lock_guard<std::mutex> guard(Tracker::qualityLock);
+    Tracker::qualityStats = stats;
+}
+
+/**
+ * Copy a record to the recording and the flight recorder, if any.
+ * */
+void Tracker::Record(RecordType type, const void *record)
+{
+    if (Tracker::recorder && !Tracker::recorder->Append(type, record))
+        Tracker::counters.Add(COUNTER_RECORDING_DROPPED);
+
+    if (Tracker::flight)
+        Tracker::flight->Append(type, record);
+
+    if (Tracker::broadcast)
+        Tracker::broadcast->Append(type, record);
+}
+
+/**
+ * Time the first two stages of an event that was just queued.
+ * */
+void Tracker::Queued(LatencyStream stream, IL::Timestamp timestamp_us, int64_t entry_us)
+{
+    int64_t queued_us = LatencyClock();
+    FOCUS_PROBE3(enqueue, static_cast<int>(stream), timestamp_us, queued_us);
+
+    Tracker::latency[stream][STAGE_TRACKER_TO_CALLBACK].Record(entry_us - timestamp_us);
+    Tracker::latency[stream][STAGE_CALLBACK_TO_QUEUE].Record(queued_us - entry_us);
+}
+
+void Tracker::OnGazeFocusEvent(IL::GazeFocusEvent evt, void *context)
+{
+    Tracker *t = static_cast<Tracker *>(context);
+    TraceSpan span("OnGazeFocusEvent");
+    int64_t entry_us = LatencyClock();
+    FOCUS_PROBE4(sample, static_cast<int>(LATENCY_GAZE_FOCUS), evt.id, evt.timestamp_us, entry_us);
+    t->counters.Add(COUNTER_RECEIVED_GAZE_FOCUS);
+
+    if (t->recorder || t->flight || t->broadcast)
+    {
+        // Copy without the padding bytes, files should be reproducible.
+        IL::GazeFocusEvent record = {};
+        record.timestamp_us = evt.timestamp_us;
+        record.id = evt.id;
+        record.hasFocus = evt.hasFocus;
+        t->Record(RECORD_GAZE_FOCUS, &record);
+    }
+
+    if (t->server)
+        t->server->Post({FRAME_GAZE_FOCUS, 0, evt.timestamp_us, evt.hasFocus ? 1.0f : 0.0f, 0.0f, static_cast<uint64_t>(evt.id)});
+
+    // Nobody is looking, don't bother JS.
+    if (t->power == PowerState::Idle)
+        return;
+
+    if (t->subscribed & STREAM_GAZE_FOCUS)
+    {
+        bool queued = false;
+
+        // Only the client that added the interactor hears of it, by its own id.
+        for (const std::shared_ptr<TrackerClient> &client : t->clients)
+        {
+            if (!(client->streams & STREAM_GAZE_FOCUS) || !client->Owns(evt.id))
+                continue;
+
+            IL::GazeFocusEvent local = evt;
+            local.id = client->Local(evt.id);
+
+            if (!client->focusEvents.Push(local))
+            {
+                t->counters.Add(COUNTER_DROPPED_GAZE_FOCUS);
+                continue;
+            }
+
+            client->pending = true;
+            t->counters.Add(COUNTER_QUEUED_GAZE_FOCUS);
+            queued = true;
+        }
+
+        if (queued)
+            t->Queued(LATENCY_GAZE_FOCUS, evt.timestamp_us, entry_us);
+    }
+}
+
+void Tracker::OnGazePointData(IL::GazePointData evt, void *context)
+{
+    Tracker *t = static_cast<Tracker *>(context);
+    TraceSpan span("OnGazePointData");
+    int64_t entry_us = LatencyClock();
+    FOCUS_PROBE4(sample, static_cast<int>(LATENCY_GAZE_POINT), 0, evt.timestamp_us, entry_us);
+    t->counters.Add(COUNTER_RECEIVED_GAZE_POINT);
+
+    // The recording is a faithful copy of the streams, away or not.
+    t->Record(RECORD_GAZE_POINT, &evt);
+
+    if (t->server)
+        t->server->Post({FRAME_GAZE_POINT, 0, evt.timestamp_us, evt.x, evt.y, static_cast<uint64_t>(evt.validity)});
+
+    if (t->storing)
+    {
+        std::lock_guard<std::mutex> guard(t->storeLock);
+        t->storedPoints.Add(evt);
+    }
+
+    if (t->power == PowerState::Idle)
+        return;
+
+    unsigned streams = t->subscribed;
+
+    // The blink detector needs to see the invalid samples, JS does not.
+    if (streams & STREAM_BLINK)
+    {
+        TraceSpan filter("BlinkDetector");
+        t->blinks.OnGazePoint(evt);
+    }
+
+    if (streams & STREAM_QUALITY)
+    {
+        TraceSpan filter("QualityMonitor");
+        t->quality.OnGazePoint(evt);
+        t->qualityChanged = true;
+    }
+
+    if (t->history)
+        t->history->Add(evt);
+
+    if (evt.validity == IL::Validity::Invalid)
+    {
+        t->counters.Add(COUNTER_FILTERED_INVALID);
+        return;
+    }
+
+    if (streams & STREAM_GAZE_POINT)
+    {
+        bool queued = false;
+
+        for (const std::shared_ptr<TrackerClient> &client : t->clients)
+        {
+            if (!(client->streams & STREAM_GAZE_POINT))
+                continue;
+
+            if (!client->gazePoints.Push(evt))
+            {
+                t->counters.Add(COUNTER_DROPPED_GAZE_POINT);
+                continue;
+            }
+
+            client->pending = true;
+            t->counters.Add(COUNTER_QUEUED_GAZE_POINT);
+            queued = true;
+        }
+
+        if (queued)
+            t->Queued(LATENCY_GAZE_POINT, evt.timestamp_us, entry_us);
+    }
+}
+
+void Tracker::OnGazeOriginData(IL::GazeOriginData evt, void *context)
+{
+    Tracker *t = static_cast<Tracker *>(context);
+    TraceSpan span("OnGazeOriginData");
+    t->counters.Add(COUNTER_RECEIVED_GAZE_ORIGIN);
+
+    t->Record(RECORD_GAZE_ORIGIN, &evt);
+
+    if (t->storing)
+    {
+        std::lock_guard<std::mutex> guard(t->storeLock);
+        t->storedOrigins.Add(evt);
+    }
+
+    if (t->power == PowerState::Idle)
+        return;
+
+    if (t->subscribed & STREAM_BLINK)
+        t->blinks.OnGazeOrigin(evt);
+}
+
+void Tracker::OnHeadPoseData(IL::HeadPoseData evt, void *context)
+{
+    Tracker *t = static_cast<Tracker *>(context);
+    TraceSpan span("OnHeadPoseData");
+    t->counters.Add(COUNTER_RECEIVED_HEAD_POSE);
+
+    t->Record(RECORD_HEAD_POSE, &evt);
+}
+
+/**
+ * Away puts the loop to idle, Present wakes it up again.
+ * Unknown leaves the current state alone.
+ * */
+void Tracker::OnPresenceData(IL::PresenceData evt, void *context)
+{
+    Tracker *t = static_cast<Tracker *>(context);
+    TraceSpan span("OnPresenceData");
+    t->counters.Add(COUNTER_RECEIVED_PRESENCE);
+
+    t->Record(RECORD_PRESENCE, &evt);
+
+    if (t->server)
+        t->server->Post({FRAME_PRESENCE, 0, evt.timestamp_us, 0.0f, 0.0f, static_cast<uint64_t>(evt.presence)});
+
+    IL::Presence presence = static_cast<IL::Presence>(evt.presence);
+    t->presence = presence;
+
+    if (presence == IL::Presence::Away && t->power == PowerState::Active)
+    {
+        // Runs spanning the away period are not blinks,
+        // and the gap is not a sample interval.
+        t->blinks.Reset();
+        t->quality.Reset();
+        t->power = PowerState::Idle;
+    }
+    else if (presence == IL::Presence::Present)
+    {
+        t->power = PowerState::Active;
+    }
+}
+
+void Tracker::OnBlinkEvent(const BlinkEvent &evt, void *context)
+{
+    Tracker *t = static_cast<Tracker *>(context);
+    TraceSpan span("OnBlinkEvent");
+    int64_t entry_us = LatencyClock();
+    FOCUS_PROBE3(filter, static_cast<int>(LATENCY_BLINK), evt.end_us, entry_us);
+
+    bool queued = false;
+
+    for (const std::shared_ptr<TrackerClient> &client : t->clients)
+    {
+        if (!(client->streams & STREAM_BLINK))
+            continue;
+
+        if (!client->blinkEvents.Push(evt))
+        {
+            t->counters.Add(COUNTER_DROPPED_BLINK);
+            continue;
+        }
+
+        client->pending = true;
+        t->counters.Add(COUNTER_QUEUED_BLINK);
+        queued = true;
+    }
+
+    if (queued)
+        t->Queued(LATENCY_BLINK, evt.end_us, entry_us);
+}
@@ -0,0 +1,299 @@
+/**
+ * Owns the interaction library and runs its update loop on a
+ * dedicated tracker thread.
+ *
+ * All calls into the IL happen on the tracker thread. Interactor
+ * changes from the JS thread are queued and applied before the next
+ * update, and events going the other way are pushed into the rings of
+ * each client, which its owner drains after being notified. A tracker
+ * of its own has one client, one shared through the hub has one per
+ * Screen, see hub.h.
+ */
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <interaction_lib/InteractionLib.h>
+#include <interaction_lib/misc/InteractionLibPtr.h>
+
+#include "adapter.h"
+#include "blink.h"
+#include "counters.h"
+#include "flight.h"
+#include "history.h"
+#include "latency.h"
+#include "logging.h"
+#include "hittest.h"
+#include "probes.h"
+#include "quality.h"
+#include "recording.h"
+#include "ring.h"
+#include "store.h"
+#include "trace.h"
+
+/**
+ * Power state of the update loop, driven by the presence stream.
+ * While Idle, no events are produced and the update loop backs off.
+ */
+enum class PowerState
+{
+    Active,
+    Idle
+};
+
+/**
+ * Streams the owner wants delivered, as a bit mask.
+ */
+enum TrackerStream : unsigned
+{
+    STREAM_GAZE_FOCUS = 1 << 0,
+    STREAM_GAZE_POINT = 1 << 1,
+    STREAM_BLINK = 1 << 2,
+    STREAM_QUALITY = 1 << 3,
+    STREAM_RECORDING = 1 << 4,
+    STREAM_FLIGHT_RECORDER = 1 << 5,
+    STREAM_HISTORY = 1 << 6,
+    STREAM_STORE = 1 << 7,
+    STREAM_BROADCAST = 1 << 8,
+    STREAM_SERVER = 1 << 9
+};
+
+// Outputs that need every IL stream.
+static const unsigned RECORDING_CONSUMERS = STREAM_RECORDING | STREAM_FLIGHT_RECORDER | STREAM_BROADCAST;
+
+// Outputs that need the gaze origin stream.
+static const unsigned GAZE_ORIGIN_CONSUMERS = STREAM_BLINK | STREAM_STORE | RECORDING_CONSUMERS;
+
+// Outputs computed from the IL gaze point stream.
+static const unsigned GAZE_POINT_CONSUMERS = STREAM_GAZE_POINT | STREAM_BLINK | STREAM_QUALITY | STREAM_HISTORY | STREAM_STORE | STREAM_SERVER | RECORDING_CONSUMERS;
+
+// Interactor ids of a client are kept apart from those of the other
+// clients by its space, in the top bits of the id the IL sees.
+static const unsigned INTERACTOR_SPACE_SHIFT = 48;
+static const IL::InteractorId INTERACTOR_LOCAL_MASK = (IL::InteractorId(1) << INTERACTOR_SPACE_SHIFT) - 1;
+
+// The id the IL sees for a local id of a space, space 0 leaves it alone.
+inline IL::InteractorId GlobalInteractorId(uint32_t space, IL::InteractorId id)
+{
+    return space ? (static_cast<IL::InteractorId>(space) << INTERACTOR_SPACE_SHIFT) | (id & INTERACTOR_LOCAL_MASK) : id;
+}
+
+/**
+ * Where the events for one owner go.
+ */
+struct TrackerClient
+{
+    typedef void (*NotifyCallback)(void *context);
+
+    static const size_t QUEUE_SIZE = 1024;
+
+    // Space 0 is for a tracker of its own, its ids go to the IL as they are.
+    TrackerClient(NotifyCallback notify, void *context, uint32_t space)
+        : streams(0), space(space), notify(notify), context(context), pending(false) {}
+
+    // Produced on the tracker thread, drained by the owner.
+    SpscRing<IL::GazeFocusEvent, QUEUE_SIZE> focusEvents;
+    SpscRing<IL::GazePointData, QUEUE_SIZE> gazePoints;
+    SpscRing<BlinkEvent, QUEUE_SIZE> blinkEvents;
+
+    // Outcome of each flight recorder dump.
+    SpscRing<bool, 16> dumpResults;
+
+    // Streams the owner listens to.
+    std::atomic<unsigned> streams;
+
+    const uint32_t space;
+
+    NotifyCallback notify;
+    void *context;
+
+    // Tracker thread only, events were queued since the last notify.
+    bool pending;
+
+    IL::InteractorId Global(IL::InteractorId id) const { return GlobalInteractorId(space, id); }
+
+    // Whether an id of the IL is one of ours, and which.
+    bool Owns(IL::InteractorId id) const { return !space || (id >> INTERACTOR_SPACE_SHIFT) == space; }
+    IL::InteractorId Local(IL::InteractorId id) const { return space ? id & INTERACTOR_LOCAL_MASK : id; }
+};
+
+class BroadcastWriter;
+class GazeServer;
+class InteractorTableReader;
+
+class Tracker
+{
+public:
+    // Delivery latency of the queued streams, the last stage is
+    // recorded by the owner, see latency.h.
+    LatencyHistogram latency[LATENCY_STREAMS][LATENCY_STAGES];
+
+    // Bumped by the tracker thread and, for deliveries, the owner.
+    PipelineCounters counters;
+
+    // Without an adapter the IL uses the default Tobii device adapter.
+    Tracker(float width, float height, std::unique_ptr<Adapter> adapter = nullptr);
+    ~Tracker();
+
+    // Deliver events to the client from the next update on, and start
+    // the tracker thread if it isn't running yet.
+    void Attach(const std::shared_ptr<TrackerClient> &client);
+
+    // Stop delivering to the client and remove the interactors and the
+    // table of its space, if it has one of its own.
+    void Detach(const TrackerClient *client);
+
+    void Stop();
+    bool Running() const { return Tracker::running; }
+
+    void Enable(unsigned streams);
+    void AddOrUpdateInteractors(const std::vector<Interactor> &interactors);
+
+    // Follow the interactor table of that name, see interactortable.h,
+    // its ids in the given space, instead of the last one of the space.
+    // False if there is none.
+    bool AttachInteractorTable(const std::string &name, uint32_t space = 0);
+
+    IL::Presence GetPresence() const;
+    PowerState GetPowerState() const;
+    QualityStats GetQuality();
+
+    // All counters, with the current queue depths.
+    void ReadCounters(uint64_t values[COUNTERS]);
+
+    // Record every stream to a file, see recording.h.
+    bool StartRecording(const std::string &path, bool compressed = false);
+    void StopRecording();
+
+    // Keep the last seconds of every stream in memory, before Start only.
+    void EnableFlightRecorder(double seconds, double rate = FlightRecorder::DEFAULT_RATE);
+    bool Dump(const std::string &path, double secondsAfter, bool compressed = false);
+
+    // Publish every stream to shared memory for other processes, see
+    // broadcast.h, before Start only. False if it can't be created.
+    bool EnableBroadcast(const std::string &name, double seconds, double rate);
+
+    // Serve gaze, focus and presence on a Unix domain socket, see
+    // server.h, before Start only. False if it can't listen there.
+    bool EnableServer(const std::string &path);
+
+    // Keep the recent valid gaze points for range queries, before Start only.
+    void EnableHistory(double seconds, double rate);
+    const GazeHistory *History() const;
+
+    // Keep every gaze point and gaze origin in memory, see store.h.
+    void EnableStore();
+
+    // Stored samples of a stream with from_us <= timestamp < to_us,
+    // as doubles in the order of the fields of its IL struct.
+    void ReadStore(uint32_t type, IL::Timestamp from_us, IL::Timestamp to_us, std::vector<double> &values);
+    void StoreSize(size_t &points, size_t &origins, size_t &bytes);
+
+private:
+    // Declared first so it outlives the IL that calls into it.
+    std::unique_ptr<Adapter> adapter;
+    IL::UniqueInteractionLibPtr tobii;
+
+    std::thread thread;
+    std::atomic<bool> running;
+
+    // Changed by the owners, picked up by the tracker thread at the next update.
+    std::mutex clientLock;
+    std::vector<std::shared_ptr<TrackerClient>> attached;
+    bool clientsChanged;
+    std::vector<std::shared_ptr<TrackerClient>> clients;
+
+    std::atomic<unsigned> streams;
+    unsigned subscribed;
+
+    std::mutex interactorLock;
+    std::vector<Interactor> pendingInteractors;
+    std::vector<std::pair<uint32_t, std::unique_ptr<InteractorTableReader>>> pendingTables;
+    std::vector<uint32_t> pendingDetached;
+
+    // What was committed from an interactor table, and the last read
+    // of the table each interactor was in.
+    struct TableEntry
+    {
+        Interactor interactor;
+        uint64_t read;
+    };
+
+    // The table of a space, by local ids. The reader goes when its writer
+    // does, what it committed stays until the space gets another table.
+    struct AttachedTable
+    {
+        std::unique_ptr<InteractorTableReader> reader;
+        uint64_t generation;
+        std::vector<Interactor> layout;
+        std::unordered_map<IL::InteractorId, TableEntry> interactors;
+    };
+
+    std::unordered_map<uint32_t, AttachedTable> tables;
+    uint64_t tableReads;
+
+    // Ids committed from AddOrUpdateInteractors, to remove a space with.
+    std::unordered_set<IL::InteractorId> addedInteractors;
+
+    std::atomic<IL::Presence> presence;
+    std::atomic<PowerState> power;
+
+    BlinkDetector blinks;
+
+    // Quality is computed on the tracker thread and published
+    // once per update for the JS thread to read.
+    QualityMonitor quality;
+    bool qualityChanged;
+    std::mutex qualityLock;
+    QualityStats qualityStats;
+
+    // Recorders are swapped in and out on the tracker thread. Closed ones
+    // are kept until their I/O thread has written everything.
+    std::mutex recordingLock;
+    std::unique_ptr<Recorder> pendingRecorder;
+    bool stopRecording;
+    std::unique_ptr<Recorder> recorder;
+    std::vector<std::unique_ptr<Recorder>> closingRecorders;
+
+    std::unique_ptr<FlightRecorder> flight;
+    std::unique_ptr<BroadcastWriter> broadcast;
+    std::unique_ptr<GazeServer> server;
+    std::unique_ptr<GazeHistory> history;
+
+    // Appended on the tracker thread, read on the JS thread.
+    std::mutex storeLock;
+    bool storing;
+    GazePointStore storedPoints;
+    GazeOriginStore storedOrigins;
+
+    void Run();
+    void Update();
+    void SyncClients();
+    void NotifyClients();
+    void ApplyInteractorUpdates();
+    void ReadInteractorTable(uint32_t space, AttachedTable &table, std::vector<Interactor> &changed, std::vector<IL::InteractorId> &removed);
+    void RemoveSpace(uint32_t space, std::vector<IL::InteractorId> &removed);
+    void SyncSubscriptions();
+    void PublishQuality();
+    void ApplyRecording();
+    void UpdateFlightRecorder();
+    void Record(RecordType type, const void *record);
+    void Queued(LatencyStream stream, IL::Timestamp timestamp_us, int64_t entry_us);
+
+    static void OnGazeFocusEvent(IL::GazeFocusEvent evt, void *context);
+    static void OnGazePointData(IL::GazePointData evt, void *context);
+    static void OnGazeOriginData(IL::GazeOriginData evt, void *context);
+    static void OnHeadPoseData(IL::HeadPoseData evt, void *context);
+    static void OnPresenceData(IL::PresenceData evt, void *context);
+    static void OnBlinkEvent(const BlinkEvent &evt, void *context);
+};
+
+#endif // TRACKER_H
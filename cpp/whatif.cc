@@ -0,0 +1,174 @@
+#include "whatif.h"
+
+#include <cstring>
+
+// Samples a chunk aims for, large enough to amortize the task.
+static const size_t CHUNK_SAMPLES = 64 * 1024;
+
+// Interactor index of no focus, and of a state not known yet.
+static const int64_t NONE = -1;
+static const int64_t UNKNOWN = -2;
+
+struct FocusChange
+{
+    int64_t index;
+    IL::Timestamp timestamp_us;
+};
+
+struct ChunkReplay
+{
+    std::vector<FocusChange> changes;
+    std::vector<uint64_t> hits;
+    uint64_t samples;
+    uint64_t misses;
+    IL::Timestamp last_us;
+};
+
+/**
+ * Hit test the valid gaze points of blocks [first, last) against one
+ * layout. The focus before the chunk is unknown, so its first valid
+ * gaze point is always a change.
+ * */
+static void ReplayChunk(const RecordingReader &reader, const std::vector<Interactor> &layout,
+                        size_t first, size_t last, ChunkReplay &chunk)
+{
+    chunk.hits.assign(layout.size(), 0);
+    chunk.samples = 0;
+    chunk.misses = 0;
+    chunk.last_us = -1;
+
+    int64_t state = UNKNOWN;
+
+    for (size_t block = first; block < last; block++)
+    {
+        RecordSpan span = reader.ReadBlock(RECORD_GAZE_POINT, block);
+
+        for (uint32_t i = 0; i < span.count; i++)
+        {
+            IL_GazePointData sample;
+            std::memcpy(&sample, span.records + static_cast<size_t>(i) * span.size, sizeof(sample));
+
+            if (sample.validity != IL_Validity_Valid)
+                continue;
+
+            const Interactor *hit = HitTest(layout, sample.x, sample.y);
+            int64_t index = hit ? hit - layout.data() : NONE;
+
+            chunk.samples++;
+            if (hit)
+                chunk.hits[index]++;
+            else
+                chunk.misses++;
+
+            chunk.last_us = sample.timestamp_us;
+
+            if (index != state)
+            {
+                chunk.changes.push_back({index, sample.timestamp_us});
+                state = index;
+            }
+        }
+    }
+}
+
+// End the open span, which belongs to the interactor at index.
+static void Close(LayoutReplay &result, int64_t index, IL::Timestamp timestamp_us)
+{
+    FocusSpan &span = result.timeline.back();
+    span.end_us = timestamp_us;
+    result.interactors[index].dwell_us += span.end_us - span.start_us;
+}
+
+/**
+ * Join the chunks of a layout into its timeline and statistics.
+ * */
+static void Merge(const std::vector<Interactor> &layout, const std::vector<ChunkReplay> &chunks, LayoutReplay &result)
+{
+    result.timeline.clear();
+    result.interactors.clear();
+    result.samples = 0;
+    result.misses = 0;
+
+    for (const Interactor &interactor : layout)
+        result.interactors.push_back({interactor.id, 0, 0, 0, -1});
+
+    int64_t state = NONE;
+    IL::Timestamp last_us = -1;
+
+    for (const ChunkReplay &chunk : chunks)
+    {
+        result.samples += chunk.samples;
+        result.misses += chunk.misses;
+
+        for (size_t i = 0; i < layout.size(); i++)
+            result.interactors[i].samples += chunk.hits[i];
+
+        if (chunk.last_us >= 0)
+            last_us = chunk.last_us;
+
+        for (const FocusChange &change : chunk.changes)
+        {
+            if (change.index == state)
+                continue;
+
+            if (state != NONE)
+                Close(result, state, change.timestamp_us);
+
+            if (change.index != NONE)
+            {
+                InteractorHits &hits = result.interactors[change.index];
+                hits.entries++;
+                if (hits.first_us < 0)
+                    hits.first_us = change.timestamp_us;
+
+                result.timeline.push_back({hits.id, change.timestamp_us, change.timestamp_us});
+            }
+
+            state = change.index;
+        }
+    }
+
+    if (state != NONE)
+        Close(result, state, last_us);
+}
+
+void ReplayLayouts(const RecordingReader &reader, const std::vector<std::vector<Interactor>> &layouts,
+                   WorkPool &pool, std::vector<LayoutReplay> &results)
+{
+    // Chunks of whole blocks, the same for every layout.
+    std::vector<size_t> bounds(1, 0);
+
+    size_t blocks = reader.Blocks(RECORD_GAZE_POINT);
+    size_t samples = 0;
+
+    for (size_t block = 0; block < blocks; block++)
+    {
+        samples += reader.Entry(RECORD_GAZE_POINT, block).count;
+        if (samples >= CHUNK_SAMPLES || block + 1 == blocks)
+        {
+            bounds.push_back(block + 1);
+            samples = 0;
+        }
+    }
+
+    size_t count = bounds.size() - 1;
+    std::vector<std::vector<ChunkReplay>> chunks(layouts.size(), std::vector<ChunkReplay>(count));
+
+    for (size_t l = 0; l < layouts.size(); l++)
+    {
+        for (size_t c = 0; c < count; c++)
+        {
+            pool.Submit([&, l, c]()
+                        { ReplayChunk(reader, layouts[l], bounds[c], bounds[c + 1], chunks[l][c]); });
+        }
+    }
+
+    pool.Wait();
+
+    results.resize(layouts.size());
+    for (size_t l = 0; l < layouts.size(); l++)
+        pool.Submit([&, l]()
+                    { Merge(layouts[l], chunks[l], results[l]); });
+
+    pool.Wait();
+}
@@ -0,0 +1,70 @@
+/**
+ * What-if replay of a recorded session against alternative layouts.
+ *
+ * Every layout sees the gaze points of the recording as the interaction
+ * engine would, focus moves to the top interactor under each valid gaze
+ * point, and comes back as a focus timeline and hit statistics per
+ * interactor. Layouts use the format AddRectangles takes, so candidate
+ * designs can be compared on the same session without running it again.
+ *
+ * Focus only depends on the latest valid gaze point, so the work is
+ * split into one task per layout and chunk of the recording. Each task
+ * records where the focus changes, and joining the chunks of a layout
+ * in order drops the changes that turn out not to be any.
+ */
+
+#ifndef WHATIF_H
+#define WHATIF_H
+
+#include <cstdint>
+#include <vector>
+
+#include "hittest.h"
+#include "pool.h"
+#include "reader.h"
+
+// Time an interactor held the focus, end_us is when it was lost.
+struct FocusSpan
+{
+    IL::InteractorId id;
+    IL::Timestamp start_us;
+    IL::Timestamp end_us;
+};
+
+struct InteractorHits
+{
+    IL::InteractorId id;
+
+    // Valid gaze points on the interactor.
+    uint64_t samples;
+
+    // Times it gained the focus.
+    uint64_t entries;
+
+    IL::Timestamp dwell_us;
+
+    // First gain of focus, -1 if never.
+    IL::Timestamp first_us;
+};
+
+struct LayoutReplay
+{
+    std::vector<FocusSpan> timeline;
+
+    // In the order of the layout.
+    std::vector<InteractorHits> interactors;
+
+    // Valid gaze points, and those that hit no interactor.
+    uint64_t samples;
+    uint64_t misses;
+};
+
+/**
+ * Replay the gaze points of a recording against every layout, on the
+ * pool, and wait for it. A span still open at the end of the recording
+ * ends at the last valid gaze point.
+ * */
+void ReplayLayouts(const RecordingReader &reader, const std::vector<std::vector<Interactor>> &layouts,
+                   WorkPool &pool, std::vector<LayoutReplay> &results);
+
+#endif // WHATIF_H
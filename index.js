@@ -1 +1,10 @@
-module.exports = require('./cpp/build/Release/focus.node').Screen;
\ No newline at end of file
+const addon = require('./cpp/build/Release/focus.node');
+
+module.exports = addon.Screen;
+module.exports.Recording = addon.Recording;
+module.exports.Broadcast = addon.Broadcast;
+module.exports.InteractorTable = addon.InteractorTable;
+module.exports.EstimateRobustness = addon.EstimateRobustness;
+module.exports.StartTracing = addon.StartTracing;
+module.exports.StopTracing = addon.StopTracing;
+module.exports.SetLogging = addon.SetLogging;
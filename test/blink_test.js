@@ -0,0 +1,10 @@
+const Screen = require('../index');
+
+
+const screen = new Screen(1920.0, 1080.0);
+
+const types = ['blink', 'tracking loss', 'left eye loss', 'right eye loss'];
+
+screen.ListenBlinks((type, start, end, duration) => {
+    console.log(`${types[type]} from ${start} to ${end} (${duration / 1000} ms)`);
+});
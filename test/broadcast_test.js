@@ -0,0 +1,29 @@
+const { fork } = require('child_process');
+const Screen = require('../index');
+
+
+// Broadcast generated gaze under the name focus-test, and follow it from
+// a second process that prints the gaze points it read every second.
+if (process.argv[2] === 'reader') {
+    const broadcast = new Screen.Broadcast('focus-test');
+
+    setInterval(() => {
+        const buffer = broadcast.Read(1);
+        const timestamps = new BigInt64Array(buffer);
+        const values = new Float32Array(buffer);
+
+        // IL_GazePointData is 24 bytes: timestamp, validity, x, y, padding.
+        const count = buffer.byteLength / 24;
+        if (count)
+            console.log(`read ${count} gaze points, last [${values[count * 6 - 3]}, ${values[count * 6 - 2]}] at ${timestamps[count * 3 - 3]}, lost ${broadcast.GetLost(1)}`);
+
+        if (broadcast.IsClosed()) {
+            console.log('broadcast closed');
+            process.exit(0);
+        }
+    }, 1000);
+} else {
+    const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200 }, broadcast: { name: 'focus-test', seconds: 1 } });
+
+    fork(__filename, ['reader']);
+}
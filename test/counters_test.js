@@ -0,0 +1,23 @@
+const Screen = require('../index');
+
+
+// Print the pipeline counters that changed in the last second,
+// as a monitoring scraper would collect them.
+const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200 } });
+
+screen.ListenGazePoint(() => {});
+
+const names = screen.GetCounterNames();
+let previous = screen.GetCounters();
+
+setInterval(() => {
+    const counters = screen.GetCounters();
+
+    names.forEach((name, i) => {
+        if (counters[i] !== previous[i])
+            console.log(`${name.padEnd(24)} ${counters[i]}`);
+    });
+    console.log();
+
+    previous = counters;
+}, 1000);
@@ -0,0 +1,22 @@
+const Screen = require('../index');
+
+
+// Keep the last five seconds of generated gaze in memory, then dump
+// them together with the two seconds after the trigger.
+const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200 }, flightRecorder: 5 });
+
+setTimeout(() => {
+    const accepted = screen.Dump('flight.etrk', 2, (ok) => {
+        if (!ok) {
+            console.log('could not write flight.etrk');
+            process.exit(1);
+        }
+
+        const recording = new Screen.Recording('flight.etrk');
+        const span = (recording.GetEnd() - recording.GetStart()) / 1000000;
+        console.log(`flight.etrk covers ${span.toFixed(3)} s`);
+        process.exit(0);
+    });
+
+    console.log(accepted ? 'Dumping to flight.etrk' : 'Dump refused');
+}, 8000);
@@ -0,0 +1,14 @@
+const Screen = require('../index');
+
+
+// Keep two seconds of generated gaze and ask every 100 ms where the
+// gaze was in the last 200 ms, without listening to every sample.
+const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200, noise: 5 }, history: 2 });
+
+setInterval(() => {
+    const samples = screen.GetHistory(-200000);
+    const stats = screen.GetHistoryStats(-200000);
+
+    console.log(`${samples.length / 3} samples   mean [${stats.meanX.toFixed(1)}, ${stats.meanY.toFixed(1)}]   ` +
+        `box [${stats.minX.toFixed(1)}, ${stats.minY.toFixed(1)}] - [${stats.maxX.toFixed(1)}, ${stats.maxY.toFixed(1)}]`);
+}, 100);
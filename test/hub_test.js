@@ -0,0 +1,46 @@
+const Screen = require('../index');
+
+
+// Two windows of one process share the tracker, each laying out its own
+// half of the display with the same interactor ids. Each only hears of
+// focus on its own rectangles, by its own ids, and both get every gaze
+// point, from one interaction library and one tracker thread.
+const left = new Screen(1920.0, 1080.0, { synthetic: {}, shared: true });
+const right = new Screen(1920.0, 1080.0, { shared: true });
+
+left.AddRectangles([
+    { id: 1, x: 0, y: 0, width: 960, height: 540 },
+    { id: 2, x: 0, y: 540, width: 960, height: 540 }
+]);
+
+right.AddRectangles([
+    { id: 1, x: 960, y: 0, width: 960, height: 540 },
+    { id: 2, x: 960, y: 540, width: 960, height: 540 }
+]);
+
+let points = { left: 0, right: 0 };
+
+// The counters are the tracker's, the same from either Screen.
+const received = left.GetCounterNames().indexOf('received.gazePoint');
+let previous = right.GetCounters()[received];
+
+left.Listen((id, hasFocus) => {
+    if (hasFocus)
+        console.log(`left: focus on ${id}`);
+});
+
+right.Listen((id, hasFocus) => {
+    if (hasFocus)
+        console.log(`right: focus on ${id}`);
+});
+
+left.ListenGazePoint(() => points.left++);
+right.ListenGazePoint(() => points.right++);
+
+setInterval(() => {
+    const total = right.GetCounters()[received];
+    console.log(`gaze points ${points.left}/s left, ${points.right}/s right, ` +
+        `${total - previous}/s received by the tracker`);
+    points = { left: 0, right: 0 };
+    previous = total;
+}, 1000);
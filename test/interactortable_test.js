@@ -0,0 +1,44 @@
+const { fork } = require('child_process');
+const Screen = require('../index');
+
+
+// A renderer process publishes a 4 x 4 grid through the interactor table
+// focus-layout and moves one cell a second. The tracker commits only the
+// cells that moved, the debug log says how many.
+if (process.argv[2] === 'renderer') {
+    const table = new Screen.InteractorTable('focus-layout', 1024);
+
+    let columns = table.Edit();
+    for (let i = 0; i < 16; i++) {
+        columns.ids[i] = BigInt(i + 1);
+        columns.x[i] = (i % 4) * 480;
+        columns.y[i] = Math.floor(i / 4) * 270;
+        columns.width[i] = 480;
+        columns.height[i] = 270;
+    }
+    table.Publish(16);
+
+    let step = 0;
+    setInterval(() => {
+        columns = table.Edit();
+        const i = step++ % 16;
+        columns.x[i] += step % 2 ? 10 : -10;
+        table.Publish(table.GetCount());
+    }, 1000);
+} else {
+    Screen.SetLogging({ level: 'debug' });
+
+    const screen = new Screen(1920.0, 1080.0, { synthetic: {} });
+    screen.Listen((id, hasFocus) => {
+        if (hasFocus)
+            console.log(`focus on ${id}`);
+    });
+
+    fork(__filename, ['renderer']);
+
+    // The renderer may not be up yet.
+    const attach = setInterval(() => {
+        if (screen.AttachInteractorTable('focus-layout'))
+            clearInterval(attach);
+    }, 100);
+}
@@ -0,0 +1,20 @@
+const Screen = require('../index');
+
+
+// Print how stale generated gaze points are by the time the
+// callback runs, per stage, every second.
+const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200 } });
+
+screen.ListenGazePoint(() => {});
+
+setInterval(() => {
+    const stats = screen.GetLatencyStats().gazePoint;
+
+    for (const stage of ['trackerToCallback', 'callbackToQueue', 'dequeueToReturn']) {
+        const s = stats[stage];
+        console.log(`${stage.padEnd(18)} p50 ${s.p50} us   p99 ${s.p99} us   p99.9 ${s.p999} us   max ${s.max} us`);
+    }
+    console.log();
+
+    screen.ResetLatencyStats();
+}, 1000);
@@ -0,0 +1,20 @@
+const Screen = require('../index');
+
+
+// Log everything down to debug level to focus.log, and print the
+// messages from a JS callback as well.
+Screen.SetLogging({
+    level: 'debug',
+    file: 'focus.log',
+    callback: (level, message, time) => console.log(`${new Date(time).toISOString()} [${level}] ${message}`)
+});
+
+const screen = new Screen(1920.0, 1080.0, { synthetic: {} });
+
+screen.AddRectangle(1, 0, 0, 960, 1080);
+screen.Listen((id, hasFocus, timestamp) => {});
+
+// Logged as an error, the argument must be an array.
+screen.AddRectangles(1);
+
+setTimeout(() => process.exit(0), 1000);
@@ -0,0 +1,18 @@
+const Screen = require('../index');
+
+
+// Jump to the middle of a recording made with recording_test.js
+// and print one second of gaze points, straight from the mapped file.
+const recording = new Screen.Recording('session.etrk');
+
+const middle = (recording.GetStart() + recording.GetEnd()) / 2;
+
+for (const buffer of recording.ReadRange(1, middle, middle + 1000000)) {
+    const timestamps = new BigInt64Array(buffer);
+    const values = new Float32Array(buffer);
+
+    // IL_GazePointData is 24 bytes: timestamp, validity, x, y, padding.
+    for (let i = 0; i < buffer.byteLength / 24; i++) {
+        console.log(`[${values[i * 6 + 3]}, ${values[i * 6 + 4]}]   timestamp = ${timestamps[i * 3]}`);
+    }
+}
@@ -0,0 +1,13 @@
+const Screen = require('../index');
+
+
+const screen = new Screen(1920.0, 1080.0);
+
+// Record ten seconds of every stream.
+screen.StartRecording('session.etrk');
+console.log('Recording to session.etrk');
+
+setTimeout(() => {
+    screen.StopRecording();
+    console.log('Stopped recording');
+}, 10000);
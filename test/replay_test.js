@@ -0,0 +1,9 @@
+const Screen = require('../index');
+
+
+// Replay a recording made with recording_test.js at twice the real speed.
+const screen = new Screen(1920.0, 1080.0, { replay: 'session.etrk', speed: 2 });
+
+screen.ListenGazePoint((x, y, validity, timestamp) => {
+    console.log(`[${x}, ${y}]   validity = ${validity}  timestamp = ${timestamp}`);
+});
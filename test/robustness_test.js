@@ -0,0 +1,18 @@
+const Screen = require('../index');
+
+
+// A toolbar with one button too small for the tracker's noise and
+// a popup covering part of another. Prints how often a fixation on
+// each button activates it, nothing, or a neighbour.
+const layout = [
+    { id: 1, x: 100, y: 100, width: 200, height: 100 },
+    { id: 2, x: 310, y: 100, width: 40, height: 40 },
+    { id: 3, x: 360, y: 100, width: 200, height: 100 },
+    { id: 4, x: 150, y: 150, width: 100, height: 100, z: 1 }
+];
+
+Screen.EstimateRobustness(layout, { accuracy: 20, precision: 10, trials: 1000000 }, (results) => {
+    for (const r of results) {
+        console.log(`id = ${r.id}  miss = ${(r.missRate * 100).toFixed(2)}%  false activation = ${(r.falseActivationRate * 100).toFixed(2)}%  stolen = ${r.stolen}`);
+    }
+});
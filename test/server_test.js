@@ -0,0 +1,66 @@
+const net = require('net');
+const Screen = require('../index');
+
+
+// Serve generated gaze on a Unix domain socket and read it back: one
+// client subscribed to gaze points that prints what it got every second,
+// and one that never reads and loses frames without slowing anyone down.
+const path = '/tmp/focus-test.sock';
+const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200 }, server: path });
+
+const FRAME_GAZE_POINT = 1;
+const DROP_OLDEST = 1;
+const DROP_NEWEST = 0;
+
+function subscribe(client, mask, policy) {
+    const request = Buffer.alloc(8);
+    request.writeUInt32LE(mask, 0);
+    request.writeUInt32LE(policy, 4);
+    client.write(request);
+}
+
+const reader = net.connect(path, () => subscribe(reader, 1 << FRAME_GAZE_POINT, DROP_OLDEST));
+
+let pending = Buffer.alloc(0);
+let frames = 0;
+let gaps = 0;
+let sequence = -1;
+let last;
+
+reader.on('data', (data) => {
+    pending = Buffer.concat([pending, data]);
+
+    // { type, sequence, timestamp, x, y, value }, 32 bytes each.
+    let offset = 0;
+    for (; offset + 32 <= pending.length; offset += 32) {
+        const frame = {
+            type: pending.readUInt32LE(offset),
+            sequence: pending.readUInt32LE(offset + 4),
+            timestamp: pending.readBigInt64LE(offset + 8),
+            x: pending.readFloatLE(offset + 16),
+            y: pending.readFloatLE(offset + 20)
+        };
+
+        if (sequence >= 0 && frame.sequence !== sequence + 1)
+            gaps++;
+        sequence = frame.sequence;
+        frames++;
+        last = frame;
+    }
+    pending = pending.subarray(offset);
+});
+
+const stalled = net.connect(path, () => {
+    subscribe(stalled, 1 << FRAME_GAZE_POINT, DROP_NEWEST);
+    stalled.pause();
+});
+
+setInterval(() => {
+    const names = screen.GetCounterNames();
+    const counters = screen.GetCounters();
+    const counter = (name) => counters[names.indexOf(name)];
+
+    if (last)
+        console.log(`${frames} frames, ${gaps} gaps, last [${last.x}, ${last.y}] at ${last.timestamp}, ` +
+            `${counter('server.clients')} clients, ${counter('server.sent')} sent, ${counter('server.dropped')} dropped`);
+}, 1000);
@@ -0,0 +1,16 @@
+const Screen = require('../index');
+
+
+// Keep every generated gaze point in the quantized store and print
+// how much memory it takes compared to the IL structs.
+const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200, noise: 5 }, store: true });
+
+setInterval(() => {
+    const size = screen.GetStoreSize();
+    const points = screen.GetStored(1);
+
+    // [timestamp, validity, x, y] per gaze point.
+    const last = points.length - 4;
+    console.log(`${size.gazePoints} gaze points in ${(size.bytes / 1024).toFixed(0)} KiB, ` +
+        `${(size.rawBytes / size.bytes).toFixed(1)}x less than raw, last at [${points[last + 2]}, ${points[last + 3]}]`);
+}, 5000);
@@ -0,0 +1,17 @@
+const Screen = require('../index');
+
+
+// Two generated sources at once, one at 10 kHz, printing how many
+// gaze points per second actually reach JS.
+const fast = new Screen(1920.0, 1080.0, { synthetic: { rate: 10000, noise: 5, dropout: 0.02 } });
+const slow = new Screen(1920.0, 1080.0, { synthetic: { rate: 90, seed: 2 } });
+
+let received = { fast: 0, slow: 0 };
+
+fast.ListenGazePoint(() => received.fast++);
+slow.ListenGazePoint(() => received.slow++);
+
+setInterval(() => {
+    console.log(`fast ${received.fast}/s   slow ${received.slow}/s`);
+    received = { fast: 0, slow: 0 };
+}, 1000);
@@ -0,0 +1,19 @@
+const Screen = require('../index');
+
+
+// Trace two seconds of the pipeline, open the file in chrome://tracing
+// or https://ui.perfetto.dev.
+const screen = new Screen(1920.0, 1080.0, { synthetic: { rate: 1200 } });
+
+screen.AddRectangle(1, 0, 0, 960, 1080);
+screen.Listen((id, hasFocus, timestamp) => {});
+screen.ListenGazePoint(() => {});
+
+Screen.StartTracing();
+
+setTimeout(() => {
+    Screen.StopTracing('trace.json', (ok) => {
+        console.log(ok ? 'Wrote trace.json' : 'Could not write trace.json');
+        process.exit(0);
+    });
+}, 2000);
@@ -0,0 +1,29 @@
+const Screen = require('../index');
+
+
+// Replay a recording made with recording_test.js against two candidate
+// layouts, the screen split into halves or into quarters, and compare
+// how often and how long each rectangle held the focus.
+const recording = new Screen.Recording('session.etrk');
+
+const halves = [
+    { id: 1, x: 0, y: 0, width: 960, height: 1080 },
+    { id: 2, x: 960, y: 0, width: 960, height: 1080 }
+];
+
+const quarters = [
+    { id: 1, x: 0, y: 0, width: 960, height: 540 },
+    { id: 2, x: 960, y: 0, width: 960, height: 540 },
+    { id: 3, x: 0, y: 540, width: 960, height: 540 },
+    { id: 4, x: 960, y: 540, width: 960, height: 540 }
+];
+
+recording.ReplayLayouts([halves, quarters], (results) => {
+    results.forEach((result, i) => {
+        console.log(`layout ${i}: ${result.samples} gaze points, ${result.misses} missed every rectangle, ${result.timeline.length / 3} focus spans`);
+
+        for (const interactor of result.interactors) {
+            console.log(`  id = ${interactor.id}  entries = ${interactor.entries}  dwell = ${interactor.dwell / 1000} ms`);
+        }
+    });
+});